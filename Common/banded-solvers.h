@@ -0,0 +1,298 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "thread-pool.h"
+
+/*
+   Tridiagonal and Banded Solvers
+
+   A matrix is banded with lower / upper bandwidth kl / ku when
+   A[i][j] = 0 for j < i - kl and j > i + ku (spline systems and 1-D
+   diffusion give kl = ku = 1). bandwidth() finds kl and ku with one scan
+   of the dense matrix, and worthBanded() tells whether the band is narrow
+   enough to beat dense elimination.
+
+     thomas()          tridiagonal, no pivoting: 8n flops. Used when A is
+                       diagonally dominant (then no pivot can vanish).
+     cyclicReduction() the same systems split over a ThreadPool: log2(n)
+                       levels, each eliminating every other remaining
+                       unknown from its two neighbours at once (about
+                       twice the flops of Thomas, all independent within a
+                       level), then the same levels back.
+     BandLU            any banded A: Gaussian elimination with partial
+                       pivoting inside the band, O(n * kl * (kl + ku)).
+
+   BandLU stores row r as the 2kl + ku + 1 values of columns
+   [r - kl, r + ku + kl] (element (r, c) at r * width + c - r + kl). The
+   extra kl columns hold the fill-in of row interchanges: the pivot row of
+   step i comes from rows i .. i + kl, so its nonzeros reach column
+   i + kl + ku at most. As in LAPACK's xGBTRF the multipliers are not
+   swapped by later interchanges, and the forward substitution applies
+   each interchange just before its column of L.
+
+   All solvers report a pivot below PIVOT_EPS by returning false, so that
+   a singular system can be handed to the dense classification.
+*/
+
+namespace band
+{
+
+const double PIVOT_EPS = 1e-12;
+const int CR_MIN_SIZE = 1 << 15; // shorter tridiagonal systems gain nothing from threads
+const int CR_GRAIN = 1 << 12;    // equations per parallelFor block in cyclic reduction
+
+struct Bandwidth
+{
+    int lower = 0; // kl: nonzeros at most this far below the diagonal
+    int upper = 0; // ku: ... and above it
+};
+
+/*
+   Bandwidth of the nonzeros of the n x n matrix a (leading dimension lda).
+   Row i is scanned from both ends towards the band found so far, so a
+   banded matrix costs one pass over its zeros, and the scan stops as soon
+   as kl + ku exceeds `limit`.
+*/
+inline Bandwidth bandwidth(const double *a, int n, int lda, int limit = INT_MAX)
+{
+    Bandwidth bw;
+    for (int i = 0; i < n && bw.lower + bw.upper <= limit; i++)
+    {
+        const double *row = a + (size_t)i * lda;
+        for (int j = 0; j < i - bw.lower; j++)
+            if (row[j] != 0.0)
+            {
+                bw.lower = i - j;
+                break;
+            }
+        for (int j = n - 1; j > i + bw.upper; j--)
+            if (row[j] != 0.0)
+            {
+                bw.upper = j - i;
+                break;
+            }
+    }
+    return bw;
+}
+
+// Band narrow enough that O(n kl (kl + ku)) clearly beats O(n^3)
+inline bool worthBanded(const Bandwidth &bw, int n)
+{
+    return (bw.lower + bw.upper + 1) * 4 <= n;
+}
+
+// Tridiagonal system: sub[i] = A[i][i-1] (sub[0] = 0), diag[i], super[i] = A[i][i+1] (super[n-1] = 0)
+struct Tridiagonal
+{
+    std::vector<double> sub, diag, super;
+
+    Tridiagonal() = default;
+
+    Tridiagonal(const double *a, int n, int lda) : sub(n, 0.0), diag(n), super(n, 0.0)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            const double *row = a + (size_t)i * lda;
+            diag[i] = row[i];
+            if (i > 0)
+                sub[i] = row[i - 1];
+            if (i + 1 < n)
+                super[i] = row[i + 1];
+        }
+    }
+
+    int size() const { return (int)diag.size(); }
+
+    // |diag| >= |sub| + |super| in every row: no pivoting needed
+    bool diagonallyDominant() const
+    {
+        for (int i = 0; i < size(); i++)
+            if (std::fabs(diag[i]) < std::fabs(sub[i]) + std::fabs(super[i]))
+                return false;
+        return true;
+    }
+};
+
+/*
+   Thomas algorithm: x holds the right-hand side on entry and the solution
+   on return. Returns false if a pivot falls below PIVOT_EPS.
+*/
+inline bool thomas(const Tridiagonal &t, double *x)
+{
+    int n = t.size();
+    if (n == 0)
+        return true;
+    std::vector<double> c(n);
+    double m = t.diag[0];
+    if (std::fabs(m) < PIVOT_EPS)
+        return false;
+    c[0] = t.super[0] / m;
+    x[0] /= m;
+    for (int i = 1; i < n; i++)
+    {
+        m = t.diag[i] - t.sub[i] * c[i - 1];
+        if (std::fabs(m) < PIVOT_EPS)
+            return false;
+        c[i] = t.super[i] / m;
+        x[i] = (x[i] - t.sub[i] * x[i - 1]) / m;
+    }
+    for (int i = n - 2; i >= 0; i--)
+        x[i] -= c[i] * x[i + 1];
+    return true;
+}
+
+/*
+   Cyclic reduction on the pool. Level s (s = 1, 2, 4, ...) removes the
+   unknowns s - 1, 3s - 1, ... from the equations 2s - 1, 4s - 1, ..., which
+   then couple to unknowns 2s apart; the equations of one level touch
+   disjoint rows, so they run in parallel. The back phase solves the
+   equations of each level from their already known neighbours, top level
+   first. t is taken by value: the reduction overwrites it.
+*/
+inline bool cyclicReduction(Tridiagonal t, double *x, ThreadPool &pool)
+{
+    int n = t.size();
+    double *a = t.sub.data(), *b = t.diag.data(), *c = t.super.data();
+    std::atomic<bool> ok{true};
+
+    int s = 1;
+    for (; 2 * s <= n; s *= 2)
+    {
+        int count = n / (2 * s); // i = 2s - 1, 4s - 1, ... < n
+        pool.parallelFor(0, count, CR_GRAIN, [&](int lo, int hi)
+        {
+            for (int q = lo; q < hi; q++)
+            {
+                int i = (q + 1) * 2 * s - 1, im = i - s, ip = i + s;
+                if (std::fabs(b[im]) < PIVOT_EPS || (ip < n && std::fabs(b[ip]) < PIVOT_EPS))
+                {
+                    ok = false;
+                    continue;
+                }
+                double alpha = -a[i] / b[im];
+                double gamma = ip < n ? -c[i] / b[ip] : 0.0;
+                b[i] += alpha * c[im] + (ip < n ? gamma * a[ip] : 0.0);
+                x[i] += alpha * x[im] + (ip < n ? gamma * x[ip] : 0.0);
+                a[i] = alpha * a[im];
+                c[i] = ip < n ? gamma * c[ip] : 0.0;
+            }
+        });
+        if (!ok)
+            return false;
+    }
+
+    for (; s >= 1; s /= 2)
+    {
+        int count = (n + s) / (2 * s); // i = s - 1, 3s - 1, ... < n
+        pool.parallelFor(0, count, CR_GRAIN, [&](int lo, int hi)
+        {
+            for (int q = lo; q < hi; q++)
+            {
+                int i = q * 2 * s + s - 1;
+                if (std::fabs(b[i]) < PIVOT_EPS)
+                {
+                    ok = false;
+                    continue;
+                }
+                double v = x[i];
+                if (i - s >= 0)
+                    v -= a[i] * x[i - s];
+                if (i + s < n)
+                    v -= c[i] * x[i + s];
+                x[i] = v / b[i];
+            }
+        });
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+class BandLU
+{
+public:
+    /*
+       Copy the band of the n x n matrix a (leading dimension lda) and factor
+       it. Returns false if a pivot falls below PIVOT_EPS (A singular, or
+       too close to it for this test).
+    */
+    bool factor(const double *a, int n, int lda, const Bandwidth &bw)
+    {
+        n_ = n;
+        kl_ = bw.lower;
+        ku_ = bw.upper;
+        width_ = 2 * kl_ + ku_ + 1;
+        ab_.assign((size_t)n * width_, 0.0);
+        piv_.resize(n);
+        for (int r = 0; r < n; r++)
+        {
+            const double *row = a + (size_t)r * lda;
+            for (int c = std::max(0, r - kl_); c <= std::min(n - 1, r + ku_); c++)
+                at(r, c) = row[c];
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            int last = std::min(n - 1, i + kl_);      // last row with a nonzero in column i
+            int right = std::min(n - 1, i + kl_ + ku_); // last column the pivot row can reach
+            int p = i;
+            for (int r = i + 1; r <= last; r++)
+                if (std::fabs(at(r, i)) > std::fabs(at(p, i)))
+                    p = r;
+            piv_[i] = p;
+            if (std::fabs(at(p, i)) < PIVOT_EPS)
+                return false;
+            if (p != i)
+                for (int c = i; c <= right; c++)
+                    std::swap(at(i, c), at(p, c));
+
+            const double *src = &at(i, i); // src[c] = A(i, i + c)
+            for (int r = i + 1; r <= last; r++)
+            {
+                double *dst = &at(r, i);
+                double f = dst[0] / src[0];
+                dst[0] = f;
+                if (f == 0.0)
+                    continue;
+                for (int c = 1; c <= right - i; c++)
+                    dst[c] -= f * src[c];
+            }
+        }
+        return true;
+    }
+
+    // b := A^-1 b (n values)
+    void solve(double *b) const
+    {
+        for (int i = 0; i < n_; i++)
+        {
+            if (piv_[i] != i)
+                std::swap(b[i], b[piv_[i]]);
+            int last = std::min(n_ - 1, i + kl_);
+            for (int r = i + 1; r <= last; r++)
+                b[r] -= at(r, i) * b[i];
+        }
+        for (int i = n_ - 1; i >= 0; i--)
+        {
+            int right = std::min(n_ - 1, i + kl_ + ku_);
+            const double *u = &at(i, i);
+            double v = b[i];
+            for (int c = 1; c <= right - i; c++)
+                v -= u[c] * b[i + c];
+            b[i] = v / u[0];
+        }
+    }
+
+    int size() const { return n_; }
+    Bandwidth bandwidth() const { return {kl_, ku_}; }
+
+private:
+    // Element (r, c), c in [r - kl, r + ku + kl]; columns of one row are contiguous
+    double &at(int r, int c) { return ab_[(size_t)r * width_ + (c - r + kl_)]; }
+    const double &at(int r, int c) const { return ab_[(size_t)r * width_ + (c - r + kl_)]; }
+
+    int n_ = 0, kl_ = 0, ku_ = 0, width_ = 1;
+    std::vector<double> ab_;
+    std::vector<int> piv_;
+};
+
+} // namespace band
@@ -0,0 +1,344 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "profiler.h"
+#include "simd-kernels.h"
+
+/*
+   Batched Small-System Solver
+
+   Solves many independent n x n systems (n = 1..8) at once. Systems of the
+   same size are packed LANES at a time into a structure-of-arrays block:
+
+     element (i, j) of the augmented matrix [A | b] of lane l
+       -> block[(i * (n + 1) + j) * LANES + l]
+
+   so every step of Gaussian elimination is one operation over LANES
+   contiguous doubles, i.e. each SIMD lane works on a different system. The
+   kernel is a template on n, so all loops have compile-time trip counts and
+   are fully unrolled; partial pivoting is done per lane with compares and
+   blends instead of branches.
+
+   The arithmetic per lane is exactly that of the scalar elimination in
+   solveOne() (same pivots, same divide, multiply and subtract, no FMA), so
+   results are bit-identical. A lane that meets a pivot below PIVOT_EPS is
+   re-solved by solveOne(), which also classifies singular systems.
+*/
+
+namespace batch
+{
+
+// Systems per block: one vector register of doubles for the target ISA
+#if defined(__AVX512F__)
+const int LANES = 8;
+#elif defined(__AVX__)
+const int LANES = 4;
+#else
+const int LANES = 2;
+#endif
+const int MAX_N = 8;          // larger systems go through solveOne()
+const double PIVOT_EPS = 1e-12;
+
+enum class Status : unsigned char
+{
+    Unique,
+    NoSolution,
+    Infinite
+};
+
+inline const char *statusName(Status s)
+{
+    switch (s)
+    {
+    case Status::NoSolution: return "No Solution";
+    case Status::Infinite: return "Infinite Solutions";
+    default: return "Unique Solution";
+    }
+}
+
+/*
+   Scalar reference: Gaussian elimination with partial pivoting on the
+   row-major n x (n + 1) augmented matrix `a` (overwritten), followed by the
+   rank test and back substitution of the Gauss Elimination program.
+*/
+NCS_NO_CONTRACT
+inline Status solveOne(int n, double *a, double *x)
+{
+    NCS_NO_CONTRACT_BODY
+    int m = n + 1;
+    for (int i = 0; i < n - 1; i++)
+    {
+        int maxRow = i;
+        for (int k = i + 1; k < n; k++)
+            if (std::fabs(a[k * m + i]) > std::fabs(a[maxRow * m + i]))
+                maxRow = k;
+        if (maxRow != i)
+            std::swap_ranges(a + i * m, a + (i + 1) * m, a + maxRow * m);
+
+        if (std::fabs(a[i * m + i]) < PIVOT_EPS)
+            continue;
+
+        for (int k = i + 1; k < n; k++)
+        {
+            double factor = a[k * m + i] / a[i * m + i];
+            simd::rowAxpy(a + k * m + i, a + i * m + i, -factor, n - i + 1);
+        }
+    }
+
+    int rank = 0;
+    for (int i = 0; i < n; i++)
+    {
+        bool allZero = true;
+        for (int j = 0; j < n; j++)
+            if (std::fabs(a[i * m + j]) > PIVOT_EPS)
+                allZero = false;
+        if (allZero && std::fabs(a[i * m + n]) > PIVOT_EPS)
+            return Status::NoSolution;
+        if (!allZero)
+            rank++;
+    }
+    if (rank < n)
+        return Status::Infinite;
+
+    for (int i = n - 1; i >= 0; i--)
+    {
+        x[i] = a[i * m + n];
+        for (int j = i + 1; j < n; j++)
+            x[i] -= a[i * m + j] * x[j];
+        x[i] /= a[i * m + i];
+    }
+    return Status::Unique;
+}
+
+// LANES doubles as one vector value (GCC/clang vector extension), i.e. one
+// zmm, ymm or xmm register depending on the -march the program is built for
+typedef double Lanes __attribute__((vector_size(LANES * sizeof(double))));
+typedef long long LaneMask __attribute__((vector_size(LANES * sizeof(double))));
+
+inline Lanes loadLanes(const double *p)
+{
+    Lanes v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline Lanes absLanes(Lanes v)
+{
+    return (Lanes)((LaneMask)v & ((LaneMask){} + 0x7fffffffffffffffLL)); // clear the sign bits
+}
+
+/*
+   Solve the LANES systems of one SoA block. x receives x[i * LANES + l];
+   ok[l] is false for lanes that hit a pivot of magnitude <= PIVOT_EPS and
+   must be re-solved with solveOne(). Lane results are bitwise equal to
+   solveOne() whenever ok[l] is true.
+
+   The whole block lives in N * (N + 1) vector registers: with N a template
+   parameter every loop below is unrolled and every index is a constant.
+*/
+template <int N>
+NCS_NO_CONTRACT inline void solveBlock(const double *block, double *x, bool *ok)
+{
+    NCS_NO_CONTRACT_BODY
+    constexpr int M = N + 1;
+    Lanes a[N][M];
+    for (int i = 0; i < N; i++)
+        for (int j = 0; j < M; j++)
+            a[i][j] = loadLanes(block + (i * M + j) * LANES);
+
+    LaneMask good = (LaneMask){} - 1; // all bits set: still on the fast path
+
+    for (int i = 0; i < N; i++)
+    {
+        // Per-lane pivot search: first row with the largest |a[k][i]|
+        Lanes best = absLanes(a[i][i]);
+        Lanes piv = (Lanes){} + i;
+        for (int k = i + 1; k < N; k++)
+        {
+            Lanes v = absLanes(a[k][i]);
+            LaneMask gt = v > best;
+            best = gt ? v : best;
+            piv = gt ? (Lanes){} + k : piv;
+        }
+
+        // Row interchange as blends (columns left of i are not used again)
+        for (int k = i + 1; k < N; k++)
+        {
+            LaneMask swap = piv == (Lanes){} + k;
+            for (int j = i; j < M; j++)
+            {
+                Lanes t = a[i][j];
+                a[i][j] = swap ? a[k][j] : t;
+                a[k][j] = swap ? t : a[k][j];
+            }
+        }
+
+        // Same test as the rank check of solveOne(); also catches NaN
+        good &= best > PIVOT_EPS;
+
+        // Eliminate below the pivot: row k += (-(a[k][i] / a[i][i])) * row i
+        for (int k = i + 1; k < N; k++)
+        {
+            Lanes factor = a[k][i] / a[i][i];
+            for (int j = i; j < M; j++)
+                a[k][j] = a[k][j] + (-factor) * a[i][j];
+        }
+    }
+
+    // Back substitution
+    Lanes xs[N];
+    for (int i = N - 1; i >= 0; i--)
+    {
+        xs[i] = a[i][N];
+        for (int j = i + 1; j < N; j++)
+            xs[i] -= a[i][j] * xs[j];
+        xs[i] /= a[i][i];
+    }
+    std::memcpy(x, xs, sizeof(xs));
+
+    for (int l = 0; l < LANES; l++)
+        ok[l] = good[l] != 0;
+}
+
+template <int N>
+void solveBlockN(const double *block, double *x, bool *ok) { solveBlock<N>(block, x, ok); }
+
+using BlockKernel = void (*)(const double *, double *, bool *);
+
+// Kernel for size n (1..MAX_N)
+inline BlockKernel kernelFor(int n)
+{
+    static const BlockKernel table[MAX_N + 1] = {
+        nullptr, solveBlockN<1>, solveBlockN<2>, solveBlockN<3>, solveBlockN<4>,
+        solveBlockN<5>, solveBlockN<6>, solveBlockN<7>, solveBlockN<8>};
+    return table[n];
+}
+
+/*
+   Collects systems in input order, packs them per size and solves each
+   block as soon as it is full. After finish(), status(s) and solution(s)
+   give the result of the s-th added system.
+*/
+class BatchSolver
+{
+public:
+    // Slot for the augmented matrix [A | b] of a new n x n system; the caller
+    // fills it with set(i, j, value) before the next call to add()
+    int add(int n)
+    {
+        int id = (int)offset_.size();
+        offset_.push_back(x_.size());
+        size_.push_back(n);
+        status_.push_back(Status::Unique);
+        x_.resize(x_.size() + n);
+
+        current_ = id;
+        if (n >= 1 && n <= MAX_N)
+        {
+            Pending &p = pending_[n];
+            if (p.block.empty())
+                p.block.assign((size_t)n * (n + 1) * LANES, 0.0);
+            lane_ = p.count;
+            p.ids[p.count] = id;
+        }
+        else
+        {
+            lane_ = -1;
+            scratch_.assign((size_t)n * (n + 1), 0.0);
+        }
+        return id;
+    }
+
+    void set(int i, int j, double v)
+    {
+        int n = size_[current_];
+        if (lane_ >= 0)
+            pending_[n].block[(i * (n + 1) + j) * LANES + lane_] = v;
+        else
+            scratch_[i * (n + 1) + j] = v;
+    }
+
+    // Call after the last set() of the current system
+    void commit()
+    {
+        int n = size_[current_];
+        if (lane_ < 0)
+        {
+            status_[current_] = solveOne(n, scratch_.data(), &x_[offset_[current_]]);
+            return;
+        }
+        if (++pending_[n].count == LANES)
+            flush(n);
+    }
+
+    // Solve the partially filled blocks
+    void finish()
+    {
+        for (int n = 1; n <= MAX_N; n++)
+            if (pending_[n].count > 0)
+                flush(n);
+    }
+
+    int count() const { return (int)size_.size(); }
+    int size(int s) const { return size_[s]; }
+    Status status(int s) const { return status_[s]; }
+    const double *solution(int s) const { return &x_[offset_[s]]; }
+
+    // How many systems needed the scalar path (tiny pivot or n > MAX_N)
+    long long scalarSolves() const { return scalarSolves_; }
+
+private:
+    struct Pending
+    {
+        std::vector<double> block;
+        int ids[LANES];
+        int count = 0;
+    };
+
+    void flush(int n)
+    {
+        PROF_SCOPE("batch solve");
+        PROF_FLOPS(LANES * (2.0 * n * n * n / 3 + 2.0 * n * n));
+        Pending &p = pending_[n];
+        int m = n + 1;
+
+        // Unused lanes get an identity system so they never need the fallback
+        for (int l = p.count; l < LANES; l++)
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < m; j++)
+                    p.block[(i * m + j) * LANES + l] = (i == j) ? 1.0 : 0.0;
+
+        double x[MAX_N * LANES];
+        bool ok[LANES];
+        kernelFor(n)(p.block.data(), x, ok);
+
+        for (int l = 0; l < p.count; l++)
+        {
+            int id = p.ids[l];
+            double *out = &x_[offset_[id]];
+            if (ok[l])
+            {
+                for (int i = 0; i < n; i++)
+                    out[i] = x[i * LANES + l];
+                continue;
+            }
+            std::vector<double> a((size_t)n * m);
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < m; j++)
+                    a[i * m + j] = p.block[(i * m + j) * LANES + l];
+            status_[id] = solveOne(n, a.data(), out);
+            scalarSolves_++;
+        }
+        p.count = 0;
+    }
+
+    Pending pending_[MAX_N + 1];
+    std::vector<double> scratch_;
+    std::vector<size_t> offset_;
+    std::vector<int> size_;
+    std::vector<Status> status_;
+    std::vector<double> x_;
+    int current_ = -1, lane_ = -1;
+    long long scalarSolves_ = 0;
+};
+
+} // namespace batch
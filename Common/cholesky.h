@@ -0,0 +1,353 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "determinant.h"
+#include "lu-factor.h"
+
+/*
+   Symmetric Factorization (A = L L^T)
+
+   For a symmetric positive-definite A the Cholesky factorization needs half
+   the flops of LU (n^3 / 3) and, since A = L L^T, only the lower triangle.
+   L is kept in packed row-major form: row i holds its i + 1 entries
+   L[i][0..i] contiguously at offset i * (i + 1) / 2, so the factor takes
+   n (n + 1) / 2 values instead of n^2.
+
+   The factorization is left-looking and blocked by rows. For a block of
+   rows I and a finished block of columns J every entry needs
+
+     L[i][j] = (A[i][j] - sum_k L[i][k] * L[j][k]) / L[j][j]
+
+   and in packed storage both L[i][0..] and L[j][0..] are contiguous, so the
+   sums over the columns left of J are computed by a register-tiled kernel
+   (4 x 4 dot products at a time, SIMD across k). J itself is finished in
+   strips of INNER_BLOCK columns with the same kernel, so only the sums
+   inside one strip are done entry by entry.
+
+   SymmetricFactor picks the factorization automatically:
+
+     1. Cholesky        every pivot A[j][j] - sum L[j][k]^2 is >= PIVOT_EPS
+     2. pivoted LU      anything else (lu::LUFactor on the full matrix)
+
+   A symmetric indefinite A goes straight to pivoted LU: LDL^T without
+   pivoting can grow its factors without bound, and even a bound on the
+   multipliers loses several digits on random indefinite matrices.
+
+   The callers decide when A is symmetric (isSymmetric); only the lower
+   triangle of A is read by the Cholesky path.
+*/
+
+namespace chol
+{
+
+using lu::PIVOT_EPS;
+
+enum class Method
+{
+    Cholesky,
+    LU
+};
+
+inline const char *methodName(Method m)
+{
+    switch (m)
+    {
+    case Method::Cholesky: return "Cholesky (A = L*L^T)";
+    default: return "LU with partial pivoting (PA = L*U)";
+    }
+}
+
+// True if |A[i][j] - A[j][i]| <= relTol * (|A[i][j]| + |A[j][i]|) for all i, j
+inline bool isSymmetric(const double *a, int n, int lda, double relTol = 1e-12)
+{
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < i; j++)
+        {
+            double x = a[(size_t)i * lda + j], y = a[(size_t)j * lda + i];
+            if (std::fabs(x - y) > relTol * (std::fabs(x) + std::fabs(y)))
+                return false;
+        }
+    return true;
+}
+
+inline size_t packedOffset(int i) { return (size_t)i * (i + 1) / 2; }
+
+// One vector register of doubles for the target ISA
+#if defined(__AVX512F__)
+const int DOT_LANES = 8;
+#elif defined(__AVX__)
+const int DOT_LANES = 4;
+#else
+const int DOT_LANES = 2;
+#endif
+typedef double DotVec __attribute__((vector_size(DOT_LANES * sizeof(double))));
+
+/*
+   s[r][c] = sum_{k < kc} x[r][k] * y[c][k] for 4 rows x and 4 rows y, each
+   contiguous in k: 16 vector accumulators, 8 loads per 16 multiply-adds.
+*/
+inline void dotTile4x4(const double *const x[4], const double *const y[4], int kc, double s[4][4])
+{
+    DotVec acc[4][4] = {};
+    int k = 0;
+    for (; k + DOT_LANES <= kc; k += DOT_LANES)
+    {
+        DotVec xv[4], yv[4];
+        for (int r = 0; r < 4; r++)
+        {
+            std::memcpy(&xv[r], x[r] + k, sizeof(DotVec));
+            std::memcpy(&yv[r], y[r] + k, sizeof(DotVec));
+        }
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                acc[r][c] += xv[r] * yv[c];
+    }
+    for (int r = 0; r < 4; r++)
+        for (int c = 0; c < 4; c++)
+        {
+            double sum = 0;
+            for (int l = 0; l < DOT_LANES; l++)
+                sum += acc[r][c][l];
+            for (int p = k; p < kc; p++)
+                sum += x[r][p] * y[c][p];
+            s[r][c] = sum;
+        }
+}
+
+inline double dot(const double *x, const double *y, int kc)
+{
+    double sum = 0;
+    for (int k = 0; k < kc; k++)
+        sum += x[k] * y[k];
+    return sum;
+}
+
+const int INNER_BLOCK = 16; // columns finished entry by entry inside a block
+
+/*
+   For the rows i in [i0, i1) and columns j in [j0, j1) with j <= i:
+   P[i][j] -= sum_{k in [k0, k1)} L[i][k] * L[j][k]   (P packed; these L
+   entries are final). This is where almost all of the flops are. The k
+   range is cut into chunks of lu::KC so the row pieces of I and J stay in
+   cache while every tile of the block is updated.
+*/
+inline void updateBlock(double *P, int i0, int i1, int j0, int j1, int k0, int k1)
+{
+    double s[4][4];
+    const double *x[4], *y[4];
+    for (int kk = k0; kk < k1; kk += lu::KC)
+    {
+        int kc = std::min(lu::KC, k1 - kk);
+        for (int i = i0; i < i1; i += 4)
+            for (int j = j0; j < j1 && j <= i + 3; j += 4)
+            {
+                int mr = std::min(4, i1 - i), nr = std::min(4, j1 - j);
+                if (mr == 4 && nr == 4)
+                {
+                    for (int r = 0; r < 4; r++)
+                    {
+                        x[r] = P + packedOffset(i + r) + kk;
+                        y[r] = P + packedOffset(j + r) + kk;
+                    }
+                    dotTile4x4(x, y, kc, s);
+                    for (int r = 0; r < 4; r++)
+                        for (int c = 0; c < 4 && j + c <= i + r; c++)
+                            P[packedOffset(i + r) + j + c] -= s[r][c];
+                    continue;
+                }
+                for (int r = 0; r < mr; r++)
+                    for (int c = 0; c < nr && j + c <= i + r; c++)
+                        P[packedOffset(i + r) + j + c] -=
+                            dot(P + packedOffset(i + r) + kk, P + packedOffset(j + c) + kk, kc);
+            }
+    }
+}
+
+/*
+   Blocked Cholesky of the lower triangle of A (n x n, leading dimension lda)
+   into the packed factor P. Returns false as soon as a pivot is below
+   PIVOT_EPS (A is not numerically positive definite); P is then garbage.
+*/
+inline bool choleskyPacked(const double *a, int n, int lda, std::vector<double> &P,
+                           int blockSize = lu::DEFAULT_BLOCK_SIZE)
+{
+    P.resize(packedOffset(n));
+    for (int i = 0; i < n; i++)
+        std::copy(a + (size_t)i * lda, a + (size_t)i * lda + i + 1, P.begin() + packedOffset(i));
+
+    int nb = std::max(INNER_BLOCK, blockSize);
+    double *L = P.data();
+    for (int i0 = 0; i0 < n; i0 += nb)
+    {
+        int i1 = std::min(n, i0 + nb);
+        for (int j0 = 0; j0 <= i0; j0 += nb)
+        {
+            int j1 = std::min(n, j0 + nb);
+            updateBlock(L, i0, i1, j0, j1, 0, j0);
+
+            // Finish J in narrow column strips: tiles for the columns of J
+            // left of the strip, then entry by entry inside it
+            for (int s0 = j0; s0 < j1; s0 += INNER_BLOCK)
+            {
+                int s1 = std::min(j1, s0 + INNER_BLOCK);
+                updateBlock(L, i0, i1, s0, s1, j0, s0);
+                for (int i = std::max(i0, s0); i < i1; i++)
+                {
+                    double *Li = L + packedOffset(i);
+                    for (int j = s0; j < std::min(s1, i + 1); j++)
+                    {
+                        const double *Lj = L + packedOffset(j);
+                        double s = Li[j] - dot(Li + s0, Lj + s0, j - s0);
+                        if (j < i)
+                            Li[j] = s / Lj[j];
+                        else
+                        {
+                            if (!(s >= PIVOT_EPS)) // also catches NaN
+                                return false;
+                            Li[i] = std::sqrt(s);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*
+   Factor-once object for a symmetric A: Cholesky, else pivoted LU (see the
+   top of the file). solve() handles one or many right-hand
+   sides in O(n^2) each.
+*/
+class SymmetricFactor
+{
+public:
+    SymmetricFactor() = default;
+
+    SymmetricFactor(const double *a, int n, int lda, int blockSize = lu::DEFAULT_BLOCK_SIZE)
+    {
+        factorize(a, n, lda, blockSize);
+    }
+
+    Method factorize(const double *a, int n, int lda, int blockSize = lu::DEFAULT_BLOCK_SIZE)
+    {
+        n_ = n;
+        if (choleskyPacked(a, n, lda, packed_, blockSize))
+            method_ = Method::Cholesky;
+        else
+        {
+            method_ = Method::LU;
+            std::vector<double>().swap(packed_);
+            lu_.factorize(a, n, lda, blockSize);
+        }
+        return method_;
+    }
+
+    Method method() const { return method_; }
+    int size() const { return n_; }
+    bool singular() const { return method_ == Method::LU && lu_.singular(); }
+    const lu::LUFactor &luFactor() const { return lu_; }
+
+    // Values held by the factor: n (n + 1) / 2 packed, or n^2 for LU
+    size_t storedValues() const { return method_ == Method::LU ? (size_t)n_ * n_ : packed_.size(); }
+
+    // Cholesky factor (Cholesky only)
+    double L(int i, int j) const { return j > i ? 0.0 : packed_[packedOffset(i) + j]; }
+
+    double determinant() const
+    {
+        if (method_ == Method::LU)
+            return lu_.determinant();
+        double d = 1.0;
+        for (int i = 0; i < n_; i++)
+        {
+            double v = packed_[packedOffset(i) + i];
+            d *= v * v;
+        }
+        return d;
+    }
+
+    // Sign and log|det| without overflow (see determinant.h)
+    det::LogDet logDeterminant() const
+    {
+        if (method_ == Method::LU)
+            return det::fromFactors(lu_);
+        det::Product p;
+        for (int i = 0; i < n_; i++)
+        {
+            double v = packed_[packedOffset(i) + i];
+            p.multiply(v);
+            p.multiply(v);
+        }
+        return p.result();
+    }
+
+    // B := L^{-1} * B (B is n x k, leading dimension ldb)
+    void solveLower(double *b, int k, int ldb) const
+    {
+        for (int i = 0; i < n_; i++)
+        {
+            const double *Li = packed_.data() + packedOffset(i);
+            double *row = b + (size_t)i * ldb;
+            for (int j = 0; j < i; j++)
+            {
+                double l = Li[j];
+                if (l == 0.0)
+                    continue;
+                const double *src = b + (size_t)j * ldb;
+                for (int c = 0; c < k; c++)
+                    row[c] -= l * src[c];
+            }
+            for (int c = 0; c < k; c++)
+                row[c] /= Li[i];
+        }
+    }
+
+    // B := L^{-T} * B
+    void solveUpper(double *b, int k, int ldb) const
+    {
+        // Column-oriented L^T solve: row j of L is column j of L^T
+        for (int i = n_ - 1; i >= 0; i--)
+        {
+            const double *Li = packed_.data() + packedOffset(i);
+            double *row = b + (size_t)i * ldb;
+            for (int c = 0; c < k; c++)
+                row[c] /= Li[i];
+            for (int j = 0; j < i; j++)
+            {
+                double l = Li[j];
+                if (l == 0.0)
+                    continue;
+                double *dst = b + (size_t)j * ldb;
+                for (int c = 0; c < k; c++)
+                    dst[c] -= l * row[c];
+            }
+        }
+    }
+
+    // Solve A * X = B in place for an n x k block of right-hand sides
+    void solve(double *b, int k, int ldb) const
+    {
+        if (method_ == Method::LU)
+        {
+            lu_.solve(b, k, ldb);
+            return;
+        }
+        solveLower(b, k, ldb);
+        solveUpper(b, k, ldb);
+    }
+
+    std::vector<double> solve(const std::vector<double> &rhs) const
+    {
+        std::vector<double> x = rhs;
+        solve(x.data(), 1, 1);
+        return x;
+    }
+
+private:
+    int n_ = 0;
+    Method method_ = Method::Cholesky;
+    std::vector<double> packed_; // L in packed row-major lower form
+    lu::LUFactor lu_;
+};
+
+} // namespace chol
@@ -0,0 +1,110 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   1-Norm Condition Number Estimation (Hager / Higham)
+
+   cond_1(A) = ||A||_1 * ||A^-1||_1. ||A||_1 is a column sum; ||A^-1||_1 is
+   not computed (that would take the inverse, O(n^3)) but estimated from a
+   few solves with A and A^T using factors that already exist:
+
+     x = (1/n, ..., 1/n)
+     repeat (at most ESTIMATE_MAX_ITER times)
+       y = A^-1 x                        estimate = ||y||_1
+       xi = sign(y)
+       z = A^-T xi
+       stop if ||z||_inf <= z^T x       (x is a local maximum)
+       x = e_j, j = argmax |z_j|
+
+   plus Higham's extra vector b_i = (-1)^i (1 + i / (n - 1)), which catches
+   the matrices that fool the iteration; the estimate is the larger of the
+   two. This is the method of LAPACK's xLACON: never larger than the true
+   value and in practice within a small factor of it, for 4-5 solves,
+   i.e. O(n^2) on top of an O(n^3) factorization.
+*/
+
+namespace cond
+{
+
+const int ESTIMATE_MAX_ITER = 5;
+
+// ||A||_1: largest absolute column sum of the n x n matrix a (leading dimension lda)
+inline double norm1(const double *a, int n, int lda)
+{
+    std::vector<double> colSum(n, 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        const double *row = a + (size_t)i * lda;
+        for (int j = 0; j < n; j++)
+            colSum[j] += std::fabs(row[j]);
+    }
+    return n ? *std::max_element(colSum.begin(), colSum.end()) : 0.0;
+}
+
+/*
+   Estimate ||A^-1||_1 for an n x n matrix given in-place solvers:
+     solve(x)       x := A^-1 x
+     solveT(x)      x := A^-T x
+   (x points to n doubles)
+*/
+template <typename Solve, typename SolveT>
+double inverseNorm1(int n, Solve solve, SolveT solveT)
+{
+    if (n == 0)
+        return 0.0;
+    auto sum = [&](const std::vector<double> &v)
+    {
+        double s = 0.0;
+        for (double e : v)
+            s += std::fabs(e);
+        return s;
+    };
+
+    std::vector<double> x(n, 1.0 / n), y(n), sign(n, 0.0);
+    double estimate = 0.0;
+    int lastJ = -1;
+    for (int it = 0; it < ESTIMATE_MAX_ITER; it++)
+    {
+        y = x;
+        solve(y.data());
+        double norm = sum(y);
+        if (it > 0 && norm <= estimate)
+            break; // no longer growing
+        estimate = norm;
+
+        // Same sign pattern as last time: z would be the same too
+        bool repeated = it > 0;
+        for (int i = 0; i < n; i++)
+        {
+            double s = y[i] >= 0 ? 1.0 : -1.0;
+            repeated = repeated && s == sign[i];
+            sign[i] = s;
+        }
+        if (repeated)
+            break;
+
+        std::vector<double> z = sign;
+        solveT(z.data());
+        int j = 0;
+        double zx = 0.0;
+        for (int i = 0; i < n; i++)
+        {
+            if (std::fabs(z[i]) > std::fabs(z[j]))
+                j = i;
+            zx += z[i] * x[i];
+        }
+        if (std::fabs(z[j]) <= zx || j == lastJ)
+            break; // local maximum
+        std::fill(x.begin(), x.end(), 0.0);
+        x[j] = 1.0;
+        lastJ = j;
+    }
+
+    // Alternating-sign vector
+    for (int i = 0; i < n; i++)
+        y[i] = (i % 2 ? -1.0 : 1.0) * (1.0 + (double)i / std::max(n - 1, 1));
+    solve(y.data());
+    return std::max(estimate, 2.0 * sum(y) / (3.0 * n));
+}
+
+} // namespace cond
@@ -0,0 +1,609 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   Fixed-Size Dense Solvers (size known at compile time, N = 1..16)
+
+   Small systems show up all over the suite: 3 x 3 normal equations in the
+   curve fits, thousands of tiny matrices in one input file. At these sizes
+   the general solvers spend their time on everything around the
+   arithmetic: heap buffers, run-time loop bounds, and blocking logic that
+   was written for n = 1000. Here N is a template parameter:
+
+     fx::Matrix<N>, fx::Vector<N>       plain arrays, on the stack
+     fx::LU<N>                          PA = LU: solve, determinant, inverse
+     fx::Cholesky<N>                    A = L L^T for symmetric positive definite A
+     fx::gaussJordanInverse<N>          [A | I] -> [I | A^-1] (as gauss-jordan-inverse.h)
+     fx::gaussJordanSolve<N>            [A | b] -> [I | x]
+
+   Every loop has a compile-time trip count, so the compiler unrolls it and
+   keeps small matrices in registers. Everything is constexpr:
+
+     constexpr fx::Matrix<2> A = {{{4, 7}, {2, 6}}};
+     static_assert(fx::LU<2>(A).determinant() == 10);
+
+   For a size known only at run time, solve(), inverse(), solveCholesky(),
+   solveGaussJordan() and invertGaussJordan() look up the matching
+   specialization in a table, like batch::kernelFor. They return false for
+   n > MAX_N, so the caller can take the general path.
+
+   Pivots below PIVOT_EPS (the threshold of the other solvers) make A
+   singular, or for Cholesky, not positive definite.
+*/
+
+namespace fx
+{
+
+constexpr int MAX_N = 16;
+constexpr double PIVOT_EPS = 1e-12;
+
+template <int N>
+struct Matrix
+{
+    double a[N][N] = {};
+
+    constexpr double *operator[](int i) { return a[i]; }
+    constexpr const double *operator[](int i) const { return a[i]; }
+};
+
+template <int N>
+struct Vector
+{
+    double v[N] = {};
+
+    constexpr double &operator[](int i) { return v[i]; }
+    constexpr const double &operator[](int i) const { return v[i]; }
+};
+
+// Unroll the loop that follows 8 times: completely up to N = 8, where the
+// matrix stays in registers; by 8 above (full unrolling to 16 multiplies the
+// compile time and code size by about 5 for no measurable gain)
+#if defined(__clang__)
+#define NCS_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define NCS_UNROLL _Pragma("GCC unroll 8")
+#else
+#define NCS_UNROLL
+#endif
+
+constexpr double absC(double x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_fabs(x); // one and-not, and still a constant expression
+#else
+    return x < 0 ? -x : x;
+#endif
+}
+
+// std::sqrt is not constexpr; Newton's iteration stands in at compile time
+constexpr double sqrtC(double x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    if (!__builtin_is_constant_evaluated())
+        return std::sqrt(x);
+#endif
+    if (!(x > 0))
+        return x == 0 ? 0.0 : std::numeric_limits<double>::quiet_NaN();
+    double r = x > 1 ? x : 1.0; // start above the root: the iterates fall monotonically
+    for (int i = 0; i < 2100; i++)
+    {
+        double next = 0.5 * (r + x / r);
+        if (!(next < r))
+            break;
+        r = next;
+    }
+    return r;
+}
+
+/*
+   Row and column interchanges for pivot p >= k (p == k is a no-op, so the
+   pivoting needs no branch). Up to SELECT_SWAP_MAX the swap is a select on
+   every row below k: more operations, but every index is a constant, so
+   the matrix stays in registers. Larger matrices do not fit there anyway
+   and swap through memory, where a run-time row index costs nothing.
+*/
+constexpr int SELECT_SWAP_MAX = 8;
+
+// v[k] <-> v[p]
+template <int N>
+constexpr void swapEntries(double (&v)[N], int k, int p)
+{
+    if constexpr (N <= SELECT_SWAP_MAX)
+    {
+        NCS_UNROLL
+        for (int i = k + 1; i < N; i++)
+        {
+            bool s = i == p;
+            double t = v[k];
+            v[k] = s ? v[i] : t;
+            v[i] = s ? t : v[i];
+        }
+    }
+    else
+    {
+        double t = v[k];
+        v[k] = v[p];
+        v[p] = t;
+    }
+}
+
+template <int N>
+constexpr void swapRows(double (&a)[N][N], int k, int p)
+{
+    if constexpr (N <= SELECT_SWAP_MAX)
+    {
+        NCS_UNROLL
+        for (int i = k + 1; i < N; i++)
+        {
+            bool s = i == p;
+            NCS_UNROLL
+            for (int j = 0; j < N; j++)
+            {
+                double t = a[k][j];
+                a[k][j] = s ? a[i][j] : t;
+                a[i][j] = s ? t : a[i][j];
+            }
+        }
+    }
+    else
+    {
+        double t[N] = {}; // whole-row copies: each one a few vector moves
+        NCS_UNROLL
+        for (int j = 0; j < N; j++)
+            t[j] = a[k][j];
+        NCS_UNROLL
+        for (int j = 0; j < N; j++)
+            a[k][j] = a[p][j];
+        NCS_UNROLL
+        for (int j = 0; j < N; j++)
+            a[p][j] = t[j];
+    }
+}
+
+template <int N>
+constexpr void swapColumns(double (&a)[N][N], int k, int p)
+{
+    NCS_UNROLL
+    for (int i = 0; i < N; i++)
+        swapEntries(a[i], k, p);
+}
+
+// First row p >= k with the largest |a[p][k]| (compare and select, no branches)
+template <int N>
+constexpr int pivotRow(const double (&a)[N][N], int k)
+{
+    int p = k;
+    double best = absC(a[k][k]);
+    NCS_UNROLL
+    for (int i = k + 1; i < N; i++)
+    {
+        double v = absC(a[i][k]);
+        p = v > best ? i : p;
+        best = v > best ? v : best;
+    }
+    return p;
+}
+
+// row i += alpha * row j
+template <int N>
+constexpr void rowAxpy(double (&a)[N][N], int i, int j, double alpha)
+{
+    NCS_UNROLL
+    for (int c = 0; c < N; c++)
+        a[i][c] += alpha * a[j][c];
+}
+
+template <int N>
+constexpr void rowScale(double (&a)[N][N], int i, double alpha)
+{
+    NCS_UNROLL
+    for (int c = 0; c < N; c++)
+        a[i][c] *= alpha;
+}
+
+template <int N>
+struct LU
+{
+    Matrix<N> lu;     // L below the diagonal (unit diagonal implied), U on and above
+    int piv[N] = {};  // at step k, row k was swapped with row piv[k]
+    bool ok = false;  // every pivot >= PIVOT_EPS
+
+    constexpr LU() = default;
+
+    constexpr explicit LU(const Matrix<N> &a) : lu(a)
+    {
+        ok = true;
+        NCS_UNROLL
+        for (int k = 0; k < N; k++)
+        {
+            int p = pivotRow(lu.a, k);
+            piv[k] = p;
+            swapRows(lu.a, k, p);
+            // No early exit: a singular A just yields garbage behind ok = false,
+            // and the loops stay straight-line code
+            ok = ok && absC(lu[k][k]) >= PIVOT_EPS;
+            NCS_UNROLL
+            for (int i = k + 1; i < N; i++)
+            {
+                double l = lu[i][k] / lu[k][k];
+                lu[i][k] = l;
+                NCS_UNROLL
+                for (int j = k + 1; j < N; j++)
+                    lu[i][j] -= l * lu[k][j];
+            }
+        }
+    }
+
+    // x = A^-1 b (requires ok)
+    constexpr Vector<N> solve(Vector<N> b) const
+    {
+        NCS_UNROLL
+        for (int k = 0; k < N; k++)
+            swapEntries(b.v, k, piv[k]);
+        NCS_UNROLL
+        for (int i = 1; i < N; i++)
+            NCS_UNROLL
+            for (int j = 0; j < i; j++)
+                b[i] -= lu[i][j] * b[j];
+        NCS_UNROLL
+        for (int i = N - 1; i >= 0; i--)
+        {
+            NCS_UNROLL
+            for (int j = i + 1; j < N; j++)
+                b[i] -= lu[i][j] * b[j];
+            b[i] /= lu[i][i];
+        }
+        return b;
+    }
+
+    constexpr double determinant() const
+    {
+        double d = 1.0;
+        NCS_UNROLL
+        for (int k = 0; k < N; k++)
+            d *= piv[k] != k ? -lu[k][k] : lu[k][k];
+        return d;
+    }
+
+    // A^-1: solve A X = I for all columns at once, by whole rows (requires ok)
+    constexpr Matrix<N> inverse() const
+    {
+        Matrix<N> x;
+        NCS_UNROLL
+        for (int i = 0; i < N; i++)
+            x[i][i] = 1.0;
+        NCS_UNROLL
+        for (int k = 0; k < N; k++)
+            swapRows(x.a, k, piv[k]);
+        NCS_UNROLL
+        for (int i = 1; i < N; i++)
+            NCS_UNROLL
+            for (int j = 0; j < i; j++)
+                rowAxpy(x.a, i, j, -lu[i][j]);
+        NCS_UNROLL
+        for (int i = N - 1; i >= 0; i--)
+        {
+            NCS_UNROLL
+            for (int j = i + 1; j < N; j++)
+                rowAxpy(x.a, i, j, -lu[i][j]);
+            rowScale(x.a, i, 1.0 / lu[i][i]);
+        }
+        return x;
+    }
+};
+
+template <int N>
+struct Cholesky
+{
+    Matrix<N> L;     // lower triangle; only the lower triangle of A is read
+    bool ok = false; // every pivot >= PIVOT_EPS (A positive definite)
+
+    constexpr Cholesky() = default;
+
+    constexpr explicit Cholesky(const Matrix<N> &a)
+    {
+        ok = true;
+        NCS_UNROLL
+        for (int j = 0; j < N; j++)
+        {
+            double s = a[j][j];
+            NCS_UNROLL
+            for (int k = 0; k < j; k++)
+                s -= L[j][k] * L[j][k];
+            ok = ok && s >= PIVOT_EPS; // no early exit, as in LU
+            L[j][j] = sqrtC(s);
+            NCS_UNROLL
+            for (int i = j + 1; i < N; i++)
+            {
+                double t = a[i][j];
+                NCS_UNROLL
+                for (int k = 0; k < j; k++)
+                    t -= L[i][k] * L[j][k];
+                L[i][j] = t / L[j][j];
+            }
+        }
+    }
+
+    // x = A^-1 b: L y = b, then L^T x = y (requires ok)
+    constexpr Vector<N> solve(Vector<N> b) const
+    {
+        NCS_UNROLL
+        for (int i = 0; i < N; i++)
+        {
+            NCS_UNROLL
+            for (int j = 0; j < i; j++)
+                b[i] -= L[i][j] * b[j];
+            b[i] /= L[i][i];
+        }
+        NCS_UNROLL
+        for (int i = N - 1; i >= 0; i--)
+        {
+            NCS_UNROLL
+            for (int j = i + 1; j < N; j++)
+                b[i] -= L[j][i] * b[j];
+            b[i] /= L[i][i];
+        }
+        return b;
+    }
+
+    constexpr double determinant() const
+    {
+        double d = 1.0;
+        NCS_UNROLL
+        for (int k = 0; k < N; k++)
+            d *= L[k][k] * L[k][k];
+        return d;
+    }
+
+    // A^-1 = L^-T L^-1, by whole rows as in LU::inverse
+    constexpr Matrix<N> inverse() const
+    {
+        Matrix<N> x;
+        NCS_UNROLL
+        for (int i = 0; i < N; i++)
+            x[i][i] = 1.0;
+        NCS_UNROLL
+        for (int i = 0; i < N; i++)
+        {
+            NCS_UNROLL
+            for (int j = 0; j < i; j++)
+                rowAxpy(x.a, i, j, -L[i][j]);
+            rowScale(x.a, i, 1.0 / L[i][i]);
+        }
+        NCS_UNROLL
+        for (int i = N - 1; i >= 0; i--)
+        {
+            NCS_UNROLL
+            for (int j = i + 1; j < N; j++)
+                rowAxpy(x.a, i, j, -L[j][i]);
+            rowScale(x.a, i, 1.0 / L[i][i]);
+        }
+        return x;
+    }
+};
+
+/*
+   Gauss-Jordan inversion in n^2 storage, step for step the one of
+   gj::invertInPlace. Returns false (inv is then garbage) if A is
+   singular.
+*/
+template <int N>
+constexpr bool gaussJordanInverse(const Matrix<N> &a, Matrix<N> &inv)
+{
+    inv = a;
+    int piv[N] = {};
+    bool ok = true;
+    NCS_UNROLL
+    for (int k = 0; k < N; k++)
+    {
+        int p = pivotRow(inv.a, k);
+        ok = ok && absC(inv[p][k]) >= PIVOT_EPS; // no early exit, as in LU
+        piv[k] = p;
+        swapRows(inv.a, k, p);
+
+        double r = 1.0 / inv[k][k];
+        inv[k][k] = 1.0;
+        rowScale(inv.a, k, r);
+
+        // No skip for f == 0 as in gj::invertInPlace: a branch per row costs
+        // more than the row at these sizes, and the result is the same
+        NCS_UNROLL
+        for (int i = 0; i < N; i++)
+        {
+            if (i == k)
+                continue;
+            double f = inv[i][k];
+            inv[i][k] = 0.0;
+            rowAxpy(inv.a, i, k, -f);
+        }
+    }
+
+    // Undo the row interchanges on the columns
+    NCS_UNROLL
+    for (int k = N - 1; k >= 0; k--)
+        swapColumns(inv.a, k, piv[k]);
+    return ok;
+}
+
+// [A | b] -> [I | x] with partial pivoting; false if A is singular
+template <int N>
+constexpr bool gaussJordanSolve(Matrix<N> a, Vector<N> b, Vector<N> &x)
+{
+    bool ok = true;
+    NCS_UNROLL
+    for (int k = 0; k < N; k++)
+    {
+        int p = pivotRow(a.a, k);
+        ok = ok && absC(a[p][k]) >= PIVOT_EPS;
+        swapRows(a.a, k, p);
+        swapEntries(b.v, k, p);
+
+        double r = 1.0 / a[k][k];
+        NCS_UNROLL
+        for (int j = k; j < N; j++)
+            a[k][j] *= r;
+        b[k] *= r;
+
+        NCS_UNROLL
+        for (int i = 0; i < N; i++)
+        {
+            if (i == k)
+                continue;
+            double f = a[i][k];
+            NCS_UNROLL
+            for (int j = k; j < N; j++)
+                a[i][j] -= f * a[k][j];
+            b[i] -= f * b[k];
+        }
+    }
+    x = b;
+    return ok;
+}
+
+// Kernels behind the run-time dispatch, on row-major arrays
+template <int N>
+struct Kernels
+{
+    static Matrix<N> load(const double *a, int lda)
+    {
+        Matrix<N> m;
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                m[i][j] = a[(size_t)i * lda + j];
+        return m;
+    }
+
+    static Vector<N> loadVector(const double *b)
+    {
+        Vector<N> v;
+        for (int i = 0; i < N; i++)
+            v[i] = b[i];
+        return v;
+    }
+
+    static void store(const Matrix<N> &m, double *a, int lda)
+    {
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                a[(size_t)i * lda + j] = m[i][j];
+    }
+
+    static bool solve(const double *a, int lda, const double *b, double *x, double *det)
+    {
+        LU<N> F(load(a, lda));
+        if (det)
+            *det = F.determinant();
+        if (!F.ok)
+            return false;
+        Vector<N> v = F.solve(loadVector(b));
+        std::copy(v.v, v.v + N, x);
+        return true;
+    }
+
+    static bool inverse(const double *a, int lda, double *inv, int ldinv)
+    {
+        LU<N> F(load(a, lda));
+        if (!F.ok)
+            return false;
+        store(F.inverse(), inv, ldinv);
+        return true;
+    }
+
+    static bool solveCholesky(const double *a, int lda, const double *b, double *x)
+    {
+        Cholesky<N> F(load(a, lda));
+        if (!F.ok)
+            return false;
+        Vector<N> v = F.solve(loadVector(b));
+        std::copy(v.v, v.v + N, x);
+        return true;
+    }
+
+    static bool solveGaussJordan(const double *a, int lda, const double *b, double *x)
+    {
+        Vector<N> v;
+        if (!gaussJordanSolve(load(a, lda), loadVector(b), v))
+            return false;
+        std::copy(v.v, v.v + N, x);
+        return true;
+    }
+
+    static bool invertGaussJordan(double *a, int lda)
+    {
+        Matrix<N> inv;
+        if (!gaussJordanInverse(load(a, lda), inv))
+            return false;
+        store(inv, a, lda);
+        return true;
+    }
+};
+
+struct KernelSet
+{
+    bool (*solve)(const double *, int, const double *, double *, double *);
+    bool (*inverse)(const double *, int, double *, int);
+    bool (*solveCholesky)(const double *, int, const double *, double *);
+    bool (*solveGaussJordan)(const double *, int, const double *, double *);
+    bool (*invertGaussJordan)(double *, int);
+};
+
+template <int N>
+constexpr KernelSet kernelsOf()
+{
+    return {Kernels<N>::solve, Kernels<N>::inverse, Kernels<N>::solveCholesky,
+            Kernels<N>::solveGaussJordan, Kernels<N>::invertGaussJordan};
+}
+
+// Kernels for size n (1..MAX_N), nullptr otherwise
+inline const KernelSet *kernelsFor(int n)
+{
+    static const KernelSet table[MAX_N] = {
+        kernelsOf<1>(), kernelsOf<2>(), kernelsOf<3>(), kernelsOf<4>(),
+        kernelsOf<5>(), kernelsOf<6>(), kernelsOf<7>(), kernelsOf<8>(),
+        kernelsOf<9>(), kernelsOf<10>(), kernelsOf<11>(), kernelsOf<12>(),
+        kernelsOf<13>(), kernelsOf<14>(), kernelsOf<15>(), kernelsOf<16>()};
+    return n >= 1 && n <= MAX_N ? &table[n - 1] : nullptr;
+}
+
+/*
+   Run-time n: the n x n matrix a has leading dimension lda. Each returns
+   false when n is outside 1..MAX_N or the factorization breaks down, and
+   then leaves its outputs unspecified.
+*/
+
+// x = A^-1 b by LU<n>; det(A) from the same factors if det is given
+inline bool solve(int n, const double *a, int lda, const double *b, double *x, double *det = nullptr)
+{
+    const KernelSet *k = kernelsFor(n);
+    return k && k->solve(a, lda, b, x, det);
+}
+
+// inv (leading dimension ldinv) = A^-1 by LU<n>
+inline bool inverse(int n, const double *a, int lda, double *inv, int ldinv)
+{
+    const KernelSet *k = kernelsFor(n);
+    return k && k->inverse(a, lda, inv, ldinv);
+}
+
+// x = A^-1 b by Cholesky<n> (false also when A is not positive definite)
+inline bool solveCholesky(int n, const double *a, int lda, const double *b, double *x)
+{
+    const KernelSet *k = kernelsFor(n);
+    return k && k->solveCholesky(a, lda, b, x);
+}
+
+// x = A^-1 b by gaussJordanSolve<n>
+inline bool solveGaussJordan(int n, const double *a, int lda, const double *b, double *x)
+{
+    const KernelSet *k = kernelsFor(n);
+    return k && k->solveGaussJordan(a, lda, b, x);
+}
+
+// Overwrite A with A^-1 by gaussJordanInverse<n>
+inline bool invertGaussJordan(int n, double *a, int lda)
+{
+    const KernelSet *k = kernelsFor(n);
+    return k && k->invertGaussJordan(a, lda);
+}
+
+} // namespace fx
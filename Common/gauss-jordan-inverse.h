@@ -0,0 +1,148 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "fixed-size-solvers.h"
+#include "thread-pool.h"
+
+/*
+   Gauss-Jordan Inversion ([A | I] -> [I | A^-1], in place)
+
+   Reducing [A | I] to [I | A^-1] needs no extra n x n block: at step k the
+   column k of A has just become a unit vector e_k, while the column k of the
+   right half has only now stopped being e_k. So the right-half column can be
+   stored in the slot the left-half column frees up:
+
+     pivot row p = argmax |a[i][k]|, i >= k; swap rows k and p
+     r = 1 / a[k][k]; a[k][k] = 1; row k *= r
+     for every other row i: f = a[i][k]; a[i][k] = 0; row i -= f * row k
+
+   Row interchanges of [A | I] permute the columns of the stored right half,
+   so at the end the recorded swaps are undone on the columns in reverse
+   order. A matrix is overwritten by its inverse using n ints of scratch.
+
+   BatchInverter inverts many independent matrices (e.g. thousands of small
+   ones from one input file) on a ThreadPool. Matrices are stored back to
+   back in one buffer, each participant has its own scratch arena allocated
+   once up front, so the parallel loop does no allocation at all. Matrices
+   up to FIXED_MAX_N go through the unrolled fx::gaussJordanInverse of the
+   same algorithm (fixed-size-solvers.h), 2-3x faster at those sizes.
+*/
+
+namespace gj
+{
+
+const double PIVOT_EPS = 1e-12; // same threshold as the elimination programs
+const int FIXED_MAX_N = 8;      // fixed-size kernels up to here (measured faster)
+
+/*
+   Overwrite the n x n matrix a (leading dimension lda) with its inverse.
+   piv is scratch for n ints. Returns false if a pivot is below PIVOT_EPS
+   (A is singular); a is then left partially reduced.
+*/
+inline bool invertInPlace(double *a, int n, int lda, int *piv)
+{
+    for (int k = 0; k < n; k++)
+    {
+        int p = k;
+        double best = std::fabs(a[(size_t)k * lda + k]);
+        for (int i = k + 1; i < n; i++)
+        {
+            double v = std::fabs(a[(size_t)i * lda + k]);
+            if (v > best)
+            {
+                best = v;
+                p = i;
+            }
+        }
+        if (!(best >= PIVOT_EPS))
+            return false;
+
+        piv[k] = p;
+        double *rowK = a + (size_t)k * lda;
+        if (p != k)
+            std::swap_ranges(rowK, rowK + n, a + (size_t)p * lda);
+
+        double r = 1.0 / rowK[k];
+        rowK[k] = 1.0;
+        for (int j = 0; j < n; j++)
+            rowK[j] *= r;
+
+        for (int i = 0; i < n; i++)
+        {
+            if (i == k)
+                continue;
+            double *row = a + (size_t)i * lda;
+            double f = row[k];
+            if (f == 0.0)
+                continue;
+            row[k] = 0.0;
+            for (int j = 0; j < n; j++)
+                row[j] -= f * rowK[j];
+        }
+    }
+
+    // Undo the row interchanges on the columns of the inverse
+    for (int k = n - 1; k >= 0; k--)
+        if (piv[k] != k)
+            for (int i = 0; i < n; i++)
+                std::swap(a[(size_t)i * lda + k], a[(size_t)i * lda + piv[k]]);
+    return true;
+}
+
+/*
+   Collects matrices, inverts all of them in parallel with run(), then gives
+   each inverse (row-major n x n) or reports it singular.
+*/
+class BatchInverter
+{
+public:
+    // Copy the n x n matrix a (leading dimension lda); returns its index
+    int add(const double *a, int n, int lda)
+    {
+        int id = (int)size_.size();
+        offset_.push_back(store_.size());
+        size_.push_back(n);
+        for (int i = 0; i < n; i++)
+            store_.insert(store_.end(), a + (size_t)i * lda, a + (size_t)i * lda + n);
+        maxN_ = std::max(maxN_, n);
+        return id;
+    }
+
+    // Invert every matrix added so far
+    void run(ThreadPool &pool)
+    {
+        int count = this->count();
+        ok_.assign(count, 0);
+
+        // One arena per participant, sized for the largest matrix
+        std::vector<std::vector<int>> arenas(pool.size(), std::vector<int>(std::max(maxN_, 1)));
+
+        int grain = std::max(1, count / (8 * pool.size()));
+        pool.parallelFor(0, count, grain, [&](int lo, int hi)
+        {
+            int *piv = arenas[ThreadPool::participant()].data();
+            for (int s = lo; s < hi; s++)
+            {
+                double *a = &store_[offset_[s]];
+                int n = size_[s];
+                ok_[s] = n >= 1 && n <= FIXED_MAX_N ? fx::invertGaussJordan(n, a, n)
+                                          : invertInPlace(a, n, n, piv);
+            }
+        });
+    }
+
+    int count() const { return (int)size_.size(); }
+    int size(int s) const { return size_[s]; }
+    bool invertible(int s) const { return ok_[s] != 0; }
+
+    // Before run(): the matrix as added; after: its inverse (if invertible)
+    const double *matrix(int s) const { return &store_[offset_[s]]; }
+
+private:
+    std::vector<double> store_; // all matrices back to back, row-major
+    std::vector<size_t> offset_;
+    std::vector<int> size_;
+    std::vector<char> ok_;
+    int maxN_ = 0;
+};
+
+} // namespace gj
@@ -0,0 +1,519 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "condition-estimate.h"
+
+/*
+   Blocked LU Factorization Engine (PA = LU, partial pivoting)
+
+   The matrix lives in one contiguous row-major buffer: element (i, j) is
+   a[i * lda + j]. The factorization is right-looking and panel-blocked:
+
+     1. factor a panel of nb columns with the unblocked algorithm
+     2. solve L11 * U12 = A12 for the block row to the right of the panel
+     3. update the trailing matrix  A22 -= L21 * U12  with a packed GEMM kernel
+
+   On return the strict lower triangle holds the multipliers of L (unit
+   diagonal implied), the upper triangle holds U, and piv[i] is the row that
+   was swapped with row i at step i.
+
+   LUFactor::conditionEstimate() gives cond_1(A) from the factors in O(n^2)
+   (see condition-estimate.h).
+*/
+
+namespace lu
+{
+
+const double PIVOT_EPS = 1e-12;     // pivots below this are treated as zero
+const int DEFAULT_BLOCK_SIZE = 128; // panel width, tune for the target cache
+
+// GEMM tiling: MR x NR register tile inside MC x KC x NC cache blocks. The
+// kernels are templates on the element type T (double, or float for the
+// mixed-precision solver); a tile row is 64 bytes, i.e. 8 doubles or 16 floats.
+const int MR = 4;
+const int NR = 8;
+const int MC = 128;
+const int KC = 256;
+const int NC = 2048;
+
+template <typename T>
+constexpr int tileCols() { return 64 / (int)sizeof(T); }
+
+/*
+   Micro-kernel: C[mr x nr] -= Apack * Bpack over kc terms.
+   Apack is stored MR-interleaved (kc x MR), Bpack NR-interleaved (kc x NR),
+   so both are read with unit stride and the accumulators stay in registers.
+*/
+template <typename T>
+inline void microKernel(int kc, const T *ap, const T *bp,
+                        T *c, int ldc, int mr, int nr)
+{
+    // One tile row as a single 64-byte vector value (GCC/clang vector
+    // extension), so each accumulator row is one register on AVX-512
+    typedef T TileRow __attribute__((vector_size(64)));
+    constexpr int NR = tileCols<T>();
+
+    TileRow acc[MR] = {};
+    for (int p = 0; p < kc; p++)
+    {
+        TileRow bRow;
+        std::memcpy(&bRow, bp + p * NR, sizeof(bRow));
+        for (int r = 0; r < MR; r++)
+            acc[r] += ap[p * MR + r] * bRow;
+    }
+
+    for (int r = 0; r < mr; r++)
+        for (int s = 0; s < nr; s++)
+            c[r * ldc + s] -= acc[r][s];
+}
+
+// Pack an mc x kc block of A into MR-row strips (zero-padded at the edge)
+template <typename T>
+inline void packA(const T *a, int lda, int mc, int kc, T *ap)
+{
+    for (int i0 = 0; i0 < mc; i0 += MR)
+    {
+        int mr = std::min(MR, mc - i0);
+        for (int p = 0; p < kc; p++)
+        {
+            for (int r = 0; r < mr; r++)
+                ap[p * MR + r] = a[(i0 + r) * lda + p];
+            for (int r = mr; r < MR; r++)
+                ap[p * MR + r] = 0.0;
+        }
+        ap += kc * MR;
+    }
+}
+
+// Pack a kc x nc block of B into NR-column strips (zero-padded at the edge)
+template <typename T>
+inline void packB(const T *b, int ldb, int kc, int nc, T *bp)
+{
+    constexpr int NR = tileCols<T>();
+    for (int j0 = 0; j0 < nc; j0 += NR)
+    {
+        int nr = std::min(NR, nc - j0);
+        for (int p = 0; p < kc; p++)
+        {
+            const T *src = b + p * ldb + j0;
+            for (int s = 0; s < nr; s++)
+                bp[p * NR + s] = src[s];
+            for (int s = nr; s < NR; s++)
+                bp[p * NR + s] = 0.0;
+        }
+        bp += kc * NR;
+    }
+}
+
+/*
+   C[m x n] -= A[m x k] * B[k x n], all row-major with leading dimensions.
+   Goto-style loop nest: NC column blocks, KC depth blocks, MC row blocks.
+*/
+template <typename T>
+inline void gemmMinus(int m, int n, int k,
+                      const T *a, int lda,
+                      const T *b, int ldb,
+                      T *c, int ldc)
+{
+    if (m <= 0 || n <= 0 || k <= 0)
+        return;
+
+    // Packing buffers sized for this call and kept per thread: a small
+    // update (many small matrices) then costs no allocation or zero fill
+    constexpr int NR = tileCols<T>();
+    thread_local std::vector<T> bPack, aPack;
+    size_t kcMax = std::min(KC, k);
+    if (bPack.size() < kcMax * (std::min(NC, n) + NR))
+        bPack.resize(kcMax * (std::min(NC, n) + NR));
+    if (aPack.size() < kcMax * (std::min(MC, m) + MR))
+        aPack.resize(kcMax * (std::min(MC, m) + MR));
+
+    for (int jc = 0; jc < n; jc += NC)
+    {
+        int nc = std::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC)
+        {
+            int kc = std::min(KC, k - pc);
+            packB(b + (size_t)pc * ldb + jc, ldb, kc, nc, bPack.data());
+
+            for (int ic = 0; ic < m; ic += MC)
+            {
+                int mc = std::min(MC, m - ic);
+                packA(a + (size_t)ic * lda + pc, lda, mc, kc, aPack.data());
+
+                for (int jr = 0; jr < nc; jr += NR)
+                {
+                    int nr = std::min(NR, nc - jr);
+                    const T *bp = bPack.data() + (size_t)(jr / NR) * kc * NR;
+                    for (int ir = 0; ir < mc; ir += MR)
+                    {
+                        int mr = std::min(MR, mc - ir);
+                        const T *ap = aPack.data() + (size_t)(ir / MR) * kc * MR;
+                        microKernel(kc, ap, bp,
+                                    c + (size_t)(ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*
+   Unblocked factorization of the panel holding columns [k, k + kb) and rows
+   [k, n). Row interchanges swap whole rows so the matrix stays consistent.
+   A column whose largest candidate pivot is below pivotEps is left as a
+   zero pivot and not eliminated. Returns the number of such columns.
+*/
+template <typename T>
+inline int panelFactor(T *a, int n, int lda, int k, int kb, std::vector<int> &piv,
+                       double pivotEps = PIVOT_EPS)
+{
+    int zeroPivots = 0;
+    int kEnd = k + kb;
+
+    for (int j = k; j < kEnd; j++)
+    {
+        int p = j;
+        T best = std::abs(a[(size_t)j * lda + j]);
+        for (int i = j + 1; i < n; i++)
+        {
+            T v = std::abs(a[(size_t)i * lda + j]);
+            if (v > best)
+            {
+                best = v;
+                p = i;
+            }
+        }
+
+        piv[j] = p;
+        if (p != j)
+            std::swap_ranges(a + (size_t)j * lda, a + (size_t)j * lda + n, a + (size_t)p * lda);
+
+        T *pivotRow = a + (size_t)j * lda;
+        if (best < pivotEps)
+        {
+            zeroPivots++;
+            for (int i = j + 1; i < n; i++)
+                a[(size_t)i * lda + j] = 0.0;
+            continue;
+        }
+
+        for (int i = j + 1; i < n; i++)
+        {
+            T *row = a + (size_t)i * lda;
+            T factor = row[j] / pivotRow[j];
+            row[j] = factor;
+            for (int c = j + 1; c < kEnd; c++)
+                row[c] -= factor * pivotRow[c];
+        }
+    }
+    return zeroPivots;
+}
+
+/*
+   Factor the n x n matrix in place. piv is resized to n. onPanel, if given,
+   is called as onPanel(k, kb) after the panel starting at column k and the
+   trailing update it drives are complete; with blockSize = 1 this reproduces
+   the textbook one-column-per-step elimination. Pivots below pivotEps
+   count as zero.
+   Returns the number of zero pivots (0 means the matrix is non-singular).
+*/
+template <typename T>
+inline int factor(T *a, int n, int lda, std::vector<int> &piv,
+                  int blockSize = DEFAULT_BLOCK_SIZE,
+                  const std::function<void(int, int)> &onPanel = nullptr,
+                  double pivotEps = PIVOT_EPS)
+{
+    piv.resize(n);
+    int nb = std::max(1, blockSize);
+    int zeroPivots = 0;
+
+    for (int k = 0; k < n; k += nb)
+    {
+        int kb = std::min(nb, n - k);
+        int kEnd = k + kb;
+
+        zeroPivots += panelFactor(a, n, lda, k, kb, piv, pivotEps);
+
+        // U12 = L11^{-1} * A12 (unit lower triangular solve, row-wise)
+        int rest = n - kEnd;
+        if (rest > 0)
+        {
+            for (int i = k + 1; i < kEnd; i++)
+            {
+                T *row = a + (size_t)i * lda + kEnd;
+                for (int p = k; p < i; p++)
+                {
+                    T l = a[(size_t)i * lda + p];
+                    if (l == 0)
+                        continue;
+                    const T *src = a + (size_t)p * lda + kEnd;
+                    for (int c = 0; c < rest; c++)
+                        row[c] -= l * src[c];
+                }
+            }
+
+            // A22 -= L21 * U12
+            gemmMinus(rest, rest, kb,
+                      a + (size_t)kEnd * lda + k, lda,
+                      a + (size_t)k * lda + kEnd, lda,
+                      a + (size_t)kEnd * lda + kEnd, lda);
+        }
+
+        if (onPanel)
+            onPanel(k, kb);
+    }
+    return zeroPivots;
+}
+
+// Apply the row interchanges recorded in piv to a vector (b := P * b)
+inline void applyPivots(const std::vector<int> &piv, std::vector<double> &b)
+{
+    for (int i = 0; i < (int)piv.size(); i++)
+        if (piv[i] != i)
+            std::swap(b[i], b[piv[i]]);
+}
+
+// Sign of the permutation P (+1 or -1)
+inline int pivotSign(const std::vector<int> &piv)
+{
+    int sign = 1;
+    for (int i = 0; i < (int)piv.size(); i++)
+        if (piv[i] != i)
+            sign = -sign;
+    return sign;
+}
+
+/*
+   Factor-once LU object. Holds the packed L\U factors and the pivot
+   permutation of one matrix so that any number of right-hand sides can be
+   solved in O(n^2) each instead of refactoring in O(n^3).
+
+   Right-hand sides are passed as an n x k row-major block B (leading
+   dimension ldb >= k); the batched solves are blocked triangular solves
+   (TRSM) whose off-diagonal updates go through the same GEMM kernel as
+   the factorization.
+*/
+class LUFactor
+{
+public:
+    LUFactor() = default;
+
+    LUFactor(const double *a, int n, int lda, int blockSize = DEFAULT_BLOCK_SIZE)
+    {
+        factorize(a, n, lda, blockSize);
+    }
+
+    // Copy A and factor it; returns the number of zero pivots
+    int factorize(const double *a, int n, int lda,
+                  int blockSize = DEFAULT_BLOCK_SIZE,
+                  const std::function<void(int, int)> &onPanel = nullptr)
+    {
+        n_ = n;
+        nb_ = std::max(1, blockSize);
+        lu_.resize((size_t)n * n);
+        for (int i = 0; i < n; i++)
+            std::copy(a + (size_t)i * lda, a + (size_t)i * lda + n, lu_.begin() + (size_t)i * n);
+        zeroPivots_ = factor(lu_.data(), n, n, piv_, nb_, onPanel);
+        return zeroPivots_;
+    }
+
+    int size() const { return n_; }
+    int zeroPivots() const { return zeroPivots_; }
+    bool singular() const { return zeroPivots_ > 0; }
+    const std::vector<double> &packed() const { return lu_; }
+    const std::vector<int> &pivots() const { return piv_; }
+
+    double L(int i, int j) const { return i == j ? 1.0 : (i > j ? lu_[(size_t)i * n_ + j] : 0.0); }
+    double U(int i, int j) const { return i <= j ? lu_[(size_t)i * n_ + j] : 0.0; }
+
+    // Product of the diagonal of U, and det(A) = sign(P) * det(U)
+    double detU() const
+    {
+        double d = 1.0;
+        for (int i = 0; i < n_; i++)
+            d *= lu_[(size_t)i * n_ + i];
+        return d;
+    }
+    double determinant() const
+    {
+        double d = detU();
+        return d == 0.0 ? 0.0 : pivotSign(piv_) * d; // no "-0" for singular A
+    }
+
+    // B := P * B
+    void permute(double *b, int k, int ldb) const
+    {
+        for (int i = 0; i < n_; i++)
+            if (piv_[i] != i)
+                std::swap_ranges(b + (size_t)i * ldb, b + (size_t)i * ldb + k,
+                                 b + (size_t)piv_[i] * ldb);
+    }
+
+    // B := L^{-1} * B (unit lower triangular)
+    void solveLower(double *b, int k, int ldb) const
+    {
+        for (int i0 = 0; i0 < n_; i0 += nb_)
+        {
+            int i1 = std::min(n_, i0 + nb_);
+
+            // Diagonal block by row axpys
+            for (int i = i0 + 1; i < i1; i++)
+            {
+                double *row = b + (size_t)i * ldb;
+                for (int p = i0; p < i; p++)
+                {
+                    double l = lu_[(size_t)i * n_ + p];
+                    if (l == 0.0)
+                        continue;
+                    const double *src = b + (size_t)p * ldb;
+                    for (int c = 0; c < k; c++)
+                        row[c] -= l * src[c];
+                }
+            }
+
+            // Rows below: B2 -= L21 * B1
+            gemmMinus(n_ - i1, k, i1 - i0,
+                      lu_.data() + (size_t)i1 * n_ + i0, n_,
+                      b + (size_t)i0 * ldb, ldb,
+                      b + (size_t)i1 * ldb, ldb);
+        }
+    }
+
+    // B := U^{-1} * B (requires a non-singular U)
+    void solveUpper(double *b, int k, int ldb) const
+    {
+        int lastStart = ((n_ - 1) / nb_) * nb_;
+        for (int i0 = lastStart; i0 >= 0; i0 -= nb_)
+        {
+            int i1 = std::min(n_, i0 + nb_);
+
+            // Diagonal block, bottom to top
+            for (int i = i1 - 1; i >= i0; i--)
+            {
+                double *row = b + (size_t)i * ldb;
+                for (int p = i + 1; p < i1; p++)
+                {
+                    double u = lu_[(size_t)i * n_ + p];
+                    if (u == 0.0)
+                        continue;
+                    const double *src = b + (size_t)p * ldb;
+                    for (int c = 0; c < k; c++)
+                        row[c] -= u * src[c];
+                }
+                double diag = lu_[(size_t)i * n_ + i];
+                for (int c = 0; c < k; c++)
+                    row[c] /= diag;
+            }
+
+            // Rows above: B0 -= U01 * B1
+            gemmMinus(i0, k, i1 - i0,
+                      lu_.data() + i0, n_,
+                      b + (size_t)i0 * ldb, ldb,
+                      b, ldb);
+        }
+    }
+
+    // Solve A * X = B in place for an n x k block of right-hand sides
+    void solve(double *b, int k, int ldb) const
+    {
+        permute(b, k, ldb);
+        solveLower(b, k, ldb);
+        solveUpper(b, k, ldb);
+    }
+
+    std::vector<double> solve(const std::vector<double> &rhs, int k) const
+    {
+        std::vector<double> x = rhs;
+        solve(x.data(), k, k);
+        return x;
+    }
+
+    // Single right-hand side: plain forward and back substitution
+    std::vector<double> solve(const std::vector<double> &rhs) const
+    {
+        std::vector<double> x = rhs;
+        applyPivots(piv_, x);
+        for (int i = 0; i < n_; i++)
+        {
+            const double *row = lu_.data() + (size_t)i * n_;
+            double sum = 0;
+            for (int j = 0; j < i; j++)
+                sum += row[j] * x[j];
+            x[i] -= sum;
+        }
+        for (int i = n_ - 1; i >= 0; i--)
+        {
+            const double *row = lu_.data() + (size_t)i * n_;
+            double sum = 0;
+            for (int j = i + 1; j < n_; j++)
+                sum += row[j] * x[j];
+            x[i] = (x[i] - sum) / row[i];
+        }
+        return x;
+    }
+
+    // x := A^{-T} x for one vector: U^T y = x, L^T z = y, x = P^T z
+    void solveTransposed(double *x) const
+    {
+        for (int i = 0; i < n_; i++)
+        {
+            const double *row = lu_.data() + (size_t)i * n_;
+            x[i] /= row[i];
+            for (int j = i + 1; j < n_; j++)
+                x[j] -= row[j] * x[i];
+        }
+        for (int i = n_ - 1; i > 0; i--)
+        {
+            const double *row = lu_.data() + (size_t)i * n_;
+            for (int j = 0; j < i; j++)
+                x[j] -= row[j] * x[i];
+        }
+        for (int i = n_ - 1; i >= 0; i--)
+            if (piv_[i] != i)
+                std::swap(x[i], x[piv_[i]]);
+    }
+
+    /*
+       Estimated cond_1(A) = ||A||_1 * ||A^-1||_1, where normA1 is ||A||_1 of
+       the factored matrix (cond::norm1). Infinite when U has a zero pivot.
+    */
+    double conditionEstimate(double normA1) const
+    {
+        for (int i = 0; i < n_; i++)
+            if (lu_[(size_t)i * n_ + i] == 0.0)
+                return std::numeric_limits<double>::infinity();
+        double inverseNorm = cond::inverseNorm1(n_,
+            [&](double *x) { solve(x, 1, 1); },
+            [&](double *x) { solveTransposed(x); });
+        return normA1 * inverseNorm;
+    }
+
+    // A^{-1} as an n x n row-major buffer, from A * X = I (non-singular A only)
+    std::vector<double> inverse() const
+    {
+        std::vector<double> inv((size_t)n_ * n_, 0.0);
+        for (int i = 0; i < n_; i++)
+            inv[(size_t)i * n_ + i] = 1.0;
+        solve(inv.data(), n_, n_);
+        return inv;
+    }
+
+    // adj(A) = det(A) * A^{-1} (non-singular A only)
+    std::vector<double> adjugate() const
+    {
+        std::vector<double> adj = inverse();
+        double det = determinant();
+        for (double &v : adj)
+            v *= det;
+        return adj;
+    }
+
+private:
+    int n_ = 0;
+    int nb_ = DEFAULT_BLOCK_SIZE;
+    int zeroPivots_ = 0;
+    std::vector<double> lu_;
+    std::vector<int> piv_;
+};
+
+} // namespace lu
@@ -0,0 +1,270 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   Contiguous Matrix
+
+   Matrix<T> stores rows x cols elements in ONE 64-byte aligned buffer
+   (row-major, physical row r at data() + r * ld()) plus a table of row
+   pointers, so a matrix costs two allocations no matter how many rows it has
+   and rows can be handed straight to SIMD kernels.
+
+     a[i][j], a(i, j)     element access through the row table
+     a.swapRows(i, k)     O(1): swaps two row pointers, no data moves
+     a.compact()          physically reorder the rows to match the row table
+     a.view(), a.block(), a.col(j), a.transposed()
+                          strided views of the physical buffer
+
+   After swapRows the logical row order (a[i]) differs from the physical
+   one; views and data()/ld() always refer to the physical layout, so call
+   compact() first when that matters (permuted() tells). assign() and
+   appendRow() reuse the existing capacity, so a matrix declared outside a
+   loop stops allocating once it has reached its largest size.
+
+   Matrix<T>::borrow(ptr, rows, cols) wraps an existing row-major buffer
+   (e.g. a memory-mapped input file) without copying it; the buffer is not
+   freed by the matrix and must outlive it.
+
+   T must be trivially copyable (double, float, long double, int, ...).
+*/
+
+namespace mat
+{
+
+const size_t ALIGNMENT = 64; // cache line; also the widest SIMD register
+
+// Non-owning strided 2D window: element (i, j) is at ptr[i * rowStride + j * colStride]
+template <typename T>
+struct MatrixView
+{
+    T *ptr = nullptr;
+    int rows = 0, cols = 0;
+    std::ptrdiff_t rowStride = 0, colStride = 1;
+
+    T &operator()(int i, int j) const { return ptr[i * rowStride + j * colStride]; }
+
+    MatrixView block(int r0, int c0, int nr, int nc) const
+    {
+        return {&(*this)(r0, c0), nr, nc, rowStride, colStride};
+    }
+    MatrixView row(int i) const { return block(i, 0, 1, cols); }
+    MatrixView col(int j) const { return block(0, j, rows, 1); }
+    MatrixView transposed() const { return {ptr, cols, rows, colStride, rowStride}; }
+
+    // A view of T converts to a read-only view of const T
+    template <typename U = T, typename = std::enable_if_t<!std::is_const<U>::value>>
+    operator MatrixView<const U>() const { return {ptr, rows, cols, rowStride, colStride}; }
+};
+
+template <typename T>
+class Matrix
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Matrix<T> stores raw elements and needs a trivially copyable T");
+
+public:
+    Matrix() = default;
+
+    Matrix(int rows, int cols, const T &value = T()) { assign(rows, cols, value); }
+
+    // Copy a row-major buffer with leading dimension ld
+    Matrix(int rows, int cols, const T *values, int ld)
+    {
+        assign(rows, cols);
+        for (int i = 0; i < rows; i++)
+            std::copy(values + (size_t)i * ld, values + (size_t)i * ld + cols, rows_[i]);
+    }
+
+    // Non-owning matrix over rows x cols elements at data (leading dimension cols)
+    static Matrix borrow(T *data, int rows, int cols)
+    {
+        Matrix m;
+        m.buf_ = Buffer(data, AlignedDelete{false});
+        m.capacity_ = (size_t)rows * cols;
+        m.cols_ = cols;
+        m.rows_.resize(rows);
+        for (int i = 0; i < rows; i++)
+            m.rows_[i] = data + (size_t)i * cols;
+        return m;
+    }
+
+    Matrix(std::initializer_list<std::initializer_list<T>> init)
+    {
+        int r = (int)init.size();
+        int c = r ? (int)init.begin()->size() : 0;
+        assign(r, c);
+        int i = 0;
+        for (const auto &row : init)
+        {
+            if ((int)row.size() != c)
+                throw std::invalid_argument("Matrix: ragged initializer list");
+            std::copy(row.begin(), row.end(), rows_[i++]);
+        }
+    }
+
+    Matrix(const Matrix &other) { *this = other; }
+
+    Matrix &operator=(const Matrix &other)
+    {
+        if (this == &other)
+            return *this;
+        assign(other.rows(), other.cols());
+        for (int i = 0; i < other.rows(); i++)
+            rows_[i] = data() + (other.rows_[i] - other.data()); // keep the row order
+        std::copy(other.data(), other.data() + (size_t)other.rows() * other.ld(), data());
+        permuted_ = other.permuted_;
+        return *this;
+    }
+
+    // Moving keeps the buffer, so the row pointers stay valid
+    Matrix(Matrix &&other) noexcept { swap(other); }
+
+    Matrix &operator=(Matrix &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    void swap(Matrix &other) noexcept
+    {
+        std::swap(buf_, other.buf_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(permuted_, other.permuted_);
+    }
+
+    // Resize to rows x cols filled with value; reallocates only to grow
+    void assign(int rows, int cols, const T &value = T())
+    {
+        rows = std::max(rows, 0);
+        cols = std::max(cols, 0);
+        reserve((size_t)rows * cols);
+        cols_ = cols;
+        std::fill(data(), data() + (size_t)rows * cols, value);
+        rows_.resize(rows);
+        for (int i = 0; i < rows; i++)
+            rows_[i] = data() + (size_t)i * cols;
+        permuted_ = false;
+    }
+
+    // Append one row (cols() values; sets cols() if the matrix is empty)
+    void appendRow(const T *values, int count)
+    {
+        if (rows() == 0)
+            cols_ = count;
+        else if (count != cols_)
+            throw std::invalid_argument("Matrix::appendRow: row length mismatch");
+        size_t need = (size_t)(rows() + 1) * cols_;
+        if (need > capacity_)
+            reserve(std::max(need, 2 * capacity_));
+        rows_.push_back(data() + (size_t)rows() * cols_);
+        std::copy(values, values + count, rows_.back());
+    }
+
+    void appendRow(const std::vector<T> &values) { appendRow(values.data(), (int)values.size()); }
+
+    // Make room for `elements` without changing the contents or row order
+    void reserve(size_t elements)
+    {
+        if (elements <= capacity_)
+            return;
+        T *old = data();
+        Buffer fresh(static_cast<T *>(::operator new(elements * sizeof(T), std::align_val_t(ALIGNMENT))));
+        if (old)
+        {
+            std::copy(old, old + (size_t)rows() * cols_, fresh.get());
+            for (T *&r : rows_)
+                r = fresh.get() + (r - old);
+        }
+        buf_ = std::move(fresh);
+        capacity_ = elements;
+    }
+
+    int rows() const { return (int)rows_.size(); }
+    int cols() const { return cols_; }
+    int ld() const { return cols_; } // physical leading dimension
+    bool empty() const { return rows_.empty() || cols_ == 0; }
+
+    T *data() { return buf_.get(); }
+    const T *data() const { return buf_.get(); }
+
+    T *operator[](int i) { return rows_[i]; }
+    const T *operator[](int i) const { return rows_[i]; }
+    T &operator()(int i, int j) { return rows_[i][j]; }
+    const T &operator()(int i, int j) const { return rows_[i][j]; }
+
+    // Row interchange without moving any elements
+    void swapRows(int i, int k)
+    {
+        if (i == k)
+            return;
+        std::swap(rows_[i], rows_[k]);
+        permuted_ = true;
+    }
+
+    // True while the logical row order differs from the physical one
+    bool permuted() const { return permuted_; }
+
+    // Physical row index of logical row i
+    int physicalRow(int i) const { return (int)((rows_[i] - data()) / std::max(cols_, 1)); }
+
+    // Move the rows so that logical row i is physical row i again
+    void compact()
+    {
+        if (!permuted_)
+            return;
+        std::vector<T> copy(data(), data() + (size_t)rows() * cols_);
+        for (int i = 0; i < rows(); i++)
+        {
+            const T *src = copy.data() + (rows_[i] - data());
+            rows_[i] = data() + (size_t)i * cols_;
+            std::copy(src, src + cols_, rows_[i]);
+        }
+        permuted_ = false;
+    }
+
+    void fill(const T &value) { std::fill(data(), data() + (size_t)rows() * cols_, value); }
+
+    // Views of the physical buffer
+    MatrixView<T> view() { return {data(), rows(), cols_, cols_, 1}; }
+    MatrixView<const T> view() const { return {data(), rows(), cols_, cols_, 1}; }
+    MatrixView<T> block(int r0, int c0, int nr, int nc) { return view().block(r0, c0, nr, nc); }
+    MatrixView<const T> block(int r0, int c0, int nr, int nc) const { return view().block(r0, c0, nr, nc); }
+    MatrixView<T> col(int j) { return view().col(j); }
+    MatrixView<const T> col(int j) const { return view().col(j); }
+    MatrixView<T> transposed() { return view().transposed(); }
+    MatrixView<const T> transposed() const { return view().transposed(); }
+
+    // Logical (row-table order) comparison
+    bool operator==(const Matrix &other) const
+    {
+        if (rows() != other.rows() || cols() != other.cols())
+            return false;
+        for (int i = 0; i < rows(); i++)
+            if (!std::equal(rows_[i], rows_[i] + cols_, other.rows_[i]))
+                return false;
+        return true;
+    }
+    bool operator!=(const Matrix &other) const { return !(*this == other); }
+
+private:
+    struct AlignedDelete
+    {
+        bool owned = true; // false for borrow()ed buffers
+        void operator()(T *p) const
+        {
+            if (owned)
+                ::operator delete(p, std::align_val_t(ALIGNMENT));
+        }
+    };
+    using Buffer = std::unique_ptr<T, AlignedDelete>;
+
+    Buffer buf_;
+    size_t capacity_ = 0;  // elements
+    std::vector<T *> rows_; // logical row i -> its first element
+    int cols_ = 0;
+    bool permuted_ = false;
+};
+
+} // namespace mat
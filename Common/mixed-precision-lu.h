@@ -0,0 +1,260 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "lu-factor.h"
+
+/*
+   Mixed-Precision LU with Iterative Refinement
+
+   The O(n^3) factorization PA = LU is done in float: a SIMD register holds
+   twice as many floats as doubles and the matrix is half the size, so the
+   blocked factorization runs about twice as fast. Double accuracy is then
+   recovered by iterative refinement, where only O(n^2) work is done in
+   double:
+
+     x = U^-1 L^-1 P b                     (float solve)
+     repeat
+       r = b - A x                          (double, original A)
+       d = U^-1 L^-1 P r                    (float solve)
+       x = x + d
+     until ||r|| <= ||x|| * ||A|| * eps * sqrt(n)   (LAPACK dsgesv criterion)
+
+   Refinement converges when cond(A) * eps_float is well below 1. If the
+   backward error stops shrinking, the iteration limit is reached, or A does
+   not fit in float, the system is solved with a double factorization
+   instead (built once, on first need) and the result reports the fallback.
+
+   Refinement can also converge on a singular but consistent system, to one
+   of its many solutions, because rounding in float leaves the zero pivot
+   at about eps_float * ||A||. So the float factors are not used when they
+   show A to be (nearly) singular: a pivot below PIVOT_EPS * ||A||_inf,
+   |det U| below PIVOT_EPS (the test of the double path), or an estimated
+   cond_1(A) of COND_LIMIT or more.
+*/
+
+namespace lu
+{
+
+const int REFINE_MAX_ITER = 30;
+const double COND_LIMIT = 1.0 / std::numeric_limits<float>::epsilon(); // float factors cannot refine beyond this
+
+struct RefinementResult
+{
+    bool converged = false; // double accuracy reached with the float factors
+    bool fellBack = false;  // solved by the double factorization instead
+    int iterations = 0;     // corrections applied
+
+    // ||b - A x||_inf / (||A||_inf * ||x||_inf) of the initial float solve
+    // and after every correction
+    std::vector<double> backwardError;
+};
+
+class MixedLU
+{
+public:
+    // A (n x n, leading dimension lda) is kept by pointer for the residuals
+    MixedLU(const double *a, int n, int lda, int blockSize = DEFAULT_BLOCK_SIZE)
+        : a_(a), n_(n), lda_(lda), nb_(std::max(1, blockSize))
+    {
+        lu_.resize((size_t)n * n);
+        normA_ = 0.0;
+        for (int i = 0; i < n; i++)
+        {
+            double rowSum = 0.0;
+            for (int j = 0; j < n; j++)
+            {
+                double v = a[(size_t)i * lda + j];
+                if (std::fabs(v) > std::numeric_limits<float>::max())
+                    representable_ = false;
+                rowSum += std::fabs(v);
+                lu_[(size_t)i * n + j] = (float)v;
+            }
+            normA_ = std::max(normA_, rowSum);
+        }
+        if (representable_)
+            zeroPivots_ = factor(lu_.data(), n, n, piv_, nb_);
+        if (representable_ && zeroPivots_ == 0)
+            nearlySingular_ = checkSingular(cond::norm1(a, n, lda));
+    }
+
+    int size() const { return n_; }
+
+    // False if the float factorization cannot be used at all (zero pivot, A
+    // nearly singular, or entries beyond the float range); solve() then
+    // always falls back
+    bool floatUsable() const { return representable_ && zeroPivots_ == 0 && !nearlySingular_; }
+
+    // A is (nearly) singular by the float factors (see the top of the file)
+    bool nearlySingular() const { return nearlySingular_; }
+
+    // The double factorization used as fallback (built on first call)
+    const LUFactor &doubleFactor()
+    {
+        if (!fallback_)
+            fallback_ = std::make_unique<LUFactor>(a_, n_, lda_, nb_);
+        return *fallback_;
+    }
+
+    // Solve A x = b; x has room for n values
+    RefinementResult solve(const double *b, double *x, int maxIter = REFINE_MAX_ITER)
+    {
+        RefinementResult res;
+        int n = n_;
+        double tolerance = normA_ * std::numeric_limits<double>::epsilon() * std::sqrt((double)n);
+
+        if (floatUsable())
+        {
+            std::vector<double> r(b, b + n);
+            std::vector<float> d(n);
+            std::fill(x, x + n, 0.0);
+
+            for (int it = 0; it <= maxIter; it++)
+            {
+                // x += U^-1 L^-1 P r, with r scaled into the float range
+                double rMax = 0.0;
+                for (int i = 0; i < n; i++)
+                    rMax = std::max(rMax, std::fabs(r[i]));
+                if (rMax == 0.0)
+                {
+                    res.converged = true;
+                    break;
+                }
+                for (int i = 0; i < n; i++)
+                    d[i] = (float)(r[i] / rMax);
+                solveFloat(d);
+                for (int i = 0; i < n; i++)
+                    x[i] += rMax * (double)d[i];
+                if (it > 0)
+                    res.iterations++;
+
+                // r = b - A x in double
+                double xMax = 0.0, rNorm = 0.0;
+                for (int i = 0; i < n; i++)
+                {
+                    const double *row = a_ + (size_t)i * lda_;
+                    double s = 0.0;
+                    for (int j = 0; j < n; j++)
+                        s += row[j] * x[j];
+                    r[i] = b[i] - s;
+                    rNorm = std::max(rNorm, std::fabs(r[i]));
+                    xMax = std::max(xMax, std::fabs(x[i]));
+                }
+                if (!std::isfinite(rNorm))
+                    break;
+                res.backwardError.push_back(normA_ > 0 && xMax > 0 ? rNorm / (normA_ * xMax) : rNorm);
+
+                if (rNorm <= xMax * tolerance)
+                {
+                    res.converged = true;
+                    break;
+                }
+
+                // Stalled: the correction no longer halves the backward error
+                size_t k = res.backwardError.size();
+                if (k >= 2 && res.backwardError[k - 1] > 0.5 * res.backwardError[k - 2])
+                    break;
+            }
+            if (res.converged)
+                return res;
+        }
+
+        // Fall back to a full double factorization
+        res.fellBack = true;
+        std::vector<double> sol = doubleFactor().solve(std::vector<double>(b, b + n));
+        std::copy(sol.begin(), sol.end(), x);
+        return res;
+    }
+
+private:
+    // The tests of nearlySingular(), on non-singular float factors
+    bool checkSingular(double normA1) const
+    {
+        double detU = 1.0;
+        for (int i = 0; i < n_; i++)
+        {
+            double pivot = lu_[(size_t)i * n_ + i];
+            if (std::fabs(pivot) < PIVOT_EPS * normA_)
+                return true;
+            detU *= pivot;
+        }
+        if (std::fabs(detU) < PIVOT_EPS)
+            return true;
+
+        // cond_1(A) from the float factors, solved in double
+        double inverseNorm = cond::inverseNorm1(n_,
+            [&](double *x)
+            {
+                for (int i = 0; i < n_; i++)
+                    if (piv_[i] != i)
+                        std::swap(x[i], x[piv_[i]]);
+                for (int i = 0; i < n_; i++)
+                {
+                    const float *row = lu_.data() + (size_t)i * n_;
+                    for (int j = 0; j < i; j++)
+                        x[i] -= row[j] * x[j];
+                }
+                for (int i = n_ - 1; i >= 0; i--)
+                {
+                    const float *row = lu_.data() + (size_t)i * n_;
+                    for (int j = i + 1; j < n_; j++)
+                        x[i] -= row[j] * x[j];
+                    x[i] /= row[i];
+                }
+            },
+            [&](double *x)
+            {
+                for (int i = 0; i < n_; i++)
+                {
+                    const float *row = lu_.data() + (size_t)i * n_;
+                    x[i] /= row[i];
+                    for (int j = i + 1; j < n_; j++)
+                        x[j] -= row[j] * x[i];
+                }
+                for (int i = n_ - 1; i > 0; i--)
+                {
+                    const float *row = lu_.data() + (size_t)i * n_;
+                    for (int j = 0; j < i; j++)
+                        x[j] -= row[j] * x[i];
+                }
+                for (int i = n_ - 1; i >= 0; i--)
+                    if (piv_[i] != i)
+                        std::swap(x[i], x[piv_[i]]);
+            });
+        return !(normA1 * inverseNorm < COND_LIMIT);
+    }
+
+    // x := U^-1 L^-1 P x with the float factors
+    void solveFloat(std::vector<float> &x) const
+    {
+        int n = n_;
+        for (int i = 0; i < n; i++)
+            if (piv_[i] != i)
+                std::swap(x[i], x[piv_[i]]);
+        for (int i = 0; i < n; i++)
+        {
+            const float *row = lu_.data() + (size_t)i * n;
+            float sum = 0;
+            for (int j = 0; j < i; j++)
+                sum += row[j] * x[j];
+            x[i] -= sum;
+        }
+        for (int i = n - 1; i >= 0; i--)
+        {
+            const float *row = lu_.data() + (size_t)i * n;
+            float sum = 0;
+            for (int j = i + 1; j < n; j++)
+                sum += row[j] * x[j];
+            x[i] = (x[i] - sum) / row[i];
+        }
+    }
+
+    const double *a_;
+    int n_, lda_, nb_;
+    double normA_ = 0.0;
+    bool representable_ = true, nearlySingular_ = false;
+    int zeroPivots_ = 0;
+    std::vector<float> lu_;
+    std::vector<int> piv_;
+    std::unique_ptr<LUFactor> fallback_;
+};
+
+} // namespace lu
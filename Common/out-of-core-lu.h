@@ -0,0 +1,614 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "determinant.h"
+#include "lu-factor.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define NCS_HAVE_PREAD 1
+#endif
+
+/*
+   Out-of-Core LU Factorization (PA = LU for matrices larger than RAM)
+
+   The matrix lives in a scratch file, cut into column panels of T columns.
+   Panel j (columns [jT, jT + w), w = T except for the last one) is stored
+   as an n x w row-major block, i.e. as a column of T x w tiles that follow
+   each other in the file, so a run of tiles is one contiguous read:
+
+     file:  | panel 0: tile 0, tile 1, ... | panel 1: tile 0, tile 1, ... | ...
+
+   T is chosen from the memory budget so that three panels fit in it. The
+   factorization is left-looking, one panel at a time:
+
+     load panel j
+     for each k < j:                     (panel k streamed from disk)
+       apply the row interchanges of panel k
+       U(k, j)  = L(k, k)^-1 A(k, j)     unit lower triangular solve
+       A(k+, j) -= L(k+, k) U(k, j)      packed GEMM of lu-factor.h
+     factor rows [jT, n) of panel j with partial pivoting, write it back
+
+   so each panel is written once and read once per later panel (about
+   n / 2T passes over the file in all). The reads of the next panel and the
+   write of the finished one run on I/O threads while the current GEMM runs;
+   ioWaitSeconds() is the time the computation still had to wait.
+
+   The row interchanges are applied in elimination order (panel k's rows
+   are left as they were when k was factored), so the forward substitution
+   applies them on the way too: solveLower() computes L^-1 P B, and
+   solveUpper() then U^-1, each streaming the factors once.
+
+   A column whose largest candidate pivot is below PIVOT_EPS is left as a
+   zero pivot, as in lu::factor. For a singular U, inconsistent(y) tells
+   "no solution" from "infinite solutions" without holding U in memory:
+   the rows with a zero pivot are reduced against the others in one pass
+   over the panels, leaving a small system in the zero-pivot columns.
+
+   Panel I/O uses pread/pwrite on a scratch file that is unlinked as soon
+   as it is created, so it disappears with the process however it exits.
+   Put it on a disk, not on a RAM-backed /tmp. I/O errors throw
+   std::runtime_error.
+*/
+
+namespace ooc
+{
+
+const size_t DEFAULT_MEMORY = (size_t)256 << 20; // bytes for the panel buffers
+const int MIN_TILE = 8;                          // narrowest panel worth the I/O
+const int PANEL_BLOCK = 32;                      // inner block of the panel factorization
+
+// Scratch file of doubles read and written at byte offsets from any thread
+class ScratchFile
+{
+public:
+    explicit ScratchFile(const std::string &dir)
+    {
+#ifdef NCS_HAVE_PREAD
+        std::string path = (dir.empty() ? std::string(".") : dir) + "/lu-tiles-XXXXXX";
+        std::vector<char> name(path.begin(), path.end());
+        name.push_back('\0');
+        fd_ = mkstemp(name.data());
+        if (fd_ < 0)
+            throw std::runtime_error("cannot create a scratch file in '" + dir + "'");
+        unlink(name.data());
+#else
+        std::string path = (dir.empty() ? std::string(".") : dir) + "/lu-tiles.tmp";
+        file_ = std::fopen(path.c_str(), "w+b");
+        if (!file_)
+            throw std::runtime_error("cannot create a scratch file in '" + dir + "'");
+        path_ = path;
+#endif
+    }
+
+    ScratchFile(const ScratchFile &) = delete;
+    ScratchFile &operator=(const ScratchFile &) = delete;
+
+    ~ScratchFile()
+    {
+#ifdef NCS_HAVE_PREAD
+        close(fd_);
+#else
+        std::fclose(file_);
+        std::remove(path_.c_str());
+#endif
+    }
+
+    void read(double *dst, size_t count, uint64_t offset)
+    {
+        transfer((char *)dst, count * sizeof(double), offset, false);
+        bytesRead_ += count * sizeof(double);
+    }
+
+    void write(const double *src, size_t count, uint64_t offset)
+    {
+        transfer((char *)src, count * sizeof(double), offset, true);
+        bytesWritten_ += count * sizeof(double);
+    }
+
+    uint64_t bytesRead() const { return bytesRead_; }
+    uint64_t bytesWritten() const { return bytesWritten_; }
+
+private:
+    void transfer(char *p, size_t bytes, uint64_t offset, bool out)
+    {
+#ifdef NCS_HAVE_PREAD
+        while (bytes > 0)
+        {
+            ssize_t r = out ? pwrite(fd_, p, bytes, (off_t)offset)
+                            : pread(fd_, p, bytes, (off_t)offset);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                throw std::runtime_error(std::string("scratch file ") + (out ? "write" : "read") +
+                                         " failed: " + (r < 0 ? std::strerror(errno) : "end of file"));
+            p += r;
+            bytes -= (size_t)r;
+            offset += (uint64_t)r;
+        }
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool ok = std::fseek(file_, (long)offset, SEEK_SET) == 0 &&
+                  (out ? std::fwrite(p, 1, bytes, file_) : std::fread(p, 1, bytes, file_)) == bytes;
+        if (!ok)
+            throw std::runtime_error(std::string("scratch file ") + (out ? "write" : "read") + " failed");
+#endif
+    }
+
+#ifdef NCS_HAVE_PREAD
+    int fd_ = -1;
+#else
+    std::FILE *file_ = nullptr;
+    std::string path_;
+    std::mutex mutex_;
+#endif
+    std::atomic<uint64_t> bytesRead_{0}, bytesWritten_{0};
+};
+
+class OutOfCoreLU
+{
+public:
+    // The scratch file goes to scratchDir; memoryBytes bounds the panel buffers
+    explicit OutOfCoreLU(const std::string &scratchDir = ".", size_t memoryBytes = DEFAULT_MEMORY)
+        : file_(scratchDir), memory_(memoryBytes) {}
+
+    /*
+       Copy the n x n matrix into the tile file. row(i) returns a pointer to
+       the n values of row i; rows are requested in order, T at a time, so a
+       memory-mapped input is read once, front to back.
+    */
+    template <typename Row>
+    void load(int n, Row row)
+    {
+        n_ = n;
+        size_t perColumn = 3 * (size_t)std::max(n, 1) * sizeof(double);
+        tile_ = (int)std::min<size_t>((size_t)std::max(n, 1), memory_ / perColumn);
+        if (tile_ >= 32)
+            tile_ -= tile_ % 32;
+        if (tile_ < std::min(n, MIN_TILE))
+            throw std::runtime_error("memory budget of " + std::to_string(memory_ >> 20) +
+                                     " MB is too small for n = " + std::to_string(n) + " (needs " +
+                                     std::to_string((perColumn * MIN_TILE >> 20) + 1) + " MB)");
+        tile_ = std::max(tile_, 1);
+        for (Buffer &b : buf_)
+            b.data.resize((size_t)n * tile_);
+        piv_.assign(n, 0);
+        diag_.assign(n, 0.0);
+        zero_.assign(n, 0);
+        zeroPivots_ = 0;
+        reduced_ = false;
+
+        // T rows at a time, laid out panel by panel, written while the next rows are copied
+        for (int r0 = 0, t = 0; r0 < n; r0 += tile_, t ^= 1)
+        {
+            int r1 = std::min(n, r0 + tile_);
+            Buffer &b = buf_[t];
+            wait(b);
+            double *dst = b.data.data();
+            for (int j = 0; j < panels(); j++)
+            {
+                int c0 = j * tile_, w = width(j);
+                for (int i = r0; i < r1; i++, dst += w)
+                    std::copy(row(i) + c0, row(i) + c0 + w, dst);
+            }
+            b.pending = std::async(std::launch::async, [this, &b, r0, r1]
+            {
+                const double *src = b.data.data();
+                for (int j = 0; j < panels(); j++)
+                {
+                    size_t count = (size_t)(r1 - r0) * width(j);
+                    file_.write(src, count, offset(j, r0));
+                    src += count;
+                }
+            });
+        }
+        for (Buffer &b : buf_)
+            wait(b);
+    }
+
+    // Factor the loaded matrix; returns the number of zero pivots
+    int factorize()
+    {
+        auto start = std::chrono::steady_clock::now();
+        int n = n_, np = panels();
+        int cur = 0;
+        written_ = writing_ = -1;
+        if (np > 0)
+            startRead(cur, 0, 0, n);
+
+        for (int j = 0; j < np; j++)
+        {
+            int c0 = j * tile_, w = width(j);
+            int a = (cur + 1) % 3, b = (cur + 2) % 3; // streaming buffers
+            wait(buf_[cur]);
+            double *A = buf_[cur].data.data();
+
+            // Left-looking update with every earlier panel, the next one in flight
+            if (j > 0)
+                startRead(a, 0, 0, n);
+            for (int k = 0; k < j; k++)
+            {
+                int now = k % 2 ? b : a, other = k % 2 ? a : b;
+                wait(buf_[now]);
+                if (k + 1 < j)
+                    startRead(other, k + 1, (k + 1) * tile_, n);
+                else if (j + 1 < np)
+                    startRead(other, j + 1, 0, n);
+                forward(k, buf_[now].data.data(), A, w, w);
+            }
+            int next = j == 0 ? a : ((j - 1) % 2 ? a : b);
+            if (j == 0 && np > 1)
+                startRead(next, 1, 0, n);
+
+            // Rows [c0, n) of the panel: its diagonal block and L below it
+            zeroPivots_ += factorPanel(A + (size_t)c0 * w, n - c0, w, c0);
+
+            Buffer &done = buf_[cur];
+            written_ = j;
+            done.pending = std::async(std::launch::async, [this, &done, j, n]
+                                      { file_.write(done.data.data(), (size_t)n * width(j), offset(j, 0)); });
+            writing_ = cur;
+            cur = next;
+        }
+        for (Buffer &b : buf_)
+            wait(b);
+        seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return zeroPivots_;
+    }
+
+    int size() const { return n_; }
+    int tileSize() const { return tile_; }
+    int panels() const { return tile_ ? (n_ + tile_ - 1) / tile_ : 0; }
+    int zeroPivots() const { return zeroPivots_; }
+    bool singular() const { return zeroPivots_ > 0; }
+    const std::vector<int> &pivots() const { return piv_; }
+
+    // Diagonal of U, kept in memory
+    const std::vector<double> &diagonal() const { return diag_; }
+
+    // Product of the diagonal of U (as lu::LUFactor::detU, may over/underflow)
+    double detU() const
+    {
+        double d = 1.0;
+        for (double u : diag_)
+            d *= u;
+        return d;
+    }
+
+    // Sign and log|det A|, without overflow
+    det::LogDet logDeterminant() const
+    {
+        det::Product p;
+        for (int i = 0; i < n_; i++)
+        {
+            p.multiply(diag_[i]);
+            if (piv_[i] != i)
+                p.negate();
+        }
+        return p.result();
+    }
+
+    // B := L^-1 P B for an n x k row-major block (leading dimension ldb)
+    void solveLower(double *b, int k, int ldb)
+    {
+        int np = panels();
+        if (np > 0)
+            startRead(0, 0, 0, n_);
+        for (int p = 0; p < np; p++)
+        {
+            wait(buf_[p % 2]);
+            if (p + 1 < np)
+                startRead((p + 1) % 2, p + 1, (p + 1) * tile_, n_);
+            forward(p, buf_[p % 2].data.data(), b, k, ldb);
+        }
+        for (Buffer &buf : buf_)
+            wait(buf);
+    }
+
+    // B := U^-1 B (requires a non-singular U), panels last to first
+    void solveUpper(double *b, int k, int ldb)
+    {
+        int np = panels();
+        if (np > 0)
+            startRead(0, np - 1, 0, std::min(n_, np * tile_));
+        for (int p = np - 1, t = 0; p >= 0; p--, t ^= 1)
+        {
+            wait(buf_[t]);
+            if (p > 0)
+                startRead(t ^ 1, p - 1, 0, p * tile_);
+            const double *U = buf_[t].data.data();
+            int c0 = p * tile_, w = width(p);
+
+            // Diagonal block, bottom to top
+            for (int i = c0 + w - 1; i >= c0; i--)
+            {
+                double *row = b + (size_t)i * ldb;
+                const double *u = U + (size_t)i * w;
+                for (int q = i - c0 + 1; q < w; q++)
+                {
+                    if (u[q] == 0.0)
+                        continue;
+                    const double *src = b + (size_t)(c0 + q) * ldb;
+                    for (int c = 0; c < k; c++)
+                        row[c] -= u[q] * src[c];
+                }
+                for (int c = 0; c < k; c++)
+                    row[c] /= u[i - c0];
+            }
+
+            // Rows above: B0 -= U(0:c0, panel) * B1
+            lu::gemmMinus(c0, k, w, U, w, b + (size_t)c0 * ldb, ldb, b, ldb);
+        }
+        for (Buffer &buf : buf_)
+            wait(buf);
+    }
+
+    /*
+       Singular U: whether U x = y (y = L^-1 P b, n values) has no solution.
+       Writing each zero-pivot row r as U(r, :) = sum alpha(r, c) U(c, :) over
+       the pivot rows c plus a remainder in the zero-pivot columns turns the
+       question into a small system in those columns; alpha is found column
+       by column (a forward substitution with U^T), in one pass over the
+       panels on the first call, and reused for every further y.
+    */
+    bool inconsistent(const double *y)
+    {
+        if (!reduced_)
+            reduceZeroRows();
+        int z = (int)zeroRows_.size();
+
+        // [R | c] for the zero-pivot rows: c(r) = y(r) - sum alpha(r, c) y(c),
+        // with the size of the terms that cancelled in it
+        double yMax = 0.0;
+        for (int i = 0; i < n_; i++)
+            yMax = std::max(yMax, std::fabs(y[i]));
+        std::vector<double> m((size_t)z * (z + 1)), scale(z);
+        for (int r = 0; r < z; r++)
+        {
+            const double *alpha = &alpha_[(size_t)r * n_];
+            double c = y[zeroRows_[r]], s = yMax;
+            for (int i = 0; i < n_; i++)
+            {
+                c -= alpha[i] * y[i];
+                s += std::fabs(alpha[i] * y[i]);
+            }
+            scale[r] = s;
+            std::copy(&rest_[(size_t)r * z], &rest_[(size_t)r * z] + z, &m[(size_t)r * (z + 1)]);
+            m[(size_t)r * (z + 1) + z] = c;
+        }
+
+        // Echelon form with partial pivoting; a 0 = c row with c != 0 means no solution
+        int row = 0;
+        for (int col = 0; col < z && row < z; col++)
+        {
+            int best = row;
+            for (int i = row + 1; i < z; i++)
+                if (std::fabs(m[(size_t)i * (z + 1) + col]) > std::fabs(m[(size_t)best * (z + 1) + col]))
+                    best = i;
+            if (std::fabs(m[(size_t)best * (z + 1) + col]) < lu::PIVOT_EPS)
+                continue;
+            std::swap_ranges(&m[(size_t)row * (z + 1)], &m[(size_t)(row + 1) * (z + 1)], &m[(size_t)best * (z + 1)]);
+            std::swap(scale[row], scale[best]);
+            for (int i = row + 1; i < z; i++)
+            {
+                double f = m[(size_t)i * (z + 1) + col] / m[(size_t)row * (z + 1) + col];
+                for (int j = col; j <= z; j++)
+                    m[(size_t)i * (z + 1) + j] -= f * m[(size_t)row * (z + 1) + j];
+            }
+            row++;
+        }
+        double eps = std::numeric_limits<double>::epsilon();
+        for (int i = row; i < z; i++)
+            if (std::fabs(m[(size_t)i * (z + 1) + z]) > std::max(lu::PIVOT_EPS, n_ * eps * scale[i]))
+                return true;
+        return false;
+    }
+
+    // Time of the last factorize(), and how much of it went to waiting for the disk
+    double seconds() const { return seconds_; }
+    double ioWaitSeconds() const { return ioWait_; }
+    uint64_t bytesRead() const { return file_.bytesRead(); }
+    uint64_t bytesWritten() const { return file_.bytesWritten(); }
+
+private:
+    struct Buffer
+    {
+        std::vector<double> data;
+        std::future<void> pending; // read or write in flight
+    };
+
+    int width(int j) const { return std::min(tile_, n_ - j * tile_); }
+
+    // Byte offset of row r of panel j
+    uint64_t offset(int j, int r) const
+    {
+        return ((uint64_t)j * tile_ * n_ + (uint64_t)r * width(j)) * sizeof(double);
+    }
+
+    void wait(Buffer &b)
+    {
+        if (!b.pending.valid())
+            return;
+        auto start = std::chrono::steady_clock::now();
+        b.pending.get(); // rethrows an I/O error
+        ioWait_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Read rows [r0, r1) of panel j into buffer t (at the start of the buffer)
+    void startRead(int t, int j, int r0, int r1)
+    {
+        Buffer &b = buf_[t];
+        wait(b);
+        if (j == written_ && writing_ >= 0)
+            wait(buf_[writing_]); // its write must land first
+        b.pending = std::async(std::launch::async, [this, &b, j, r0, r1]
+                               { file_.read(b.data.data(), (size_t)(r1 - r0) * width(j), offset(j, r0)); });
+    }
+
+    /*
+       Elimination step of panel k on the n x k block X (leading dimension
+       ldx): its row interchanges, X(k) = L(k,k)^-1 X(k), then
+       X(below) -= L(below, k) X(k). L holds rows [k0, n) of panel k.
+    */
+    void forward(int p, const double *L, double *X, int k, int ldx) const
+    {
+        int k0 = p * tile_, w = width(p), k1 = k0 + w;
+        for (int i = k0; i < k1; i++)
+            if (piv_[i] != i)
+                std::swap_ranges(X + (size_t)i * ldx, X + (size_t)i * ldx + k, X + (size_t)piv_[i] * ldx);
+        for (int i = 1; i < w; i++)
+        {
+            double *row = X + (size_t)(k0 + i) * ldx;
+            const double *l = L + (size_t)i * w;
+            for (int q = 0; q < i; q++)
+            {
+                if (l[q] == 0.0)
+                    continue;
+                const double *src = X + (size_t)(k0 + q) * ldx;
+                for (int c = 0; c < k; c++)
+                    row[c] -= l[q] * src[c];
+            }
+        }
+        lu::gemmMinus(n_ - k1, k, w, L + (size_t)w * w, w, X + (size_t)k0 * ldx, ldx,
+                      X + (size_t)k1 * ldx, ldx);
+    }
+
+    /*
+       Blocked factorization of the m x w panel a (row-major, leading
+       dimension w) whose first row is global row r0; interchanges swap
+       whole panel rows. Returns the number of zero pivots.
+    */
+    int factorPanel(double *a, int m, int w, int r0)
+    {
+        int zeros = 0;
+        for (int q0 = 0; q0 < w; q0 += PANEL_BLOCK)
+        {
+            int q1 = std::min(w, q0 + PANEL_BLOCK);
+            for (int j = q0; j < q1; j++)
+            {
+                int p = j;
+                double best = std::fabs(a[(size_t)j * w + j]);
+                for (int i = j + 1; i < m; i++)
+                {
+                    double v = std::fabs(a[(size_t)i * w + j]);
+                    if (v > best)
+                    {
+                        best = v;
+                        p = i;
+                    }
+                }
+                piv_[r0 + j] = r0 + p;
+                if (p != j)
+                    std::swap_ranges(a + (size_t)j * w, a + (size_t)(j + 1) * w, a + (size_t)p * w);
+
+                const double *pivotRow = a + (size_t)j * w;
+                diag_[r0 + j] = pivotRow[j];
+                if (best < lu::PIVOT_EPS)
+                {
+                    zeros++;
+                    zero_[r0 + j] = 1;
+                    for (int i = j + 1; i < m; i++)
+                        a[(size_t)i * w + j] = 0.0;
+                    continue;
+                }
+                for (int i = j + 1; i < m; i++)
+                {
+                    double *row = a + (size_t)i * w;
+                    double f = row[j] / pivotRow[j];
+                    row[j] = f;
+                    for (int c = j + 1; c < q1; c++)
+                        row[c] -= f * pivotRow[c];
+                }
+            }
+
+            // Block row to the right, then the rest of the panel
+            int rest = w - q1;
+            if (rest == 0)
+                continue;
+            for (int i = q0 + 1; i < q1; i++)
+            {
+                double *row = a + (size_t)i * w + q1;
+                for (int p = q0; p < i; p++)
+                {
+                    double l = a[(size_t)i * w + p];
+                    if (l == 0.0)
+                        continue;
+                    const double *src = a + (size_t)p * w + q1;
+                    for (int c = 0; c < rest; c++)
+                        row[c] -= l * src[c];
+                }
+            }
+            lu::gemmMinus(m - q1, rest, q1 - q0, a + (size_t)q1 * w + q0, w,
+                          a + (size_t)q0 * w + q1, w, a + (size_t)q1 * w + q1, w);
+        }
+        return zeros;
+    }
+
+    // alpha_ and rest_ for inconsistent(): one pass over U
+    void reduceZeroRows()
+    {
+        zeroRows_.clear();
+        for (int i = 0; i < n_; i++)
+            if (zero_[i])
+                zeroRows_.push_back(i);
+        int z = (int)zeroRows_.size();
+        if ((size_t)z * n_ * sizeof(double) > memory_)
+            throw std::runtime_error("rank deficiency of " + std::to_string(z) +
+                                     " is too large to classify out of core");
+        alpha_.assign((size_t)z * n_, 0.0);
+        rest_.assign((size_t)z * z, 0.0);
+        std::vector<int> zeroIndex(n_, -1);
+        for (int r = 0; r < z; r++)
+            zeroIndex[zeroRows_[r]] = r;
+
+        int np = panels();
+        if (np > 0)
+            startRead(0, 0, 0, std::min(n_, tile_));
+        for (int p = 0; p < np; p++)
+        {
+            wait(buf_[p % 2]);
+            if (p + 1 < np)
+                startRead((p + 1) % 2, p + 1, 0, std::min(n_, (p + 2) * tile_));
+            const double *U = buf_[p % 2].data.data(); // rows [0, c0 + w) of the panel
+            int c0 = p * tile_, w = width(p);
+
+            for (int c = c0; c < c0 + w; c++)
+                for (int r = 0; r < z; r++)
+                {
+                    int zr = zeroRows_[r];
+                    if (zr > c)
+                        break; // U(zr, c) = 0 and no alpha yet
+                    double *alpha = &alpha_[(size_t)r * n_];
+                    double v = U[(size_t)zr * w + (c - c0)];
+                    for (int i = zr; i < c; i++)
+                        v -= alpha[i] * U[(size_t)i * w + (c - c0)];
+                    if (zero_[c])
+                        rest_[(size_t)r * z + zeroIndex[c]] = v;
+                    else
+                        alpha[c] = v / diag_[c];
+                }
+        }
+        for (Buffer &buf : buf_)
+            wait(buf);
+        reduced_ = true;
+    }
+
+    ScratchFile file_;
+    size_t memory_;
+    int n_ = 0, tile_ = 0;
+    Buffer buf_[3];
+    int written_ = -1, writing_ = -1; // last panel written, and from which buffer
+
+    std::vector<int> piv_;     // global row interchanges, as lu::factor
+    std::vector<double> diag_; // U(i, i)
+    std::vector<char> zero_;   // column i has a zero pivot
+    int zeroPivots_ = 0;
+
+    bool reduced_ = false;
+    std::vector<int> zeroRows_;
+    std::vector<double> alpha_, rest_; // z x n multipliers, z x z remainder
+
+    double seconds_ = 0.0, ioWait_ = 0.0;
+};
+
+} // namespace ooc
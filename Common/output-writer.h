@@ -0,0 +1,207 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   Buffered Output Writer and Output Levels
+
+   io::Writer collects text in a large buffer and hands it to the OS in big
+   fwrite() calls. Doubles are formatted with std::to_chars in fixed
+   notation, which gives the same digits as `fout << fixed << setprecision(p)`
+   at a fraction of the cost (no locale, no stream state, no virtual calls).
+
+     io::Writer out("output.txt");   // or io::Writer() to collect a string
+     out.precision(4);
+     out << "x" << i + 1 << " = " << x[i] << "\n";
+     out << io::width(10) << value;  // right-aligned, like setw(10)
+     out.close();
+     if (!out) ...                   // not opened, or a write failed
+
+   A file writer that could not open its file, or whose fwrite() or
+   fclose() failed, turns false and drops further text instead of
+   buffering it.
+
+   io::Level selects how much a program writes:
+
+     silent    nothing (timing only, on the console)
+     solution  the solution type and the solution vector
+     summary   also the input system, factors, verification
+     full      also every intermediate matrix (the step-by-step trace)
+*/
+
+namespace io
+{
+
+enum class Level
+{
+    Silent,
+    Solution,
+    Summary,
+    Full
+};
+
+inline const char *levelName(Level level)
+{
+    switch (level)
+    {
+    case Level::Silent: return "silent";
+    case Level::Solution: return "solution";
+    case Level::Summary: return "summary";
+    default: return "full";
+    }
+}
+
+// "silent", "solution", "summary" or "full"; throws on anything else
+inline Level parseLevel(const std::string &name)
+{
+    for (Level level : {Level::Silent, Level::Solution, Level::Summary, Level::Full})
+        if (name == levelName(level))
+            return level;
+    throw std::invalid_argument("unknown output level '" + name + "' (silent, solution, summary or full)");
+}
+
+// Field width for the next item, like std::setw
+struct Width
+{
+    int n;
+};
+inline Width width(int n) { return {n}; }
+
+class Writer
+{
+public:
+    static const size_t DEFAULT_BUFFER = 1 << 20;
+
+    // Collect the text in memory (see str())
+    Writer() = default;
+
+    // Write to a file (truncated); check with `if (!out)`
+    explicit Writer(const std::string &path, size_t bufferSize = DEFAULT_BUFFER)
+        : file_(std::fopen(path.c_str(), "wb")), capacity_(std::max<size_t>(bufferSize, 4096))
+    {
+        failed_ = file_ == nullptr;
+        if (!failed_)
+            buf_.reserve(capacity_);
+    }
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+    ~Writer() { close(); }
+
+    // False once opening, a write or closing the file has failed
+    explicit operator bool() const { return !failed_; }
+
+    void precision(int digits) { precision_ = std::max(digits, 0); }
+    int precision() const { return precision_; }
+
+    Writer &operator<<(Width w)
+    {
+        width_ = std::max(w.n, 0);
+        return *this;
+    }
+
+    Writer &operator<<(std::string_view s)
+    {
+        put(s.data(), s.size());
+        return *this;
+    }
+    Writer &operator<<(const char *s) { return *this << std::string_view(s); }
+    Writer &operator<<(const std::string &s) { return *this << std::string_view(s); }
+
+    Writer &operator<<(char c)
+    {
+        put(&c, 1);
+        return *this;
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    Writer &operator<<(T v)
+    {
+        char tmp[24];
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        put(tmp, (size_t)(r.ptr - tmp));
+        return *this;
+    }
+
+    Writer &operator<<(double v)
+    {
+        // Fixed notation needs up to 309 integer digits plus the fraction
+        char tmp[320 + 64];
+        int digits = std::min(precision_, 63);
+        auto r = std::to_chars(tmp, tmp + sizeof(tmp), v, std::chars_format::fixed, digits);
+        put(tmp, (size_t)(r.ptr - tmp));
+        return *this;
+    }
+
+    // Hand the buffered text to the file (no-op in memory mode)
+    void flush()
+    {
+        if (!isFile())
+            return;
+        write(buf_.data(), buf_.size());
+        buf_.clear();
+    }
+
+    void close()
+    {
+        if (file_)
+        {
+            flush();
+            if (std::fclose(file_) != 0)
+                failed_ = true;
+            file_ = nullptr;
+        }
+    }
+
+    // Text collected in memory mode
+    const std::string &str() const { return buf_; }
+
+    // Drop the collected text but keep the capacity (memory mode)
+    void clear()
+    {
+        if (!isFile())
+            buf_.clear();
+        width_ = 0;
+    }
+
+private:
+    bool isFile() const { return capacity_ != 0; }
+
+    void write(const char *s, size_t n)
+    {
+        if (failed_ || !file_ || n == 0)
+            return;
+        if (std::fwrite(s, 1, n, file_) != n)
+            failed_ = true;
+    }
+
+    void put(const char *s, size_t n)
+    {
+        if (isFile() && (failed_ || !file_))
+        {
+            width_ = 0; // nowhere to write: drop the text
+            return;
+        }
+        if (width_ > n)
+            buf_.append(width_ - n, ' ');
+        width_ = 0;
+        if (isFile() && buf_.size() + n > capacity_)
+        {
+            flush();
+            if (n >= capacity_)
+            {
+                write(s, n);
+                return;
+            }
+        }
+        buf_.append(s, n);
+    }
+
+    std::FILE *file_ = nullptr;
+    size_t capacity_ = 0; // 0: memory mode
+    bool failed_ = false;
+    std::string buf_;
+    int precision_ = 6;
+    size_t width_ = 0;
+};
+
+} // namespace io
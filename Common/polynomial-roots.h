@@ -0,0 +1,437 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "polynomial.h"
+#include "thread-pool.h"
+
+/*
+   All Roots of a Polynomial by Aberth-Ehrlich Iteration
+
+   aberth(coef) returns every root, real and complex, of the polynomial
+   c[0] x^n + ... + c[n] (highest power first, as the root finders read
+   it), grouped with their multiplicities.
+
+   All n approximations z_i move at once:
+
+     N_i = p(z_i) / p'(z_i)                 (Newton correction)
+     z_i -= N_i / (1 - N_i sum_{j != i} 1 / (z_i - z_j))
+
+   Each step is Newton's step on p(z) / prod_{j != i} (z - z_j), so the
+   approximations repel each other and converge cubically to simple roots.
+   An iteration costs O(n^2): n Horner passes plus the n sums, which are
+   taken over split real / imaginary arrays, TERMS terms per vector
+   value. A sweep updates every z_i from the previous sweep's values
+   (Jacobi), so blocks of approximations run on the pool and the result
+   does not depend on the thread count. z_i stops moving once |p(z_i)| is
+   below the rounding error bound of its Horner evaluation.
+
+   The start points lie on circles whose radii come from the upper convex
+   hull of (k, log |a_k|) (the Newton polygon, as in Bini's MPSolve), one
+   circle per hull edge with as many points as the edge is long. They are
+   within a small factor of the moduli of the roots, which is what keeps
+   degree 1000+ down to a few dozen iterations.
+
+   For |z| > 1, p and p' are taken from the reversed polynomial at 1/z,
+   which never overflows: p(z) / p'(z) = z q(w) / (n q(w) - w q'(w)),
+   w = 1/z, q(w) = w^n p(1/w).
+
+   A multiple root draws m approximations to within about eps^(1/m) of
+   it. Around each z_i the disk of radius n |N_i| holds a root of p;
+   a group of m approximations whose disks overlap is one root of
+   multiplicity m if it also passes multipleRoot() (ill-conditioned but
+   distinct roots, such as Wilkinson's, have overlapping disks too), else
+   its members are single roots. A multiple root is reported once at the
+   group's mean (the errors largely cancel). A root is real when its disk
+   reaches the real axis. Simple roots are then polished by Newton's
+   iteration, keeping a step only while it lowers |p / p'|.
+
+   Roots at 0 (trailing zero coefficients) are taken out exactly first.
+
+   Each complex root is paired with the one nearest its conjugate and both
+   are set to exact conjugates of their mean, the error bound widened by
+   the move; the roots are then sorted on exact values, real ones first.
+*/
+
+namespace roots
+{
+
+const int MAX_ITERATIONS = 1000;        // Aberth sweeps before giving up on the unconverged
+const int SWEEP_GRAIN = 32;             // approximations per parallelFor block
+const int POLISH_STEPS = 3;             // Newton steps per root afterwards
+const int TERMS = 8;                    // repulsion terms per vector value (any ISA)
+const double CLUSTER_SPREAD = 4.0;      // see multipleRoot()
+const double CLUSTER_COHERENCE = 0.25;  // see multipleRoot()
+
+// TERMS doubles: one AVX-512, two AVX or four SSE2 instructions per operation.
+// The fixed width keeps the order of the sums, and so the roots, the same on
+// every target.
+typedef double Terms __attribute__((vector_size(TERMS * sizeof(double))));
+
+struct Root
+{
+    std::complex<double> value;
+    int multiplicity = 1;
+    double radius = 0.0; // a root of p lies within this distance of value
+
+    bool real() const { return value.imag() == 0.0; }
+};
+
+struct Result
+{
+    std::vector<Root> roots; // real ones ascending, then complex by real part
+    int iterations = 0;      // Aberth sweeps made
+    bool converged = true;   // every approximation met the stopping test
+};
+
+/*
+   p(z) / p'(z) for the n-th degree c (c[0] != 0, c[n] != 0), and whether
+   |p(z)| is at the rounding level (Higham's running error bound).
+*/
+struct Correction
+{
+    std::complex<double> ratio;
+    bool small;
+};
+
+NCS_NO_CONTRACT
+inline Correction correction(const std::vector<double> &c, std::complex<double> z)
+{
+    NCS_NO_CONTRACT_BODY
+    typedef std::complex<double> C;
+    int n = (int)c.size() - 1;
+    const double eps = std::numeric_limits<double>::epsilon();
+    bool reversed = std::norm(z) > 1.0;
+    C x = reversed ? 1.0 / z : z;
+    double xr = x.real(), xi = x.imag(), ax = std::abs(x);
+
+    // Horner in real arithmetic (std::complex multiplies check for NaN and
+    // infinity on every call); |.| is bounded by |re| + |im| in the error sum
+    double pr = reversed ? c[n] : c[0], pi = 0.0, dr = 0.0, di = 0.0;
+    double mu = std::fabs(pr) / 2;
+    for (int k = 1; k <= n; k++)
+    {
+        double t = dr * xr - di * xi + pr;
+        di = dr * xi + di * xr + pi;
+        dr = t;
+        t = pr * xr - pi * xi + (reversed ? c[n - k] : c[k]);
+        pi = pr * xi + pi * xr;
+        pr = t;
+        mu = mu * ax + std::fabs(pr) + std::fabs(pi);
+    }
+    C p(pr, pi), d(dr, di);
+    bool small = std::abs(p) <= 4 * eps * (2 * mu - std::abs(p));
+    if (!reversed)
+        return {d == 0.0 ? C(HUGE_VAL, 0.0) : p / d, small};
+    C den = (double)n * p - x * d;
+    return {den == 0.0 ? C(HUGE_VAL, 0.0) : z * p / den, small};
+}
+
+// Start points on the circles of the Newton polygon of c
+NCS_NO_CONTRACT
+inline std::vector<std::complex<double>> startPoints(const std::vector<double> &c)
+{
+    NCS_NO_CONTRACT_BODY
+    int n = (int)c.size() - 1;
+    std::vector<int> hull; // powers on the upper hull of (k, log|a_k|), a_k = c[n - k]
+    auto logA = [&](int k) { return std::log(std::fabs(c[n - k])); };
+    for (int k = 0; k <= n; k++)
+    {
+        if (c[n - k] == 0.0)
+            continue;
+        while (hull.size() >= 2)
+        {
+            int i = hull[hull.size() - 2], j = hull.back();
+            // drop j if it lies on or below the segment i -> k
+            if ((logA(j) - logA(i)) * (k - i) <= (logA(k) - logA(i)) * (j - i))
+                hull.pop_back();
+            else
+                break;
+        }
+        hull.push_back(k);
+    }
+
+    std::vector<std::complex<double>> z;
+    z.reserve(n);
+    const double PI = std::acos(-1.0), SHIFT = 0.7;
+    for (size_t e = 0; e + 1 < hull.size(); e++)
+    {
+        int lo = hull[e], hi = hull[e + 1], count = hi - lo;
+        double radius = std::exp((logA(lo) - logA(hi)) / count);
+        for (int l = 0; l < count; l++)
+        {
+            double angle = 2 * PI * l / count + 2 * PI * e / n + SHIFT;
+            z.push_back(std::polar(radius, angle));
+        }
+    }
+    return z;
+}
+
+// sum_{j != i} 1 / (z_i - z_j) over split real / imaginary parts
+NCS_NO_CONTRACT
+inline std::complex<double> repulsion(const std::vector<double> &re, const std::vector<double> &im, int i)
+{
+    NCS_NO_CONTRACT_BODY
+    int n = (int)re.size();
+    double xr = re[i], xi = im[i];
+    Terms sr = {}, si = {};
+    double tr = 0.0, ti = 0.0;
+    for (int part = 0; part < 2; part++)
+    {
+        int j = part == 0 ? 0 : i + 1, to = part == 0 ? i : n;
+        for (; j + TERMS <= to; j += TERMS)
+        {
+            Terms a, b;
+            std::memcpy(&a, &re[j], sizeof(a));
+            std::memcpy(&b, &im[j], sizeof(b));
+            Terms dr = xr - a, di = xi - b;
+            Terms inv = 1.0 / (dr * dr + di * di);
+            sr += dr * inv;
+            si -= di * inv;
+        }
+        for (; j < to; j++)
+        {
+            double dr = xr - re[j], di = xi - im[j];
+            double inv = 1.0 / (dr * dr + di * di);
+            tr += dr * inv;
+            ti -= di * inv;
+        }
+    }
+    for (int l = 0; l < TERMS; l++)
+    {
+        tr += sr[l];
+        ti += si[l];
+    }
+    return {tr, ti};
+}
+
+/*
+   One Aberth-Ehrlich step of z_i = (re[i], im[i]) into (nextRe, nextIm);
+   false (z_i left where it is) once z_i has converged.
+*/
+NCS_NO_CONTRACT
+inline bool update(const std::vector<double> &c, const std::vector<double> &re, const std::vector<double> &im,
+                   int i, double &nextRe, double &nextIm)
+{
+    NCS_NO_CONTRACT_BODY
+    std::complex<double> x(re[i], im[i]);
+    Correction k = correction(c, x);
+    if (k.small || !std::isfinite(std::abs(k.ratio)))
+        return false;
+    std::complex<double> w = k.ratio / (1.0 - k.ratio * repulsion(re, im, i));
+    nextRe = x.real() - w.real();
+    nextIm = x.imag() - w.imag();
+    return std::abs(w) > std::numeric_limits<double>::epsilon() * std::abs(x);
+}
+
+/*
+   Whether the approximations z[members] (m of them) look like one m-fold
+   root rather than m distinct, ill-conditioned ones:
+   - they lie within CLUSTER_SPREAD times the spread rounding gives an
+     m-fold root at their mean c, (eps A(|c|) / |T_m(c)|)^(1/m), where A is
+     the polynomial of the |c_k| and T_m = p^(m)(c) / m!
+   - for m >= 3, their offsets o_i from c are scattered around it, not
+     lined up: |sum o_i^2| <= CLUSTER_COHERENCE sum |o_i|^2 (distinct
+     roots spread along the real axis, where every o_i^2 is positive)
+*/
+NCS_NO_CONTRACT
+inline bool multipleRoot(const std::vector<double> &c, const std::vector<std::complex<double>> &z,
+                         const std::vector<int> &members)
+{
+    NCS_NO_CONTRACT_BODY
+    typedef std::complex<double> C;
+    int n = (int)c.size() - 1, m = (int)members.size();
+    C mean = 0.0, lined = 0.0;
+    for (int i : members)
+        mean += z[i];
+    mean /= (double)m;
+    double spread = 0.0, squares = 0.0;
+    for (int i : members)
+    {
+        C o = z[i] - mean;
+        spread = std::max(spread, std::abs(o));
+        squares += std::norm(o);
+        lined += o * o;
+    }
+    if (m >= 3 && std::abs(lined) > CLUSTER_COHERENCE * squares)
+        return false;
+
+    // T_m(mean): m + 1 synthetic divisions by (x - mean), remainders T_0 .. T_m
+    std::vector<C> b(c.begin(), c.end());
+    C t = 0.0;
+    for (int k = 0; k <= m; k++)
+    {
+        for (int j = 1; j <= n - k; j++)
+            b[j] += b[j - 1] * mean;
+        t = b[n - k];
+    }
+    double a = 0.0, am = std::abs(mean);
+    for (int k = 0; k <= n; k++)
+        a = a * am + std::fabs(c[k]);
+    double expected = std::pow(std::numeric_limits<double>::epsilon() * a / std::abs(t), 1.0 / m);
+    return spread <= CLUSTER_SPREAD * expected;
+}
+
+NCS_NO_CONTRACT
+inline Result aberth(const std::vector<double> &coef, ThreadPool &pool, int maxIterations = MAX_ITERATIONS)
+{
+    NCS_NO_CONTRACT_BODY
+    typedef std::complex<double> C;
+    Result result;
+    std::vector<double> c = coef;
+    size_t first = 0;
+    while (first < c.size() && c[first] == 0.0)
+        first++;
+    c.erase(c.begin(), c.begin() + first);
+    if (c.size() < 2)
+        return result; // constant (or zero): no roots to find
+
+    int zeros = 0;
+    while (c.back() == 0.0)
+    {
+        c.pop_back();
+        zeros++;
+    }
+    double big = 0.0;
+    for (double v : c)
+        big = std::max(big, std::fabs(v));
+    for (double &v : c)
+        v /= big;
+    int n = (int)c.size() - 1;
+
+    // Aberth-Ehrlich sweeps
+    std::vector<C> z = n > 0 ? startPoints(c) : std::vector<C>();
+    std::vector<double> re(n), im(n);
+    for (int i = 0; i < n; i++)
+    {
+        re[i] = z[i].real();
+        im[i] = z[i].imag();
+    }
+    std::vector<double> nextRe(re), nextIm(im);
+    std::vector<char> done(n, 0);
+    int left = n;
+    while (left > 0 && result.iterations < maxIterations)
+    {
+        result.iterations++;
+        pool.parallelFor(0, n, SWEEP_GRAIN, [&](int lo, int hi)
+        {
+            for (int i = lo; i < hi; i++)
+            {
+                nextRe[i] = re[i];
+                nextIm[i] = im[i];
+                if (done[i])
+                    continue;
+                done[i] = !update(c, re, im, i, nextRe[i], nextIm[i]);
+            }
+        });
+        re.swap(nextRe);
+        im.swap(nextIm);
+        left = n - (int)std::count(done.begin(), done.end(), 1);
+    }
+    result.converged = left == 0;
+
+    // Clusters: components of overlapping inclusion disks, kept whole when
+    // they look like one multiple root, else split into single roots
+    std::vector<double> radius(n);
+    for (int i = 0; i < n; i++)
+    {
+        z[i] = C(re[i], im[i]);
+        radius[i] = n * std::abs(correction(c, z[i]).ratio);
+    }
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::function<int(int)> find = [&](int i) { return parent[i] == i ? i : parent[i] = find(parent[i]); };
+    for (int i = 0; i < n; i++)
+        for (int j = i + 1; j < n; j++)
+        {
+            double dr = re[i] - re[j], di = im[i] - im[j], reach = radius[i] + radius[j];
+            if (dr * dr + di * di <= reach * reach)
+                parent[find(i)] = find(j);
+        }
+    std::map<int, std::vector<int>> components;
+    for (int i = 0; i < n; i++)
+        components[find(i)].push_back(i);
+    std::vector<std::vector<int>> clusters;
+    for (auto &entry : components)
+        if (entry.second.size() > 1 && multipleRoot(c, z, entry.second))
+            clusters.push_back(entry.second);
+        else
+            for (int i : entry.second)
+                clusters.push_back({i});
+
+    for (const std::vector<int> &members : clusters)
+    {
+        Root r;
+        r.multiplicity = (int)members.size();
+        for (int i : members)
+            r.value += z[i];
+        r.value /= (double)r.multiplicity;
+        for (int i : members)
+            r.radius = std::max(r.radius, std::abs(z[i] - r.value) + radius[i]);
+
+        // Newton polishing of a simple root (a cluster's mean is already
+        // better than Newton's steps through the rounding noise around it)
+        C step = correction(c, r.value).ratio;
+        for (int k = 0; k < POLISH_STEPS && r.multiplicity == 1 && std::abs(step) > 0.0; k++)
+        {
+            C next = r.value - step;
+            C nextStep = correction(c, next).ratio;
+            if (!(std::abs(nextStep) < std::abs(step)))
+                break;
+            r.value = next;
+            step = nextStep;
+        }
+        if (std::fabs(r.value.imag()) <= r.radius)
+            r.value.imag(0.0);
+        result.roots.push_back(r);
+    }
+    if (zeros > 0)
+    {
+        Root r;
+        r.multiplicity = zeros;
+        result.roots.push_back(r);
+    }
+
+    // The coefficients are real, so non-real roots come in conjugate pairs;
+    // the two approximations of a pair differ by rounding. Pair each root
+    // above the axis with the nearest conjugate of one below and make them
+    // exact conjugates, so a pair sorts together by its exact real part.
+    std::vector<bool> paired(result.roots.size());
+    for (size_t i = 0; i < result.roots.size(); i++)
+    {
+        Root &upper = result.roots[i];
+        if (!(upper.value.imag() > 0.0))
+            continue;
+        size_t best = result.roots.size();
+        double bestDistance = HUGE_VAL;
+        for (size_t j = 0; j < result.roots.size(); j++)
+        {
+            const Root &lower = result.roots[j];
+            double distance = std::abs(lower.value - std::conj(upper.value));
+            if (lower.value.imag() < 0.0 && !paired[j] && lower.multiplicity == upper.multiplicity &&
+                distance < bestDistance)
+            {
+                best = j;
+                bestDistance = distance;
+            }
+        }
+        if (best == result.roots.size())
+            continue;
+        Root &lower = result.roots[best];
+        paired[best] = true;
+        C mean((upper.value.real() + lower.value.real()) / 2, (upper.value.imag() - lower.value.imag()) / 2);
+        upper.value = mean;
+        lower.value = std::conj(mean);
+        upper.radius = lower.radius = std::max(upper.radius, lower.radius) + bestDistance / 2;
+    }
+
+    std::sort(result.roots.begin(), result.roots.end(), [](const Root &a, const Root &b)
+    {
+        if (a.real() != b.real())
+            return a.real();
+        if (a.value.real() != b.value.real())
+            return a.value.real() < b.value.real();
+        return a.value.imag() < b.value.imag();
+    });
+    return result;
+}
+
+} // namespace roots
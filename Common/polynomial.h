@@ -0,0 +1,129 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "simd-kernels.h"
+
+/*
+   Polynomial Evaluation by Horner's Rule
+
+   Coefficients are stored highest power first, as the root finders read
+   them: c[0] x^n + c[1] x^(n-1) + ... + c[n] for a polynomial of degree n.
+
+     horner(c, x)                p(x) in n multiplies and n adds, no pow()
+     hornerWithDerivative(c, x)  p(x) and p'(x) in one pass (the derivative
+                                 is the Horner recurrence of the partial
+                                 values, 2n multiplies and 2n adds)
+     evaluate(c, xs, out, m)     out[k] = p(xs[k]) for m points, LANES
+                                 points per vector instruction
+
+   evaluate() runs the same recurrence on a vector of points, BLOCK points
+   per pass over the coefficients so that several independent Horner chains
+   hide the latency of each multiply-add. Both paths do a separate multiply
+   and add (no FMA), so evaluate() returns exactly what horner() returns for
+   every point, whatever the target.
+*/
+
+namespace poly
+{
+
+// Points per vector value: one register of doubles for the target ISA
+#if defined(__AVX512F__)
+const int LANES = 8;
+#elif defined(__AVX__)
+const int LANES = 4;
+#else
+const int LANES = 2;
+#endif
+const int CHAINS = 4;               // independent vectors per pass over the coefficients
+const int BLOCK = LANES * CHAINS;   // points per pass
+
+typedef double Lanes __attribute__((vector_size(LANES * sizeof(double))));
+
+NCS_NO_CONTRACT
+inline double horner(const double *c, int degree, double x)
+{
+    NCS_NO_CONTRACT_BODY
+    if (degree < 0)
+        return 0.0;
+    double r = c[0];
+    for (int k = 1; k <= degree; k++)
+        r = r * x + c[k];
+    return r;
+}
+
+inline double horner(const std::vector<double> &c, double x)
+{
+    return horner(c.data(), (int)c.size() - 1, x);
+}
+
+struct ValueSlope
+{
+    double value; // p(x)
+    double slope; // p'(x)
+};
+
+NCS_NO_CONTRACT
+inline ValueSlope hornerWithDerivative(const double *c, int degree, double x)
+{
+    NCS_NO_CONTRACT_BODY
+    if (degree < 0)
+        return {0.0, 0.0};
+    double p = c[0], d = 0.0;
+    for (int k = 1; k <= degree; k++)
+    {
+        d = d * x + p;
+        p = p * x + c[k];
+    }
+    return {p, d};
+}
+
+inline ValueSlope hornerWithDerivative(const std::vector<double> &c, double x)
+{
+    return hornerWithDerivative(c.data(), (int)c.size() - 1, x);
+}
+
+/*
+   out[k] = p(xs[k]) for k < count. xs and out may be the same array.
+*/
+NCS_NO_CONTRACT
+inline void evaluate(const double *c, int degree, const double *xs, double *out, size_t count)
+{
+    NCS_NO_CONTRACT_BODY
+    if (degree < 0)
+    {
+        std::fill(out, out + count, 0.0);
+        return;
+    }
+
+    size_t i = 0;
+    for (; i + BLOCK <= count; i += BLOCK)
+    {
+        Lanes x[CHAINS], r[CHAINS];
+        for (int v = 0; v < CHAINS; v++)
+        {
+            std::memcpy(&x[v], xs + i + v * LANES, sizeof(Lanes));
+            r[v] = (Lanes){} + c[0];
+        }
+        for (int k = 1; k <= degree; k++)
+            for (int v = 0; v < CHAINS; v++)
+                r[v] = r[v] * x[v] + c[k];
+        for (int v = 0; v < CHAINS; v++)
+            std::memcpy(out + i + v * LANES, &r[v], sizeof(Lanes));
+    }
+    for (; i + LANES <= count; i += LANES)
+    {
+        Lanes x, r = (Lanes){} + c[0];
+        std::memcpy(&x, xs + i, sizeof(Lanes));
+        for (int k = 1; k <= degree; k++)
+            r = r * x + c[k];
+        std::memcpy(out + i, &r, sizeof(Lanes));
+    }
+    for (; i < count; i++)
+        out[i] = horner(c, degree, xs[i]);
+}
+
+inline void evaluate(const std::vector<double> &c, const double *xs, double *out, size_t count)
+{
+    evaluate(c.data(), (int)c.size() - 1, xs, out, count);
+}
+
+} // namespace poly
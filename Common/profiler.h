@@ -0,0 +1,203 @@
+#pragma once
+#include <bits/stdc++.h>
+#if defined(NCS_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+/*
+   Per-Phase Timers and Counters (built in with -DNCS_PROFILE)
+
+     PROF_SCOPE("elimination");     time the rest of the block as a phase
+     PROF_FLOPS(2.0 * n * n);       count into the innermost open phase
+     PROF_BYTES(8.0 * n * n);       (of the calling thread)
+     PROF_SWAPS(1);
+     PROF_REPORT("lu-decomposition", "profile.json");
+
+   A phase is identified by its name: every scope with the same name adds
+   to it, from any thread. Each scope reads the time stamp counter (rdtsc
+   on x86: ticks at the constant nominal rate, a few ns to read) and the
+   steady clock on entry and exit, so a phase should be a loop or a call,
+   not one iteration of an inner loop. Flops, bytes and swaps are counted
+   by the caller from the sizes of the work (e.g. 2n^3/3 for an LU), once
+   per call, not inside the kernels.
+
+   Nested scopes are allowed: a phase's `seconds` include its nested
+   phases and `self_seconds` do not.
+
+   The report is one JSON object per run: the program, the wall time since
+   the first phase opened, and per phase the calls, seconds, ticks, flops,
+   bytes, swaps and the GFLOP/s and GB/s they imply (self time), in the
+   order the phases first ran.
+
+   Without NCS_PROFILE every macro expands to ((void)0): the arguments are
+   not evaluated and no code or data is left in the program.
+   prof::ENABLED tells which build is running.
+*/
+
+namespace prof
+{
+
+#ifdef NCS_PROFILE
+
+constexpr bool ENABLED = true;
+
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+struct Phase
+{
+    std::string name;
+    std::atomic<uint64_t> calls{0}, ticks{0}, childTicks{0}, nanos{0}, childNanos{0};
+    std::atomic<uint64_t> flops{0}, bytes{0}, swaps{0};
+
+    explicit Phase(std::string n) : name(std::move(n)) {}
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::deque<Phase> phases; // stable addresses
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+inline Registry &registry()
+{
+    static Registry r;
+    return r;
+}
+
+// The phase called `name`, created on first use
+inline Phase &phase(const char *name)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (Phase &p : r.phases)
+        if (p.name == name)
+            return p;
+    r.phases.emplace_back(name);
+    return r.phases.back();
+}
+
+// Open scopes of this thread, innermost last
+inline std::vector<Phase *> &openPhases()
+{
+    thread_local std::vector<Phase *> stack;
+    return stack;
+}
+
+// Counts made outside every scope
+inline Phase &current()
+{
+    auto &stack = openPhases();
+    if (!stack.empty())
+        return *stack.back();
+    static Phase &other = phase("other");
+    return other;
+}
+
+class Scope
+{
+public:
+    explicit Scope(Phase &p)
+        : phase_(p), t0_(prof::ticks()), c0_(std::chrono::steady_clock::now())
+    {
+        openPhases().push_back(&phase_);
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    ~Scope()
+    {
+        uint64_t dt = prof::ticks() - t0_;
+        uint64_t dn = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - c0_).count();
+        auto &stack = openPhases();
+        stack.pop_back();
+        phase_.calls.fetch_add(1, std::memory_order_relaxed);
+        phase_.ticks.fetch_add(dt, std::memory_order_relaxed);
+        phase_.nanos.fetch_add(dn, std::memory_order_relaxed);
+        if (!stack.empty())
+        {
+            stack.back()->childTicks.fetch_add(dt, std::memory_order_relaxed);
+            stack.back()->childNanos.fetch_add(dn, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    Phase &phase_;
+    uint64_t t0_;
+    std::chrono::steady_clock::time_point c0_;
+};
+
+inline void addFlops(double n) { current().flops.fetch_add((uint64_t)n, std::memory_order_relaxed); }
+inline void addBytes(double n) { current().bytes.fetch_add((uint64_t)n, std::memory_order_relaxed); }
+inline void addSwaps(double n) { current().swaps.fetch_add((uint64_t)n, std::memory_order_relaxed); }
+
+// JSON report of every phase so far; throws if the file cannot be written
+inline void writeReport(const std::string &program, const std::string &path)
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - r.start).count();
+
+    std::ostringstream out;
+    char buf[512];
+    out << "{\n  \"program\": \"" << program << "\",\n";
+    std::snprintf(buf, sizeof(buf), "  \"wall_seconds\": %.9g,\n  \"phases\": [", wall);
+    out << buf;
+    bool first = true;
+    for (Phase &p : r.phases)
+    {
+        if (p.calls == 0 && p.flops == 0 && p.bytes == 0 && p.swaps == 0)
+            continue;
+        double seconds = p.nanos * 1e-9, self = (p.nanos - p.childNanos) * 1e-9;
+        double gflops = self > 0 ? p.flops / self * 1e-9 : 0.0;
+        double gbytes = self > 0 ? p.bytes / self * 1e-9 : 0.0;
+        std::snprintf(buf, sizeof(buf),
+                      "%s\n    {\"name\": \"%s\", \"calls\": %llu, \"seconds\": %.9g, \"self_seconds\": %.9g, "
+                      "\"ticks\": %llu, \"self_ticks\": %llu, \"flops\": %llu, \"bytes\": %llu, \"swaps\": %llu, "
+                      "\"gflops_per_s\": %.6g, \"gbytes_per_s\": %.6g}",
+                      first ? "" : ",", p.name.c_str(), (unsigned long long)p.calls.load(), seconds, self,
+                      (unsigned long long)p.ticks.load(), (unsigned long long)(p.ticks - p.childTicks),
+                      (unsigned long long)p.flops.load(), (unsigned long long)p.bytes.load(),
+                      (unsigned long long)p.swaps.load(), gflops, gbytes);
+        out << buf;
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+
+    std::ofstream file(path);
+    if (!file || !(file << out.str()))
+        throw std::runtime_error("cannot write the profile to '" + path + "'");
+}
+
+#define NCS_PROF_CAT2(a, b) a##b
+#define NCS_PROF_CAT(a, b) NCS_PROF_CAT2(a, b)
+#define PROF_SCOPE(name)                                                      \
+    static prof::Phase &NCS_PROF_CAT(profPhase_, __LINE__) = prof::phase(name); \
+    prof::Scope NCS_PROF_CAT(profScope_, __LINE__)(NCS_PROF_CAT(profPhase_, __LINE__))
+#define PROF_FLOPS(n) prof::addFlops(n)
+#define PROF_BYTES(n) prof::addBytes(n)
+#define PROF_SWAPS(n) prof::addSwaps(n)
+#define PROF_REPORT(program, path) prof::writeReport(program, path)
+
+#else
+
+constexpr bool ENABLED = false;
+
+#define PROF_SCOPE(name) ((void)0)
+#define PROF_FLOPS(n) ((void)0)
+#define PROF_BYTES(n) ((void)0)
+#define PROF_SWAPS(n) ((void)0)
+#define PROF_REPORT(program, path) ((void)0)
+
+#endif
+
+} // namespace prof
@@ -0,0 +1,334 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "condition-estimate.h"
+#include "lu-factor.h"
+
+/*
+   Rank-Revealing QR (Householder, column pivoting: A P = Q R)
+
+   At step k the remaining column with the largest norm is swapped to
+   position k, and a Householder reflector H_k = I - tau v v^T zeroes it
+   below the diagonal:
+
+     p = argmax ||A(k:m, j)||, j >= k; swap columns k and p
+     v, tau from A(k:m, k);  A(k:m, k:n) = H_k A(k:m, k:n)
+
+   The column norms are downdated after every step instead of recomputed
+   (recomputed only when cancellation makes the downdate unreliable, as in
+   LAPACK's xLAQP2). Taking the largest column first makes |R(k,k)| fall
+   with k, so the numerical rank r is the number of diagonal entries above
+   rtol * |R(0,0)|: a relative test, independent of how A is scaled.
+
+   With c = Q^T b the system splits into
+
+     R11 x1 = c(0:r)          (r x r, well conditioned by construction)
+     ||b - A x|| = ||c(r:m)||  for x = P [x1; 0]
+
+   so one factorization gives the rank, the classification (unique when
+   r = n; otherwise consistent, i.e. infinite solutions, when the residual
+   is at rounding level, else no solution), the basic least-squares
+   solution, and cond(R11) from the condition estimator.
+
+   The factorization is blocked as in LAPACK's xGEQP3: within a panel of
+   nb columns only the pivot row is updated right away (it is all the norm
+   downdate needs), and the rest of the trailing matrix is updated once per
+   panel by the packed GEMM of lu-factor.h. The matrix is stored
+   column-major, so every column is contiguous for the reflectors.
+*/
+
+namespace qr
+{
+
+const int QR_BLOCK_SIZE = 32; // panel width of the blocked factorization
+
+class QRFactor
+{
+public:
+    QRFactor() = default;
+
+    // Copy the m x n matrix a (leading dimension lda) and factor it
+    QRFactor(const double *a, int m, int n, int lda) { factorize(a, m, n, lda); }
+
+    void factorize(const double *a, int m, int n, int lda, int blockSize = QR_BLOCK_SIZE)
+    {
+        m_ = m;
+        n_ = n;
+        qr_.assign((size_t)m * n, 0.0);
+        for (int i = 0; i < m; i++)
+            for (int j = 0; j < n; j++)
+                qr_[(size_t)j * m + i] = a[(size_t)i * lda + j];
+        perm_.resize(n);
+        std::iota(perm_.begin(), perm_.end(), 0);
+        int steps = std::min(m, n);
+        tau_.assign(steps, 0.0);
+
+        // vn1: current norm of the trailing part, vn2: norm when last computed
+        std::vector<double> vn1(n), vn2(n);
+        for (int j = 0; j < n; j++)
+            vn1[j] = vn2[j] = norm2(col(j), m);
+
+        std::vector<double> F;
+        for (int j0 = 0; j0 < steps;)
+            j0 += panel(j0, std::min(std::max(1, blockSize), steps - j0), vn1, vn2, F);
+    }
+
+    int rows() const { return m_; }
+    int cols() const { return n_; }
+
+    // R(i, j), i <= j < n
+    double R(int i, int j) const { return i <= j ? qr_[(size_t)j * m_ + i] : 0.0; }
+
+    // Column j of A P is column perm()[j] of A
+    const std::vector<int> &perm() const { return perm_; }
+
+    // Default relative rank tolerance: max(m, n) * machine epsilon
+    double defaultTolerance() const
+    {
+        return std::max(m_, n_) * std::numeric_limits<double>::epsilon();
+    }
+
+    // Numerical rank: diagonal entries with |R(k,k)| > rtol * |R(0,0)|
+    int rank(double rtol = -1) const
+    {
+        if (rtol < 0)
+            rtol = defaultTolerance();
+        int steps = std::min(m_, n_);
+        if (steps == 0 || R(0, 0) == 0.0)
+            return 0;
+        double limit = rtol * std::fabs(R(0, 0));
+        int r = 0;
+        while (r < steps && std::fabs(R(r, r)) > limit)
+            r++;
+        return r;
+    }
+
+    // c := Q^T c for one vector of m values
+    void applyQt(double *c) const
+    {
+        for (int k = 0; k < (int)tau_.size(); k++)
+        {
+            if (tau_[k] == 0.0)
+                continue;
+            const double *v = col(k);
+            double w = tau_[k] * (c[k] + dot(v + k + 1, c + k + 1, m_ - k - 1));
+            c[k] -= w;
+            for (int i = k + 1; i < m_; i++)
+                c[i] -= w * v[i];
+        }
+    }
+
+    /*
+       Basic least-squares solution with rank r: x = P [R11^-1 c(0:r); 0],
+       c = Q^T b. b has m values, x room for n. Returns ||b - A x||_2.
+    */
+    double solve(const double *b, double *x, int r) const
+    {
+        std::vector<double> c(b, b + m_);
+        applyQt(c.data());
+        solveR(c.data(), r);
+        std::fill(x, x + n_, 0.0);
+        for (int j = 0; j < r; j++)
+            x[perm_[j]] = c[j];
+        return norm2(c.data() + r, m_ - r);
+    }
+
+    // Estimated 1-norm condition number of R11 (r x r), cond_2 of A for r = n
+    // to within a factor n; infinite for r = 0
+    double conditionEstimate(int r) const
+    {
+        if (r == 0)
+            return std::numeric_limits<double>::infinity();
+        double normR = 0.0;
+        for (int j = 0; j < r; j++)
+        {
+            double s = 0.0;
+            for (int i = 0; i <= j; i++)
+                s += std::fabs(R(i, j));
+            normR = std::max(normR, s);
+        }
+        double inverseNorm = cond::inverseNorm1(r,
+            [&](double *x) { solveR(x, r); },
+            [&](double *x) { solveRt(x, r); });
+        return normR * inverseNorm;
+    }
+
+private:
+    double *col(int j) { return qr_.data() + (size_t)j * m_; }
+    const double *col(int j) const { return qr_.data() + (size_t)j * m_; }
+
+    /*
+       Factor up to nb columns from j0 (LAPACK's xLAQPS). The reflectors of
+       the panel are accumulated as A := A - V F^T: only the row of the
+       current diagonal is updated at once (its entries downdate the column
+       norms), and the rest of the trailing matrix gets one GEMM at the end.
+       The panel stops early when a norm must be recomputed. Returns the
+       number of columns factored.
+    */
+    int panel(int j0, int nb, std::vector<double> &vn1, std::vector<double> &vn2,
+              std::vector<double> &F)
+    {
+        int m = m_, ncols = n_ - j0;
+        F.assign((size_t)ncols * nb, 0.0); // F(c, q) = F[c * nb + q], c: column j0 + c
+        std::vector<double> aux(nb);
+        std::vector<int> recompute;
+        double tol3z = std::sqrt(std::numeric_limits<double>::epsilon());
+
+        int k = 0;
+        for (; k < nb && recompute.empty(); k++)
+        {
+            int rk = j0 + k; // diagonal row, and the column being factored
+            int p = rk;
+            for (int j = rk + 1; j < n_; j++)
+                if (vn1[j] > vn1[p])
+                    p = j;
+            if (p != rk)
+            {
+                std::swap_ranges(col(rk), col(rk) + m, col(p));
+                std::swap_ranges(&F[(size_t)k * nb], &F[(size_t)k * nb] + k, &F[(size_t)(p - j0) * nb]);
+                std::swap(perm_[rk], perm_[p]);
+                vn1[p] = vn1[rk];
+                vn2[p] = vn2[rk];
+            }
+
+            // Earlier reflectors of the panel: A(rk:m, rk) -= V(rk:m, 0:k) F(k, 0:k)^T
+            double *ck = col(rk);
+            for (int q = 0; q < k; q++)
+            {
+                double f = F[(size_t)k * nb + q];
+                const double *vq = col(j0 + q);
+                for (int i = rk; i < m; i++)
+                    ck[i] -= f * vq[i];
+            }
+
+            // Reflector for A(rk:m, rk); v(0) = 1 is implied, v(1:) stored below R(k,k)
+            double alpha = ck[rk];
+            double xnorm = norm2(ck + rk + 1, m - rk - 1);
+            double tau = 0.0;
+            if (xnorm != 0.0)
+            {
+                double beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+                tau = (beta - alpha) / beta;
+                double scale = 1.0 / (alpha - beta);
+                for (int i = rk + 1; i < m; i++)
+                    ck[i] *= scale;
+                ck[rk] = beta;
+            }
+            tau_[rk] = tau;
+            double akk = ck[rk];
+            ck[rk] = 1.0;
+
+            // F(c, k) = tau * A(rk:m, c)^T v - tau * F(c, 0:k) V(rk:m, 0:k)^T v, c > k
+            for (int q = 0; q < k; q++)
+            {
+                aux[q] = -tau * dot(col(j0 + q) + rk, ck + rk, m - rk);
+            }
+            for (int c = k + 1; c < ncols; c++)
+            {
+                double *fc = &F[(size_t)c * nb];
+                double f = tau * dot(col(j0 + c) + rk, ck + rk, m - rk);
+                for (int q = 0; q < k; q++)
+                    f += fc[q] * aux[q];
+                fc[k] = f;
+            }
+
+            // Current row: A(rk, c) -= A(rk, 0:k+1) F(c, 0:k+1)^T, c > k
+            for (int q = 0; q <= k; q++)
+                aux[q] = col(j0 + q)[rk];
+            for (int c = k + 1; c < ncols; c++)
+            {
+                col(j0 + c)[rk] -= dot(aux.data(), &F[(size_t)c * nb], k + 1);
+            }
+            ck[rk] = akk;
+
+            // Downdate the norms of the remaining columns
+            if (rk < std::min(m, n_) - 1)
+                for (int j = rk + 1; j < n_; j++)
+                {
+                    if (vn1[j] == 0.0)
+                        continue;
+                    double t = std::fabs(col(j)[rk]) / vn1[j];
+                    t = std::max(0.0, (1.0 + t) * (1.0 - t));
+                    double ratio = vn1[j] / vn2[j];
+                    if (t * ratio * ratio <= tol3z)
+                        recompute.push_back(j);
+                    else
+                        vn1[j] *= std::sqrt(t);
+                }
+        }
+
+        // Rest of the trailing matrix: A(r:m, c) -= V(r:m, 0:k) F(c, 0:k)^T, c >= k.
+        // Column-major A is row-major A^T, so this is A^T -= F V^T for gemmMinus
+        int r = j0 + k;
+        lu::gemmMinus(ncols - k, m - r, k, F.data() + (size_t)k * nb, nb,
+                      col(j0) + r, m, col(j0 + k) + r, m);
+
+        for (int j : recompute)
+            vn1[j] = vn2[j] = norm2(col(j) + r, m - r);
+        return k;
+    }
+
+    // x . y with independent partial sums (one running sum is latency bound)
+    static double dot(const double *x, const double *y, int len)
+    {
+        double part[8] = {};
+        int i = 0;
+        for (; i + 8 <= len; i += 8)
+            for (int l = 0; l < 8; l++)
+                part[l] += x[i + l] * y[i + l];
+        double sum = 0.0;
+        for (int l = 0; l < 8; l++)
+            sum += part[l];
+        for (; i < len; i++)
+            sum += x[i] * y[i];
+        return sum;
+    }
+
+    // ||v||_2 without overflow for huge entries
+    static double norm2(const double *v, int len)
+    {
+        double scale = 0.0;
+        for (int i = 0; i < len; i++)
+            scale = std::max(scale, std::fabs(v[i]));
+        if (scale == 0.0 || !std::isfinite(scale))
+            return scale;
+        double s = 0.0;
+        for (int i = 0; i < len; i++)
+        {
+            double t = v[i] / scale;
+            s += t * t;
+        }
+        return scale * std::sqrt(s);
+    }
+
+    // x := R11^-1 x (first r values), column-oriented back substitution
+    void solveR(double *x, int r) const
+    {
+        for (int j = r - 1; j >= 0; j--)
+        {
+            const double *cj = col(j);
+            x[j] /= cj[j];
+            for (int i = 0; i < j; i++)
+                x[i] -= cj[i] * x[j];
+        }
+    }
+
+    // x := R11^-T x (first r values)
+    void solveRt(double *x, int r) const
+    {
+        for (int j = 0; j < r; j++)
+        {
+            const double *cj = col(j);
+            double s = x[j];
+            for (int i = 0; i < j; i++)
+                s -= cj[i] * x[i];
+            x[j] = s / cj[j];
+        }
+    }
+
+    int m_ = 0, n_ = 0;
+    std::vector<double> qr_; // column-major: R on and above the diagonal, reflectors below
+    std::vector<double> tau_;
+    std::vector<int> perm_;
+};
+
+} // namespace qr
@@ -0,0 +1,456 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "polynomial.h"
+#include "thread-pool.h"
+
+/*
+   Sign-Change Scan for Root Brackets
+
+   scan(coef, lo, hi, step, tolerance, pool) walks the grid
+   x_k = lo + k * step (k = 0, 1, ... while x_k <= hi) the way the root
+   finders always have:
+
+     |p(x_k)| < tolerance        -> x_k is a root on the grid
+     else p(x_k) p(x_k+1) < 0    -> [x_k, x_k + step] brackets a root
+
+   but each point is evaluated once, and a run of consecutive grid points
+   with |p| < tolerance (p flat near a multiple or clustered root) gives one
+   root, the point of the run with the smallest |p|. x_k is computed from k, not by adding
+   step repeatedly, so the grid does not drift. The grid is cut into blocks
+   of SCAN_BLOCK points that run on the pool; a block evaluates its points
+   (plus the first point of the next block) with poly::evaluate into a
+   per-thread buffer, then tests LANES neighbouring pairs per vector compare
+   and looks at single points only where a lane fired. The blocks' findings
+   are joined in grid order, merging runs across block boundaries, so the
+   result does not depend on the thread count.
+
+   isolate(coef, range, tolerance, pool) needs no step. The search starts
+   from an interval certified to hold every real root:
+
+     Cauchy      |z| < 1 + max |c_k / c_0|
+     Fujiwara    |z| <= 2 max( |c_k / c_0|^(1/k), |c_n / (2 c_0)|^(1/n) )
+     Descartes   no sign change in c (in the c of p(-x)) -> no root > 0 (< 0)
+
+   and a Sturm chain p, p', -rem(p, p'), ... gives the number of distinct
+   real roots in (a, b] as V(a) - V(b), V(x) being the sign changes along
+   the chain at x. An interval is halved only while it holds more than one
+   root or its one root does not change the sign of p at its ends; one
+   with no root is dropped at once. Roots of p at x = 0 are taken out
+   exactly first (trailing zero coefficients), so 0 is never a root of the
+   rest (a bracket is still not allowed to end at 0). An interval narrower
+   than `tolerance` is a leaf: a bracket if p changes sign over it, else
+   (a root of even multiplicity) its midpoint is a root.
+
+   The chain is built in double precision, so its counts are checked: a
+   count below zero, above Descartes' bound, or of zero across a sign
+   change of p means the chain cannot be trusted there, and that interval
+   alone is scanned with FALLBACK_POINTS points (realRoots is then -1).
+   The chain is not asked more than it must: an interval with one root
+   and a sign change of p that is still wider than `width` is halved by
+   the sign of p at its midpoint alone.
+*/
+
+namespace bracket
+{
+
+const int SCAN_BLOCK = 1 << 13;           // grid points per parallelFor block
+const long long FALLBACK_POINTS = 1 << 20; // grid of isolate() when the Sturm counts fail
+const double STURM_ZERO = 1e-10;         // remainder terms this small (relative) are zero
+
+struct Interval
+{
+    double lo, hi;
+};
+
+struct Scan
+{
+    std::vector<double> gridRoots;  // roots found directly, ascending
+    std::vector<Interval> intervals; // [lo, hi] over which p changes sign, ascending
+    long long evaluations = 0;       // polynomial evaluations made
+    double lo = 0.0, hi = 0.0;       // range searched
+    int realRoots = -1;              // distinct real roots in it (isolate(), Sturm counts), -1 if not counted
+};
+
+inline Scan scan(const std::vector<double> &coef, double lo, double hi, double step,
+                 double tolerance, ThreadPool &pool)
+{
+    if (!(step > 0.0) || !(hi >= lo))
+        throw std::invalid_argument("the scan needs step > 0 and a non-empty range");
+    long long points = (long long)std::floor((hi - lo) / step * (1 + 1e-12)) + 1; // x_0 .. x_K
+    long long blockCount = (points + SCAN_BLOCK - 1) / SCAN_BLOCK;
+    if (blockCount > INT_MAX)
+        throw std::invalid_argument("the scan grid is too fine for this range");
+
+    struct Hit
+    {
+        long long k;    // grid index
+        double x, size; // x_k and |p(x_k)|
+    };
+
+    int blocks = (int)blockCount;
+    std::vector<std::vector<Hit>> roots(blocks);
+    std::vector<std::vector<Interval>> intervals(blocks);
+    std::vector<std::vector<double>> xs(pool.size()), values(pool.size()); // per-thread scratch
+    const double *c = coef.data();
+    int degree = (int)coef.size() - 1;
+
+    pool.parallelFor(0, blocks, 1, [&](int first, int last)
+    {
+        std::vector<double> &x = xs[ThreadPool::participant()];
+        std::vector<double> &v = values[ThreadPool::participant()];
+        for (int b = first; b < last; b++)
+        {
+            long long k0 = (long long)b * SCAN_BLOCK;
+            int m = (int)std::min<long long>(SCAN_BLOCK, points - k0); // left ends in this block
+            x.resize(m + 1);
+            v.resize(m + 1);
+            for (int j = 0; j <= m; j++)
+                x[j] = lo + (double)(k0 + j) * step;
+            poly::evaluate(c, degree, x.data(), v.data(), m + 1);
+
+            auto test = [&](int j)
+            {
+                if (std::fabs(v[j]) < tolerance)
+                    roots[b].push_back({k0 + j, x[j], std::fabs(v[j])});
+                else if (v[j] * v[j + 1] < 0.0)
+                    intervals[b].push_back({x[j], x[j] + step});
+            };
+
+            int j = 0;
+            for (; j + poly::LANES <= m; j += poly::LANES)
+            {
+                poly::Lanes a, next;
+                std::memcpy(&a, &v[j], sizeof(a));
+                std::memcpy(&next, &v[j + 1], sizeof(next));
+                auto hit = ((a < tolerance) & (a > -tolerance)) | (a * next < 0.0);
+                bool any = false;
+                for (int l = 0; l < poly::LANES; l++)
+                    any |= hit[l] != 0;
+                if (!any)
+                    continue;
+                for (int l = 0; l < poly::LANES; l++)
+                    if (hit[l])
+                        test(j + l);
+            }
+            for (; j < m; j++)
+                test(j);
+        }
+    });
+
+    Scan result;
+    Hit run{-2, 0.0, 0.0}; // the current run of consecutive hits: last index, best point
+    for (int b = 0; b < blocks; b++)
+    {
+        for (const Hit &h : roots[b])
+        {
+            if (h.k == run.k + 1)
+            {
+                if (h.size < run.size)
+                {
+                    result.gridRoots.back() = h.x;
+                    run.size = h.size;
+                }
+                run.k = h.k;
+                continue;
+            }
+            result.gridRoots.push_back(h.x);
+            run = h;
+        }
+        result.intervals.insert(result.intervals.end(), intervals[b].begin(), intervals[b].end());
+    }
+    result.evaluations = points + blocks; // one shared point per block boundary, plus x_K+1
+    result.lo = lo;
+    result.hi = hi;
+    return result;
+}
+
+// c without its leading zero coefficients (c[0] != 0 unless c is zero)
+inline std::vector<double> trimLeading(std::vector<double> c)
+{
+    size_t k = 0;
+    while (k + 1 < c.size() && c[k] == 0.0)
+        k++;
+    c.erase(c.begin(), c.begin() + k);
+    return c;
+}
+
+// Sign changes along c, zeros skipped
+inline int signVariations(const std::vector<double> &c)
+{
+    int count = 0;
+    double last = 0.0;
+    for (double v : c)
+        if (v != 0.0)
+        {
+            if (last != 0.0 && (v < 0.0) != (last < 0.0))
+                count++;
+            last = v;
+        }
+    return count;
+}
+
+// Every (also complex) root z of c, c[0] != 0, has |z| <= rootBound(c)
+inline double rootBound(const std::vector<double> &c)
+{
+    int n = (int)c.size() - 1;
+    double cauchy = 0.0, fujiwara = 0.0;
+    for (int k = 1; k <= n; k++)
+    {
+        double r = std::fabs(c[k] / c[0]);
+        cauchy = std::max(cauchy, r);
+        fujiwara = std::max(fujiwara, std::pow(k == n ? r / 2 : r, 1.0 / k));
+    }
+    return std::min(1.0 + cauchy, 2.0 * fujiwara);
+}
+
+/*
+   Sturm chain of a polynomial without a root at 0. Every member is scaled
+   to a largest coefficient of 1 (a positive factor does not change the
+   signs), and leading remainder terms below STURM_ZERO times the size of
+   the terms they came from are taken as cancelled, which also ends the
+   chain at the gcd of p and p' when p has multiple roots.
+*/
+class SturmChain
+{
+public:
+    explicit SturmChain(const std::vector<double> &c)
+    {
+        int n = (int)c.size() - 1;
+        chain_.push_back(scaled(c));
+        if (n < 1)
+            return;
+        std::vector<double> d(n);
+        for (int k = 0; k < n; k++)
+            d[k] = c[k] * (n - k);
+        chain_.push_back(scaled(d));
+        while (chain_.back().size() > 1)
+        {
+            std::vector<double> r = remainder(chain_[chain_.size() - 2], chain_.back());
+            if (r.empty())
+                break;
+            for (double &v : r)
+                v = -v;
+            chain_.push_back(scaled(r));
+        }
+    }
+
+    // Sign changes along the chain at x
+    int variations(double x) const
+    {
+        int count = 0;
+        double last = 0.0;
+        for (const std::vector<double> &p : chain_)
+        {
+            double v = poly::horner(p, x);
+            if (v != 0.0)
+            {
+                if (last != 0.0 && (v < 0.0) != (last < 0.0))
+                    count++;
+                last = v;
+            }
+        }
+        return count;
+    }
+
+    int size() const { return (int)chain_.size(); }
+
+private:
+    static std::vector<double> scaled(std::vector<double> p)
+    {
+        double big = 0.0;
+        for (double v : p)
+            big = std::max(big, std::fabs(v));
+        if (big > 0.0)
+            for (double &v : p)
+                v /= big;
+        return p;
+    }
+
+    // a mod b, without the cancelled leading terms; empty when a is a multiple of b
+    static std::vector<double> remainder(std::vector<double> a, const std::vector<double> &b)
+    {
+        int m = (int)a.size() - 1, n = (int)b.size() - 1;
+        std::vector<double> size(a.size());
+        for (int i = 0; i <= m; i++)
+            size[i] = std::fabs(a[i]);
+        for (int i = 0; i + n <= m; i++)
+        {
+            double q = a[i] / b[0];
+            for (int j = 0; j <= n; j++)
+            {
+                a[i + j] -= q * b[j];
+                size[i + j] = std::max(size[i + j], std::fabs(q * b[j]));
+            }
+        }
+        int k = m - n + 1;
+        while (k <= m && std::fabs(a[k]) <= STURM_ZERO * size[k])
+            k++;
+        return std::vector<double>(a.begin() + k, a.end());
+    }
+
+    std::vector<std::vector<double>> chain_;
+};
+
+/*
+   Isolate the real roots of coef in [-range, range] intersected with the
+   root bound (range = HUGE_VAL: the root bound alone); see the top of the
+   file. Brackets wider than `width` are halved further (open methods such
+   as Newton's want to start close to their root). The pool is only used
+   by the fallback scans.
+*/
+inline Scan isolate(const std::vector<double> &coef, double range, double tolerance, ThreadPool &pool,
+                    double width = HUGE_VAL)
+{
+    if (!(range >= 0.0) || !(tolerance > 0.0) || !(width > 0.0))
+        throw std::invalid_argument("isolation needs range >= 0, tolerance > 0 and width > 0");
+    std::vector<double> c = trimLeading(coef);
+    Scan result;
+    if (c.size() < 2 || c[0] == 0.0)
+        return result; // constant: no roots to isolate
+
+    bool zeroRoot = false;
+    while (c.size() > 1 && c.back() == 0.0)
+    {
+        c.pop_back();
+        zeroRoot = true;
+    }
+
+    // Certified search interval: the root bound, cut to the sides Descartes allows
+    std::vector<double> mirrored = c; // p(-x)
+    for (size_t k = 0; k < c.size(); k++)
+        if ((c.size() - 1 - k) % 2 == 1)
+            mirrored[k] = -mirrored[k];
+    int positive = signVariations(c), negative = signVariations(mirrored);
+    double bound = c.size() > 1 ? rootBound(c) * (1 + 1e-6) : 0.0;
+    double lo = negative > 0 ? -std::min(bound, range) : 0.0;
+    double hi = positive > 0 ? std::min(bound, range) : 0.0;
+    result.lo = zeroRoot ? std::min(lo, 0.0) : lo;
+    result.hi = zeroRoot ? std::max(hi, 0.0) : hi;
+
+    auto withZero = [&](Scan &r)
+    {
+        if (zeroRoot)
+        {
+            r.gridRoots.insert(std::lower_bound(r.gridRoots.begin(), r.gridRoots.end(), 0.0), 0.0);
+            if (r.realRoots >= 0)
+                r.realRoots++;
+        }
+    };
+
+    if (c.size() < 2 || lo == hi)
+    {
+        result.realRoots = 0;
+        withZero(result);
+        return result;
+    }
+
+    SturmChain chain(c);
+    struct Piece
+    {
+        double a, b, pa, pb;
+        int va, vb;
+    };
+    auto at = [&](double x, double &px, int &vx)
+    {
+        px = poly::horner(c, x);
+        vx = chain.variations(x);
+        result.evaluations += chain.size();
+    };
+
+    Piece whole{lo, hi, 0.0, 0.0, 0, 0};
+    at(lo, whole.pa, whole.va);
+    at(hi, whole.pb, whole.vb);
+    int total = whole.va - whole.vb;
+    bool trusted = total >= 0 && total <= (lo < 0.0 ? negative : 0) + (hi > 0.0 ? positive : 0);
+
+    // A piece whose counts are inconsistent is scanned on its own, appended in order
+    auto fallback = [&](double a, double b)
+    {
+        Scan piece = scan(c, a, b, (b - a) / (FALLBACK_POINTS - 1), tolerance, pool);
+        result.evaluations += piece.evaluations;
+        for (double x : piece.gridRoots)
+            if (result.gridRoots.empty() || x != result.gridRoots.back()) // a shared end
+                result.gridRoots.push_back(x);
+        result.intervals.insert(result.intervals.end(), piece.intervals.begin(), piece.intervals.end());
+        trusted = false;
+    };
+
+    if (!trusted)
+    {
+        fallback(lo, hi);
+        withZero(result);
+        return result;
+    }
+
+    std::vector<Piece> stack;
+    if (total > 0)
+        stack.push_back(whole);
+    while (!stack.empty())
+    {
+        Piece s = stack.back();
+        stack.pop_back();
+        int count = s.va - s.vb;
+        bool signChange = s.pa * s.pb < 0.0;
+        if (count < 0 || (count == 0 && signChange))
+        {
+            fallback(s.a, s.b);
+            continue;
+        }
+        if (count == 0)
+            continue;
+        double m = s.a + (s.b - s.a) / 2;
+        bool open = !(zeroRoot && (s.a == 0.0 || s.b == 0.0)); // coef itself vanishes at 0
+        if (count == 1 && signChange && open)
+        {
+            // one simple crossing: narrow it to `width` by the sign of p alone
+            bool exact = false;
+            while (s.b - s.a > width && m > s.a && m < s.b)
+            {
+                double pm = poly::horner(c, m);
+                result.evaluations++;
+                if (pm == 0.0)
+                {
+                    exact = true;
+                    break;
+                }
+                if ((pm < 0.0) == (s.pa < 0.0))
+                {
+                    s.a = m;
+                    s.pa = pm;
+                }
+                else
+                {
+                    s.b = m;
+                    s.pb = pm;
+                }
+                m = s.a + (s.b - s.a) / 2;
+            }
+            if (exact)
+                result.gridRoots.push_back(m);
+            else
+                result.intervals.push_back({s.a, s.b});
+            continue;
+        }
+        if (s.b - s.a < tolerance || m <= s.a || m >= s.b)
+        {
+            if (signChange && open)
+                result.intervals.push_back({s.a, s.b});
+            else
+                result.gridRoots.push_back(m);
+            continue;
+        }
+        Piece left{s.a, m, s.pa, 0.0, s.va, 0}, right{m, s.b, 0.0, s.pb, 0, s.vb};
+        at(m, left.pb, left.vb);
+        right.pa = left.pb;
+        right.va = left.vb;
+        stack.push_back(right); // left first: results come out in ascending order
+        stack.push_back(left);
+    }
+
+    if (trusted)
+        result.realRoots = total;
+    withZero(result);
+    return result;
+}
+
+} // namespace bracket
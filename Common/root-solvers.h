@@ -0,0 +1,283 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   Bracketed Root Solvers: Brent's Method and Modified False Position
+
+   Each solver takes a function f and a bracket [a, b] with f(a) f(b) <= 0
+   and returns a root to within `tolerance`, never leaving the bracket:
+
+     brent            Brent's method (zeroin): inverse quadratic
+                      interpolation or a secant step when it lands well
+                      inside the bracket and shrinks it fast enough, else
+                      a bisection step
+     illinois         false position, but the function value kept at an
+                      end that is retained twice in a row is halved
+     andersonBjorck   as illinois, scaled by 1 - f(x) / f(b) instead of
+                      1/2 (by 1/2 when that is not positive)
+
+   Plain false position keeps one end for ever when f is convex or
+   concave over the bracket, and converges linearly; scaling the kept
+   value moves the next point across the root, so both ends move and the
+   order is about 1.44 (Illinois), 1.7 (Anderson-Bjorck) and up to 1.84
+   (Brent). Near a multiple root, or where f is very flat, interpolation
+   can still crawl; so whenever HALVING_STEPS steps have not halved the
+   bracket, the next point is its midpoint. No solver then needs more
+   than HALVING_STEPS + 1 times the evaluations of bisection.
+
+   All three use Brent's stopping test: with the current estimate b and
+   the other end c of the bracket,
+
+     |c - b| / 2 <= 2 eps |b| + tolerance / 2      or  f(b) == 0
+
+   and never step less than 2 eps |b| + tolerance / 2 from an end, so a
+   converging side cannot stall the bracket. The returned root is within
+   tolerance + 4 eps |root| of a sign change of f. For a simple root in
+   a bracket of width 1 that is about 8 to 20 evaluations to 1e-12, where
+   bisection needs 40.
+
+   With a trace, every evaluation is recorded with the bracket it started
+   from, for the iteration tables.
+*/
+
+namespace solver
+{
+
+const int MAX_ITERATIONS = 1000; // evaluations before giving up
+const int HALVING_STEPS = 2;     // steps allowed to halve the bracket before a bisection
+
+enum class Method
+{
+    Brent,
+    Illinois,
+    AndersonBjorck
+};
+
+// "brent", "illinois" or "anderson-bjorck"; false for anything else
+inline bool parseMethod(const std::string &name, Method &method)
+{
+    if (name == "brent")
+        method = Method::Brent;
+    else if (name == "illinois")
+        method = Method::Illinois;
+    else if (name == "anderson-bjorck")
+        method = Method::AndersonBjorck;
+    else
+        return false;
+    return true;
+}
+
+inline const char *methodName(Method method)
+{
+    switch (method)
+    {
+    case Method::Brent:
+        return "Brent's method";
+    case Method::Illinois:
+        return "Illinois (modified false position)";
+    default:
+        return "Anderson-Bjorck (modified false position)";
+    }
+}
+
+struct Step
+{
+    int iteration;
+    double lo, hi; // bracket before the step
+    double x, fx;  // point evaluated
+};
+
+struct Result
+{
+    double root = 0.0, value = 0.0; // estimate and f there
+    double lo = 0.0, hi = 0.0;      // final bracket
+    int evaluations = 0;            // including f(a) and f(b)
+    bool converged = false;         // stopping test met within maxIterations
+};
+
+// Smallest step allowed at x (Brent's tol1)
+inline double minimumStep(double x, double tolerance)
+{
+    return 2.0 * std::numeric_limits<double>::epsilon() * std::fabs(x) + 0.5 * tolerance;
+}
+
+/*
+   Whether the next step must be a bisection: the bracket, now `width`
+   wide, has not halved in HALVING_STEPS steps since it was `checkpoint`
+   wide. Called once per step.
+*/
+inline bool mustBisect(double width, double &checkpoint, int &stalled)
+{
+    if (width <= 0.5 * checkpoint)
+    {
+        checkpoint = width;
+        stalled = 0;
+    }
+    if (stalled == HALVING_STEPS)
+    {
+        checkpoint = width; // the bisection halves it
+        stalled = 0;
+        return true;
+    }
+    stalled++;
+    return false;
+}
+
+template <class F>
+Result brent(F &&fn, double a, double b, double tolerance, std::vector<Step> *trace = nullptr,
+             int maxIterations = MAX_ITERATIONS)
+{
+    Result r;
+    double fa = fn(a), fb = fn(b);
+    r.evaluations = 2;
+    double c = a, fc = fa, d = b - a, e = d;
+    double checkpoint = std::fabs(b - a); // width when the bracket last halved
+    int stalled = 0;                      // steps made since
+    while (true)
+    {
+        if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0))
+        {
+            // the root is between a and b: c becomes the other end again
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (std::fabs(fc) < std::fabs(fb))
+        {
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double tol1 = minimumStep(b, tolerance), half = 0.5 * (c - b);
+        r.root = b;
+        r.value = fb;
+        r.lo = std::min(b, c);
+        r.hi = std::max(b, c);
+        if (std::fabs(half) <= tol1 || fb == 0.0)
+        {
+            r.converged = true;
+            return r;
+        }
+        if (r.evaluations >= maxIterations)
+            return r;
+
+        bool bisect = mustBisect(2.0 * std::fabs(half), checkpoint, stalled);
+        if (!bisect && std::fabs(e) >= tol1 && std::fabs(fa) > std::fabs(fb))
+        {
+            // secant (two points) or inverse quadratic interpolation (three)
+            double s = fb / fa, p, q;
+            if (a == c)
+            {
+                p = 2.0 * half * s;
+                q = 1.0 - s;
+            }
+            else
+            {
+                double qa = fa / fc, rb = fb / fc;
+                p = s * (2.0 * half * qa * (qa - rb) - (b - a) * (rb - 1.0));
+                q = (qa - 1.0) * (rb - 1.0) * (s - 1.0);
+            }
+            if (p > 0)
+                q = -q;
+            p = std::fabs(p);
+            // accept it if it stays inside and shrinks faster than bisection
+            if (2.0 * p < std::min(3.0 * half * q - std::fabs(tol1 * q), std::fabs(e * q)))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = half;
+                e = d;
+            }
+        }
+        else
+        {
+            d = half;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::fabs(d) > tol1 ? d : std::copysign(tol1, half);
+        fb = fn(b);
+        r.evaluations++;
+        if (trace)
+            trace->push_back({r.evaluations - 2, r.lo, r.hi, b, fb});
+    }
+}
+
+template <class F>
+Result illinois(F &&fn, double a, double b, double tolerance, bool andersonBjorck = false,
+                std::vector<Step> *trace = nullptr, int maxIterations = MAX_ITERATIONS)
+{
+    Result r;
+    double fa = fn(a), fb = fn(b); // b: newest point, a: the other end
+    r.evaluations = 2;
+    if (std::fabs(fa) < std::fabs(fb))
+    {
+        std::swap(a, b);
+        std::swap(fa, fb);
+    }
+    double checkpoint = std::fabs(b - a); // width when the bracket last halved
+    int stalled = 0;                      // steps made since
+    while (true)
+    {
+        double tol1 = minimumStep(b, tolerance);
+        r.root = b;
+        r.value = fb;
+        r.lo = std::min(a, b);
+        r.hi = std::max(a, b);
+        if (0.5 * (r.hi - r.lo) <= tol1 || fb == 0.0)
+        {
+            r.converged = true;
+            return r;
+        }
+        if (r.evaluations >= maxIterations)
+            return r;
+
+        // false position point, kept at least tol1 inside the bracket
+        double x = b - fb * (b - a) / (fb - fa);
+        if (mustBisect(r.hi - r.lo, checkpoint, stalled))
+            x = 0.5 * (r.lo + r.hi);
+        if (!(x > r.lo + tol1))
+            x = r.lo + tol1;
+        if (!(x < r.hi - tol1))
+            x = r.hi - tol1;
+        double fx = fn(x);
+        r.evaluations++;
+        if (trace)
+            trace->push_back({r.evaluations - 2, r.lo, r.hi, x, fx});
+
+        if ((fx > 0) != (fb > 0))
+        {
+            // crossed the root: b becomes the other end
+            a = b;
+            fa = fb;
+        }
+        else
+        {
+            // a retained again: scale its value down
+            double m = andersonBjorck ? 1.0 - fx / fb : 0.5;
+            fa *= m > 0 ? m : 0.5;
+        }
+        b = x;
+        fb = fx;
+    }
+}
+
+template <class F>
+Result solve(Method method, F &&fn, double a, double b, double tolerance, std::vector<Step> *trace = nullptr,
+             int maxIterations = MAX_ITERATIONS)
+{
+    if (method == Method::Brent)
+        return brent(fn, a, b, tolerance, trace, maxIterations);
+    return illinois(fn, a, b, tolerance, method == Method::AndersonBjorck, trace, maxIterations);
+}
+
+} // namespace solver
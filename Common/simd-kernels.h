@@ -0,0 +1,356 @@
+#pragma once
+#include <bits/stdc++.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NCS_SIMD_X86 1
+#endif
+
+// Keep y + alpha * x as a separate multiply and add even where the compiler
+// would otherwise fuse it into an FMA (GCC fuses by default for AVX-512)
+#if defined(__clang__)
+#define NCS_NO_CONTRACT
+#define NCS_NO_CONTRACT_BODY _Pragma("clang fp contract(off)")
+#elif defined(__GNUC__)
+#define NCS_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#define NCS_NO_CONTRACT_BODY
+#else
+#define NCS_NO_CONTRACT
+#define NCS_NO_CONTRACT_BODY
+#endif
+
+/*
+   SIMD Row Kernels with Runtime CPU Dispatch
+
+   The inner loops shared by every elimination solver:
+
+     rowAxpy(y, x, alpha, n)     y[j] += alpha * x[j]
+     rowScale(x, alpha, n)       x[j] *= alpha
+     argmaxAbs(x, n, stride)     first index k with the largest |x[k * stride]|
+
+   Each kernel has a scalar, SSE2, AVX2 and AVX-512 variant. The widest one
+   the CPU supports is picked on first use (x86 with GCC/Clang); every other
+   platform compiles the scalar fallback only. The variants do the same
+   multiply and add per element (no FMA), so results are bit-identical
+   whichever one runs.
+*/
+
+namespace simd
+{
+
+enum class Isa
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+inline const char *isaName(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::SSE2: return "SSE2";
+    case Isa::AVX2: return "AVX2";
+    case Isa::AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+inline Isa detectIsa()
+{
+#ifdef NCS_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+/* ---------------- Scalar (compiles anywhere) ---------------- */
+
+NCS_NO_CONTRACT
+inline void rowAxpyScalar(double *y, const double *x, double alpha, int n)
+{
+    NCS_NO_CONTRACT_BODY
+    for (int j = 0; j < n; j++)
+        y[j] += alpha * x[j];
+}
+
+inline void rowScaleScalar(double *x, double alpha, int n)
+{
+    for (int j = 0; j < n; j++)
+        x[j] *= alpha;
+}
+
+inline int argmaxAbsScalar(const double *x, int n, int stride)
+{
+    int best = 0;
+    double bestVal = n > 0 ? fabs(x[0]) : 0.0;
+    for (int k = 1; k < n; k++)
+    {
+        double v = fabs(x[(size_t)k * stride]);
+        if (v > bestVal)
+        {
+            bestVal = v;
+            best = k;
+        }
+    }
+    return best;
+}
+
+// Combine per-lane (max, first index) pairs and finish the tail serially
+inline int argmaxFinish(const double *vals, const double *idx, int lanes,
+                        const double *x, int start, int n, int stride)
+{
+    double bestVal = vals[0];
+    int best = (int)idx[0];
+    for (int l = 1; l < lanes; l++)
+        if (vals[l] > bestVal || (vals[l] == bestVal && (int)idx[l] < best))
+        {
+            bestVal = vals[l];
+            best = (int)idx[l];
+        }
+    for (int k = start; k < n; k++)
+    {
+        double v = fabs(x[(size_t)k * stride]);
+        if (v > bestVal)
+        {
+            bestVal = v;
+            best = k;
+        }
+    }
+    return best;
+}
+
+#ifdef NCS_SIMD_X86
+
+/* ---------------- SSE2 (2 doubles) ---------------- */
+
+__attribute__((target("sse2"))) NCS_NO_CONTRACT
+inline void rowAxpySSE2(double *y, const double *x, double alpha, int n)
+{
+    NCS_NO_CONTRACT_BODY
+    __m128d a = _mm_set1_pd(alpha);
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(y + j, _mm_add_pd(_mm_loadu_pd(y + j), _mm_mul_pd(a, _mm_loadu_pd(x + j))));
+    for (; j < n; j++)
+        y[j] += alpha * x[j];
+}
+
+__attribute__((target("sse2")))
+inline void rowScaleSSE2(double *x, double alpha, int n)
+{
+    __m128d a = _mm_set1_pd(alpha);
+    int j = 0;
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(x + j, _mm_mul_pd(_mm_loadu_pd(x + j), a));
+    for (; j < n; j++)
+        x[j] *= alpha;
+}
+
+__attribute__((target("sse2")))
+inline int argmaxAbsSSE2(const double *x, int n, int stride)
+{
+    if (n < 4)
+        return argmaxAbsScalar(x, n, stride);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d best = _mm_set1_pd(-1.0), bestIdx = _mm_setzero_pd();
+    __m128d idx = _mm_set_pd(1.0, 0.0), step = _mm_set1_pd(2.0);
+    int k = 0;
+    for (; k + 2 <= n; k += 2)
+    {
+        __m128d v = _mm_set_pd(x[(size_t)(k + 1) * stride], x[(size_t)k * stride]);
+        v = _mm_andnot_pd(signMask, v);
+        __m128d gt = _mm_cmpgt_pd(v, best);
+        best = _mm_or_pd(_mm_and_pd(gt, v), _mm_andnot_pd(gt, best));
+        bestIdx = _mm_or_pd(_mm_and_pd(gt, idx), _mm_andnot_pd(gt, bestIdx));
+        idx = _mm_add_pd(idx, step);
+    }
+    double vals[2], ids[2];
+    _mm_storeu_pd(vals, best);
+    _mm_storeu_pd(ids, bestIdx);
+    return argmaxFinish(vals, ids, 2, x, k, n, stride);
+}
+
+/* ---------------- AVX2 (4 doubles) ---------------- */
+
+__attribute__((target("avx2"))) NCS_NO_CONTRACT
+inline void rowAxpyAVX2(double *y, const double *x, double alpha, int n)
+{
+    NCS_NO_CONTRACT_BODY
+    __m256d a = _mm256_set1_pd(alpha);
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256d y0 = _mm256_add_pd(_mm256_loadu_pd(y + j), _mm256_mul_pd(a, _mm256_loadu_pd(x + j)));
+        __m256d y1 = _mm256_add_pd(_mm256_loadu_pd(y + j + 4), _mm256_mul_pd(a, _mm256_loadu_pd(x + j + 4)));
+        _mm256_storeu_pd(y + j, y0);
+        _mm256_storeu_pd(y + j + 4, y1);
+    }
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(y + j, _mm256_add_pd(_mm256_loadu_pd(y + j), _mm256_mul_pd(a, _mm256_loadu_pd(x + j))));
+    for (; j < n; j++)
+        y[j] += alpha * x[j];
+}
+
+__attribute__((target("avx2")))
+inline void rowScaleAVX2(double *x, double alpha, int n)
+{
+    __m256d a = _mm256_set1_pd(alpha);
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(x + j, _mm256_mul_pd(_mm256_loadu_pd(x + j), a));
+    for (; j < n; j++)
+        x[j] *= alpha;
+}
+
+__attribute__((target("avx2")))
+inline int argmaxAbsAVX2(const double *x, int n, int stride)
+{
+    if (n < 8)
+        return argmaxAbsScalar(x, n, stride);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d best = _mm256_set1_pd(-1.0), bestIdx = _mm256_setzero_pd();
+    __m256d idx = _mm256_set_pd(3.0, 2.0, 1.0, 0.0), step = _mm256_set1_pd(4.0);
+    __m256i offsets = _mm256_set_epi64x(3LL * stride, 2LL * stride, 1LL * stride, 0);
+    int k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        const double *base = x + (size_t)k * stride;
+        __m256d v = stride == 1 ? _mm256_loadu_pd(base)
+                                : _mm256_i64gather_pd(base, offsets, 8);
+        v = _mm256_andnot_pd(signMask, v);
+        __m256d gt = _mm256_cmp_pd(v, best, _CMP_GT_OQ);
+        best = _mm256_blendv_pd(best, v, gt);
+        bestIdx = _mm256_blendv_pd(bestIdx, idx, gt);
+        idx = _mm256_add_pd(idx, step);
+    }
+    double vals[4], ids[4];
+    _mm256_storeu_pd(vals, best);
+    _mm256_storeu_pd(ids, bestIdx);
+    return argmaxFinish(vals, ids, 4, x, k, n, stride);
+}
+
+/* ---------------- AVX-512 (8 doubles, masked tails) ---------------- */
+
+__attribute__((target("avx512f"))) NCS_NO_CONTRACT
+inline void rowAxpyAVX512(double *y, const double *x, double alpha, int n)
+{
+    NCS_NO_CONTRACT_BODY
+    __m512d a = _mm512_set1_pd(alpha);
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(y + j, _mm512_add_pd(_mm512_loadu_pd(y + j), _mm512_mul_pd(a, _mm512_loadu_pd(x + j))));
+    if (j < n)
+    {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        __m512d yv = _mm512_maskz_loadu_pd(m, y + j);
+        __m512d xv = _mm512_maskz_loadu_pd(m, x + j);
+        _mm512_mask_storeu_pd(y + j, m, _mm512_add_pd(yv, _mm512_mul_pd(a, xv)));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void rowScaleAVX512(double *x, double alpha, int n)
+{
+    __m512d a = _mm512_set1_pd(alpha);
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+        _mm512_storeu_pd(x + j, _mm512_mul_pd(_mm512_loadu_pd(x + j), a));
+    if (j < n)
+    {
+        __mmask8 m = (__mmask8)((1u << (n - j)) - 1);
+        _mm512_mask_storeu_pd(x + j, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, x + j), a));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline int argmaxAbsAVX512(const double *x, int n, int stride)
+{
+    if (n < 16)
+        return argmaxAbsScalar(x, n, stride);
+    __m512d best = _mm512_set1_pd(-1.0), bestIdx = _mm512_setzero_pd();
+    __m512d idx = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0), step = _mm512_set1_pd(8.0);
+    long long s = stride;
+    __m512i offsets = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    int k = 0;
+    for (; k + 8 <= n; k += 8)
+    {
+        const double *base = x + (size_t)k * stride;
+        __m512d v = stride == 1 ? _mm512_loadu_pd(base)
+                                : _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xFF, offsets, base, 8);
+        v = _mm512_abs_pd(v);
+        __mmask8 gt = _mm512_cmp_pd_mask(v, best, _CMP_GT_OQ);
+        best = _mm512_mask_blend_pd(gt, best, v);
+        bestIdx = _mm512_mask_blend_pd(gt, bestIdx, idx);
+        idx = _mm512_add_pd(idx, step);
+    }
+    double vals[8], ids[8];
+    _mm512_storeu_pd(vals, best);
+    _mm512_storeu_pd(ids, bestIdx);
+    return argmaxFinish(vals, ids, 8, x, k, n, stride);
+}
+
+#endif // NCS_SIMD_X86
+
+/* ---------------- Dispatch ---------------- */
+
+struct Kernels
+{
+    Isa isa;
+    void (*rowAxpy)(double *, const double *, double, int);
+    void (*rowScale)(double *, double, int);
+    int (*argmaxAbs)(const double *, int, int);
+};
+
+inline Kernels kernelsFor(Isa isa)
+{
+#ifdef NCS_SIMD_X86
+    switch (isa)
+    {
+    case Isa::AVX512: return {isa, rowAxpyAVX512, rowScaleAVX512, argmaxAbsAVX512};
+    case Isa::AVX2: return {isa, rowAxpyAVX2, rowScaleAVX2, argmaxAbsAVX2};
+    case Isa::SSE2: return {isa, rowAxpySSE2, rowScaleSSE2, argmaxAbsSSE2};
+    default: break;
+    }
+#endif
+    return {Isa::Scalar, rowAxpyScalar, rowScaleScalar, argmaxAbsScalar};
+}
+
+// Kernel table in use; chosen from the CPU on first call
+inline Kernels &active()
+{
+    static Kernels k = kernelsFor(detectIsa());
+    return k;
+}
+
+// Force a variant (for testing or benchmarking); falls back to scalar if unsupported
+inline void useIsa(Isa isa)
+{
+    active() = isa <= detectIsa() ? kernelsFor(isa) : kernelsFor(Isa::Scalar);
+}
+
+inline Isa currentIsa() { return active().isa; }
+
+inline void rowAxpy(double *y, const double *x, double alpha, int n)
+{
+    active().rowAxpy(y, x, alpha, n);
+}
+
+inline void rowScale(double *x, double alpha, int n)
+{
+    active().rowScale(x, alpha, n);
+}
+
+inline int argmaxAbs(const double *x, int n, int stride = 1)
+{
+    return active().argmaxAbs(x, n, stride);
+}
+
+} // namespace simd
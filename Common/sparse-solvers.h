@@ -0,0 +1,591 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "sparse-matrix.h"
+
+/*
+   Sparse Linear Solvers on CSR Matrices
+
+   Direct:
+     minimumDegreeOrder(A)   fill-reducing symmetric ordering of A + A^T
+     SparseLU                left-looking LU with threshold partial pivoting
+                             (Gilbert-Peierls): P * A(q, q) = L * U
+
+   Iterative (x holds the initial guess and receives the solution):
+     conjugateGradient(A, b, x, M)   symmetric positive definite A
+     gmres(A, b, x, M, restart)      general A, restarted, right-preconditioned
+
+   Preconditioners (z = M^-1 * r):
+     Jacobi   inverse of the diagonal
+     ILU0     incomplete LU with the sparsity pattern of A
+
+   Everything is O(nnz) in memory except the LU factors, whose size depends
+   on the fill the ordering leaves.
+*/
+
+namespace sparse
+{
+
+/* ---------------- Fill-reducing ordering ---------------- */
+
+/*
+   Minimum degree on the elimination graph of A + A^T: repeatedly eliminate
+   the node with the fewest neighbours (lowest index on ties) and join its
+   neighbours into a clique. The graph then holds exactly the pattern of the
+   Cholesky factor, so memory grows with the fill it predicts. Returns q with
+   q[k] = original index of the k-th eliminated node.
+*/
+inline std::vector<int> minimumDegreeOrder(const CSR &a)
+{
+    int n = a.rows;
+    CSR t = a.transpose();
+    std::vector<std::vector<int>> adj(n);
+    for (int i = 0; i < n; i++)
+    {
+        auto &row = adj[i];
+        for (int p = a.rowPtr[i]; p < a.rowPtr[i + 1]; p++)
+            if (a.colIdx[p] != i)
+                row.push_back(a.colIdx[p]);
+        for (int p = t.rowPtr[i]; p < t.rowPtr[i + 1]; p++)
+            if (t.colIdx[p] != i)
+                row.push_back(t.colIdx[p]);
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+    }
+
+    std::set<std::pair<int, int>> queue; // (degree, node)
+    for (int i = 0; i < n; i++)
+        queue.insert({(int)adj[i].size(), i});
+
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<int> merged;
+    while (!queue.empty())
+    {
+        int p = queue.begin()->second;
+        queue.erase(queue.begin());
+        order.push_back(p);
+
+        std::vector<int> clique = std::move(adj[p]);
+        for (int u : clique)
+        {
+            queue.erase({(int)adj[u].size(), u});
+            merged.clear();
+            std::set_union(adj[u].begin(), adj[u].end(), clique.begin(), clique.end(),
+                           std::back_inserter(merged));
+            adj[u].clear();
+            for (int v : merged)
+                if (v != u && v != p)
+                    adj[u].push_back(v);
+            queue.insert({(int)adj[u].size(), u});
+        }
+    }
+    return order;
+}
+
+/* ---------------- Sparse LU ---------------- */
+
+class SparseLU
+{
+public:
+    enum class Ordering
+    {
+        Natural,
+        MinimumDegree
+    };
+
+    SparseLU() = default;
+
+    explicit SparseLU(const CSR &a, Ordering ordering = Ordering::MinimumDegree,
+                      double tol = 0.1)
+    {
+        factorize(a, ordering, tol);
+    }
+
+    /*
+       Factor the square matrix A. Column k of A(q, q) is solved against the
+       columns of L found so far (a sparse triangular solve over the reach of
+       its nonzeros), then the pivot is taken from the remaining rows: the
+       diagonal entry if it is within `tol` of the largest, which keeps the
+       fill-reducing order, else the largest. Returns false if some column has
+       no nonzero pivot candidate (A singular).
+    */
+    bool factorize(const CSR &a, Ordering ordering = Ordering::MinimumDegree,
+                   double tol = 0.1)
+    {
+        int n = a.rows;
+        n_ = n;
+        singular_ = false;
+        if (ordering == Ordering::MinimumDegree)
+            q_ = minimumDegreeOrder(a);
+        else
+        {
+            q_.resize(n);
+            std::iota(q_.begin(), q_.end(), 0);
+        }
+        std::vector<int> qinv(n);
+        for (int k = 0; k < n; k++)
+            qinv[q_[k]] = k;
+
+        // Columns of A as rows of A^T; column k of C = A(q, q) is column q[k] of A
+        CSR at = a.transpose();
+
+        pinv_.assign(n, -1);
+        lp_.assign(1, 0);
+        up_.assign(1, 0);
+        li_.clear();
+        lx_.clear();
+        ui_.clear();
+        ux_.clear();
+        size_t guess = 4 * a.nnz() + n;
+        li_.reserve(guess);
+        lx_.reserve(guess);
+        ui_.reserve(guess);
+        ux_.reserve(guess);
+
+        std::vector<double> x(n, 0.0);
+        std::vector<int> xi(2 * n); // reach in xi[top..n), DFS stack in xi[n..2n)
+        std::vector<char> mark(n, 0);
+        std::vector<int> pstack(n);
+
+        for (int k = 0; k < n; k++)
+        {
+            int col = q_[k];
+
+            // Reach of column k through the graph of L (depth-first, post-order)
+            int top = n;
+            for (int p = at.rowPtr[col]; p < at.rowPtr[col + 1]; p++)
+            {
+                int start = qinv[at.colIdx[p]];
+                if (!mark[start])
+                    top = dfs(start, top, xi, pstack, mark);
+            }
+            for (int p = top; p < n; p++)
+                mark[xi[p]] = 0;
+
+            // x = L \ C(:, k) on that reach
+            for (int p = top; p < n; p++)
+                x[xi[p]] = 0.0;
+            for (int p = at.rowPtr[col]; p < at.rowPtr[col + 1]; p++)
+                x[qinv[at.colIdx[p]]] = at.val[p];
+            for (int p = top; p < n; p++)
+            {
+                int j = xi[p];
+                int J = pinv_[j];
+                if (J < 0)
+                    continue;
+                for (int e = lp_[J] + 1; e < lp_[J + 1]; e++) // skip the unit diagonal
+                    x[li_[e]] -= lx_[e] * x[j];
+            }
+
+            // Split x into U (pivotal rows) and candidates for the pivot
+            int ipiv = -1;
+            double best = 0.0;
+            for (int p = top; p < n; p++)
+            {
+                int i = xi[p];
+                if (pinv_[i] < 0)
+                {
+                    if (std::fabs(x[i]) > best)
+                    {
+                        best = std::fabs(x[i]);
+                        ipiv = i;
+                    }
+                }
+                else
+                {
+                    ui_.push_back(pinv_[i]);
+                    ux_.push_back(x[i]);
+                }
+            }
+            if (ipiv < 0 || best == 0.0)
+            {
+                singular_ = true;
+                return false;
+            }
+            if (pinv_[k] < 0 && std::fabs(x[k]) >= tol * best)
+                ipiv = k;
+
+            // U(k, k) is stored last in its column, L(k, k) = 1 first
+            double pivot = x[ipiv];
+            ui_.push_back(k);
+            ux_.push_back(pivot);
+            up_.push_back((int)ui_.size());
+            pinv_[ipiv] = k;
+            li_.push_back(ipiv);
+            lx_.push_back(1.0);
+            for (int p = top; p < n; p++)
+            {
+                int i = xi[p];
+                if (pinv_[i] < 0)
+                {
+                    li_.push_back(i);
+                    lx_.push_back(x[i] / pivot);
+                }
+                x[i] = 0.0;
+            }
+            lp_.push_back((int)li_.size());
+        }
+
+        // Renumber the rows of L into pivot order
+        for (int &i : li_)
+            i = pinv_[i];
+        return true;
+    }
+
+    int size() const { return n_; }
+    bool singular() const { return singular_; }
+    size_t nnzL() const { return li_.size(); }
+    size_t nnzU() const { return ui_.size(); }
+    const std::vector<int> &ordering() const { return q_; }
+
+    // Solve A * x = b
+    std::vector<double> solve(const std::vector<double> &b) const
+    {
+        int n = n_;
+        std::vector<double> y(n);
+        for (int i = 0; i < n; i++)
+            y[pinv_[i]] = b[q_[i]];
+
+        // L * z = y (unit diagonal first in each column)
+        for (int j = 0; j < n; j++)
+            for (int e = lp_[j] + 1; e < lp_[j + 1]; e++)
+                y[li_[e]] -= lx_[e] * y[j];
+
+        // U * w = z (diagonal last in each column)
+        for (int j = n - 1; j >= 0; j--)
+        {
+            y[j] /= ux_[up_[j + 1] - 1];
+            for (int e = up_[j]; e < up_[j + 1] - 1; e++)
+                y[ui_[e]] -= ux_[e] * y[j];
+        }
+
+        std::vector<double> x(n);
+        for (int k = 0; k < n; k++)
+            x[q_[k]] = y[k];
+        return x;
+    }
+
+private:
+    // Non-recursive DFS from node j over the columns of L already computed
+    int dfs(int j, int top, std::vector<int> &xi, std::vector<int> &pstack,
+            std::vector<char> &mark) const
+    {
+        int *stack = xi.data() + n_;
+        int head = 0;
+        stack[0] = j;
+        while (head >= 0)
+        {
+            j = stack[head];
+            int J = pinv_[j];
+            if (!mark[j])
+            {
+                mark[j] = 1;
+                pstack[head] = J < 0 ? 0 : lp_[J] + 1;
+            }
+            bool done = true;
+            int end = J < 0 ? 0 : lp_[J + 1];
+            for (int p = pstack[head]; p < end; p++)
+            {
+                int i = li_[p];
+                if (mark[i])
+                    continue;
+                pstack[head] = p + 1;
+                stack[++head] = i;
+                done = false;
+                break;
+            }
+            if (done)
+            {
+                head--;
+                xi[--top] = j;
+            }
+        }
+        return top;
+    }
+
+    int n_ = 0;
+    bool singular_ = false;
+    std::vector<int> q_, pinv_;
+    std::vector<int> lp_, li_, up_, ui_; // L and U by columns (CSC)
+    std::vector<double> lx_, ux_;
+};
+
+/* ---------------- Preconditioners ---------------- */
+
+// z = M^-1 * r
+using Preconditioner = std::function<void(const double *, double *)>;
+
+class Jacobi
+{
+public:
+    explicit Jacobi(const CSR &a)
+    {
+        invDiag_ = a.diagonal();
+        for (int i = 0; i < (int)invDiag_.size(); i++)
+        {
+            if (invDiag_[i] == 0.0)
+                throw std::runtime_error("Jacobi: zero diagonal in row " + std::to_string(i + 1));
+            invDiag_[i] = 1.0 / invDiag_[i];
+        }
+    }
+
+    void apply(const double *r, double *z) const
+    {
+        for (size_t i = 0; i < invDiag_.size(); i++)
+            z[i] = invDiag_[i] * r[i];
+    }
+
+private:
+    std::vector<double> invDiag_;
+};
+
+/*
+   ILU(0): Gaussian elimination on A restricted to the nonzero pattern of A
+   (fill outside it is dropped). L (unit diagonal) and U share one copy of
+   that pattern.
+*/
+class ILU0
+{
+public:
+    explicit ILU0(const CSR &a) : lu_(a)
+    {
+        int n = a.rows;
+        diag_.resize(n);
+        for (int i = 0; i < n; i++)
+        {
+            diag_[i] = lu_.find(i, i);
+            if (diag_[i] < 0)
+                throw std::runtime_error("ILU(0): missing diagonal in row " + std::to_string(i + 1));
+        }
+
+        std::vector<int> pos(n, -1); // column -> position in the current row
+        for (int i = 0; i < n; i++)
+        {
+            for (int p = lu_.rowPtr[i]; p < lu_.rowPtr[i + 1]; p++)
+                pos[lu_.colIdx[p]] = p;
+
+            for (int p = lu_.rowPtr[i]; p < diag_[i]; p++)
+            {
+                int k = lu_.colIdx[p];
+                lu_.val[p] /= lu_.val[diag_[k]];
+                double lik = lu_.val[p];
+                for (int e = diag_[k] + 1; e < lu_.rowPtr[k + 1]; e++)
+                {
+                    int q = pos[lu_.colIdx[e]];
+                    if (q >= 0)
+                        lu_.val[q] -= lik * lu_.val[e];
+                }
+            }
+
+            if (lu_.val[diag_[i]] == 0.0)
+                throw std::runtime_error("ILU(0): zero pivot in row " + std::to_string(i + 1));
+            for (int p = lu_.rowPtr[i]; p < lu_.rowPtr[i + 1]; p++)
+                pos[lu_.colIdx[p]] = -1;
+        }
+    }
+
+    void apply(const double *r, double *z) const
+    {
+        int n = lu_.rows;
+        for (int i = 0; i < n; i++)
+        {
+            double sum = r[i];
+            for (int p = lu_.rowPtr[i]; p < diag_[i]; p++)
+                sum -= lu_.val[p] * z[lu_.colIdx[p]];
+            z[i] = sum;
+        }
+        for (int i = n - 1; i >= 0; i--)
+        {
+            double sum = z[i];
+            for (int p = diag_[i] + 1; p < lu_.rowPtr[i + 1]; p++)
+                sum -= lu_.val[p] * z[lu_.colIdx[p]];
+            z[i] = sum / lu_.val[diag_[i]];
+        }
+    }
+
+private:
+    CSR lu_;
+    std::vector<int> diag_;
+};
+
+/* ---------------- Krylov solvers ---------------- */
+
+struct IterativeResult
+{
+    bool converged = false;
+    int iterations = 0;
+    double residual = 0.0; // ||b - A x|| / ||b||
+};
+
+inline double dot(const std::vector<double> &x, const std::vector<double> &y)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < x.size(); i++)
+        s += x[i] * y[i];
+    return s;
+}
+
+inline double norm2(const std::vector<double> &x) { return std::sqrt(dot(x, x)); }
+
+// Preconditioned Conjugate Gradient; stops when ||r|| <= tol * ||b||
+inline IterativeResult conjugateGradient(const CSR &a, const std::vector<double> &b,
+                                         std::vector<double> &x, const Preconditioner &m,
+                                         double tol = 1e-10, int maxIter = 0)
+{
+    int n = a.rows;
+    if (maxIter <= 0)
+        maxIter = std::max(100, 2 * n);
+    x.resize(n, 0.0);
+
+    IterativeResult res;
+    double bnorm = norm2(b);
+    if (bnorm == 0.0)
+    {
+        std::fill(x.begin(), x.end(), 0.0);
+        res.converged = true;
+        return res;
+    }
+
+    std::vector<double> r(n), z(n), p(n), q(n);
+    a.multiply(x.data(), q.data());
+    for (int i = 0; i < n; i++)
+        r[i] = b[i] - q[i];
+    m(r.data(), z.data());
+    p = z;
+    double rz = dot(r, z);
+
+    res.residual = norm2(r) / bnorm;
+    while (res.residual > tol && res.iterations < maxIter)
+    {
+        a.multiply(p.data(), q.data());
+        double pq = dot(p, q);
+        if (pq <= 0.0)
+            break; // A is not positive definite along p
+        double alpha = rz / pq;
+        for (int i = 0; i < n; i++)
+        {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+        res.iterations++;
+        res.residual = norm2(r) / bnorm;
+        if (res.residual <= tol)
+            break;
+
+        m(r.data(), z.data());
+        double rzNext = dot(r, z);
+        double beta = rzNext / rz;
+        rz = rzNext;
+        for (int i = 0; i < n; i++)
+            p[i] = z[i] + beta * p[i];
+    }
+    res.converged = res.residual <= tol;
+    return res;
+}
+
+/*
+   Restarted GMRES(restart) with right preconditioning, A * M^-1 * u = b,
+   x = M^-1 * u. The Arnoldi basis is orthogonalized with modified
+   Gram-Schmidt and the small least-squares problem is kept triangular with
+   Givens rotations, so the residual norm is known at every step without
+   forming x.
+*/
+inline IterativeResult gmres(const CSR &a, const std::vector<double> &b,
+                             std::vector<double> &x, const Preconditioner &m,
+                             int restart = 30, double tol = 1e-10, int maxIter = 0)
+{
+    int n = a.rows;
+    if (maxIter <= 0)
+        maxIter = std::max(100, 2 * n);
+    restart = std::max(1, std::min(restart, n));
+    x.resize(n, 0.0);
+
+    IterativeResult res;
+    double bnorm = norm2(b);
+    if (bnorm == 0.0)
+    {
+        std::fill(x.begin(), x.end(), 0.0);
+        res.converged = true;
+        return res;
+    }
+
+    std::vector<std::vector<double>> v(restart + 1, std::vector<double>(n));
+    std::vector<std::vector<double>> h(restart + 1, std::vector<double>(restart, 0.0));
+    std::vector<double> cs(restart), sn(restart), g(restart + 1), y(restart);
+    std::vector<double> w(n), z(n);
+
+    while (true)
+    {
+        // r = b - A x starts a new Krylov space
+        a.multiply(x.data(), w.data());
+        for (int i = 0; i < n; i++)
+            v[0][i] = b[i] - w[i];
+        double beta = norm2(v[0]);
+        res.residual = beta / bnorm;
+        if (res.residual <= tol || res.iterations >= maxIter)
+            break;
+        for (int i = 0; i < n; i++)
+            v[0][i] /= beta;
+        std::fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        int k = 0;
+        for (; k < restart && res.iterations < maxIter; k++)
+        {
+            res.iterations++;
+            m(v[k].data(), z.data());
+            a.multiply(z.data(), w.data());
+            for (int j = 0; j <= k; j++)
+            {
+                h[j][k] = dot(w, v[j]);
+                for (int i = 0; i < n; i++)
+                    w[i] -= h[j][k] * v[j][i];
+            }
+            h[k + 1][k] = norm2(w);
+            if (h[k + 1][k] != 0.0)
+                for (int i = 0; i < n; i++)
+                    v[k + 1][i] = w[i] / h[k + 1][k];
+
+            // Apply the previous rotations, then one that zeroes h[k + 1][k]
+            for (int j = 0; j < k; j++)
+            {
+                double t = cs[j] * h[j][k] + sn[j] * h[j + 1][k];
+                h[j + 1][k] = -sn[j] * h[j][k] + cs[j] * h[j + 1][k];
+                h[j][k] = t;
+            }
+            double r = std::hypot(h[k][k], h[k + 1][k]);
+            cs[k] = r == 0.0 ? 1.0 : h[k][k] / r;
+            sn[k] = r == 0.0 ? 0.0 : h[k + 1][k] / r;
+            h[k][k] = r;
+            h[k + 1][k] = 0.0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+
+            if (std::fabs(g[k + 1]) / bnorm <= tol || r == 0.0)
+            {
+                k++;
+                break;
+            }
+        }
+
+        // u = V * y with H y = g, x += M^-1 u
+        for (int i = k - 1; i >= 0; i--)
+        {
+            double s = g[i];
+            for (int j = i + 1; j < k; j++)
+                s -= h[i][j] * y[j];
+            y[i] = h[i][i] == 0.0 ? 0.0 : s / h[i][i];
+        }
+        std::fill(w.begin(), w.end(), 0.0);
+        for (int j = 0; j < k; j++)
+            for (int i = 0; i < n; i++)
+                w[i] += y[j] * v[j][i];
+        m(w.data(), z.data());
+        for (int i = 0; i < n; i++)
+            x[i] += z[i];
+    }
+    res.converged = res.residual <= tol;
+    return res;
+}
+
+} // namespace sparse
@@ -0,0 +1,221 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   Streaming Pipeline (parse -> solve -> format, bounded memory)
+
+   Runs a sequence of independent jobs through three stages on separate
+   threads:
+
+     parse    one thread     reads the next job from the input
+     solve    k threads      does the numerical work
+     format   calling thread writes the results, strictly in input order
+
+   The stages are connected by bounded queues, and every job object comes
+   from a fixed pool of `depth` jobs that are recycled once formatted: the
+   parser blocks when all of them are in flight, so memory use is depth
+   times the largest job no matter how long the input is. Buffers inside a
+   job (matrices, vectors, text) keep their capacity from one use to the
+   next, so a warmed-up pipeline does not allocate.
+
+   Jobs may finish solving out of order when k > 1; job number s waits in
+   slot s % depth (at most depth jobs exist, so slots never collide) until
+   every earlier job has been formatted.
+
+   An exception thrown by any stage stops the pipeline and is rethrown by
+   run() in the calling thread.
+*/
+
+namespace stream
+{
+
+// Blocking FIFO with a fixed capacity; pop() returns false once the queue
+// is closed and empty
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+    void push(T value)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+        if (closed_)
+            return;
+        items_.push_back(std::move(value));
+        notEmpty_.notify_one();
+    }
+
+    bool pop(T &value)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [&] { return !items_.empty() || closed_; });
+        if (items_.empty())
+            return false;
+        value = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    // No more pushes; waiting poppers drain what is left, then get false
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_, notFull_;
+    bool closed_ = false;
+};
+
+struct Stats
+{
+    long long jobs = 0;
+    double seconds = 0;
+};
+
+/*
+   Job is any default-constructible type; the pipeline owns `depth` of them.
+
+     parse(Job &)          fill the job with the next input; false at the end
+     solve(Job &)          numerical work (called from the solver threads)
+     format(Job &)         write the results (called in input order)
+*/
+template <typename Job>
+class Pipeline
+{
+public:
+    Pipeline(int solvers = 1, int depth = 0)
+        : solvers_(std::max(1, solvers)),
+          depth_(depth > 0 ? depth : 2 * std::max(1, solvers) + 2),
+          jobs_(depth_)
+    {
+    }
+
+    int depth() const { return depth_; }
+    int solvers() const { return solvers_; }
+
+    template <typename Parse, typename Solve, typename Format>
+    Stats run(Parse parse, Solve solve, Format format)
+    {
+        auto start = std::chrono::steady_clock::now();
+        BoundedQueue<Slot> freeJobs(depth_), toSolve(depth_), solved(depth_);
+        for (int i = 0; i < depth_; i++)
+            freeJobs.push({&jobs_[i], 0});
+
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto fail = [&]()
+        {
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+            freeJobs.close();
+            toSolve.close();
+            solved.close();
+        };
+
+        std::thread parser([&]()
+        {
+            try
+            {
+                Slot slot;
+                for (long long seq = 0; freeJobs.pop(slot); seq++)
+                {
+                    if (!parse(*slot.job))
+                        break;
+                    slot.seq = seq;
+                    toSolve.push(slot);
+                }
+            }
+            catch (...)
+            {
+                fail();
+            }
+            toSolve.close();
+        });
+
+        std::atomic<int> running(solvers_);
+        std::vector<std::thread> workers;
+        for (int w = 0; w < solvers_; w++)
+            workers.emplace_back([&]()
+            {
+                try
+                {
+                    Slot slot;
+                    while (toSolve.pop(slot))
+                    {
+                        solve(*slot.job);
+                        solved.push(slot);
+                    }
+                }
+                catch (...)
+                {
+                    fail();
+                }
+                if (--running == 0)
+                    solved.close();
+            });
+
+        // Format in input order; early finishers wait in their slot
+        Stats stats;
+        try
+        {
+            std::vector<Slot> waiting(depth_);
+            std::vector<char> ready(depth_, 0);
+            long long next = 0;
+            Slot slot;
+            while (solved.pop(slot))
+            {
+                int at = (int)(slot.seq % depth_);
+                waiting[at] = slot;
+                ready[at] = 1;
+                for (at = (int)(next % depth_); ready[at]; at = (int)(next % depth_))
+                {
+                    ready[at] = 0;
+                    format(*waiting[at].job);
+                    freeJobs.push(waiting[at]);
+                    next++;
+                }
+            }
+            stats.jobs = next;
+        }
+        catch (...)
+        {
+            fail();
+        }
+
+        freeJobs.close();
+        toSolve.close();
+        parser.join();
+        for (auto &w : workers)
+            w.join();
+        if (error)
+            std::rethrow_exception(error);
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+private:
+    struct Slot
+    {
+        Job *job = nullptr;
+        long long seq = 0;
+    };
+
+    int solvers_, depth_;
+    std::vector<Job> jobs_;
+};
+
+} // namespace stream
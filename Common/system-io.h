@@ -0,0 +1,500 @@
+#pragma once
+#include <bits/stdc++.h>
+#include "matrix.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NCS_HAVE_MMAP 1
+#endif
+
+/*
+   Linear System Input (text and binary)
+
+   The linear solvers read a sequence of systems A X = B (A is n x n, B is
+   n x nrhs) from either of two formats:
+
+   Text (input.txt)   n, then n rows of n + nrhs numbers: [A | B]
+   Binary (.bin)      one record per system, all little-endian:
+
+     offset  size  field
+          0     8  magic "NCSLSYS\0"
+          8     4  version (1)
+         12     4  dtype   0 = float64, 1 = float32
+         16     4  layout  0 = augmented: n rows of n + nrhs values [A | B]
+                           1 = separate:  A (n x n, row-major), then B
+                               stored as nrhs rows of n values (B^T)
+         20     4  reserved (0)
+         24     8  n
+         32     8  nrhs
+         40    24  reserved (0)
+         64        data, padded with zeros to a multiple of 64 bytes
+
+   Binary files are memory-mapped (MAP_PRIVATE: the pages are copy-on-write,
+   so a solver may overwrite a system in place without touching the file),
+   and float64 systems are handed out as views straight into the mapping:
+   nothing is parsed or copied. Records start 64-byte aligned in the file.
+   float32 systems are widened into a buffer owned by the SystemReader.
+
+   Text files are read in 1 MB chunks and parsed with std::from_chars.
+
+   By default a SystemReader keeps every system it has returned, so all
+   views stay valid. A streaming reader (retain = false) reuses one buffer
+   instead and drops the mapped pages of binary records it has passed, so
+   its memory use does not grow with the file; each system's views are then
+   valid only until the next call to next().
+
+   Malformed files throw std::runtime_error. writeBinary() writes one record
+   (used by the text-to-binary converter).
+*/
+
+namespace sysio
+{
+
+const char MAGIC[8] = {'N', 'C', 'S', 'L', 'S', 'Y', 'S', '\0'};
+const uint32_t VERSION = 1;
+const size_t RECORD_ALIGN = 64;
+
+enum class DType : uint32_t
+{
+    Float64 = 0,
+    Float32 = 1
+};
+
+enum class Layout : uint32_t
+{
+    Augmented = 0,
+    Separate = 1
+};
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t reserved0;
+    uint64_t n;
+    uint64_t nrhs;
+    uint64_t reserved[3];
+};
+static_assert(sizeof(Header) == 64, "binary header must be 64 bytes");
+
+inline size_t paddedSize(size_t bytes) { return (bytes + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN; }
+
+// One system. The views point into the mapped file or into reader-owned
+// storage and stay valid as long as the SystemReader that produced them.
+struct System
+{
+    int n = 0, nrhs = 0;
+    mat::MatrixView<double> A; // n x n
+    mat::MatrixView<double> B; // n x nrhs
+
+    // Row-major [A | B] with leading dimension n + nrhs when the system is
+    // stored that way (text input and float64 augmented records), else null
+    double *augmented = nullptr;
+};
+
+/*
+   Read-only file mapping (writable copy-on-write pages). Falls back to
+   reading the file into memory where mmap is not available.
+*/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    void open(const std::string &path)
+    {
+        close();
+#ifdef NCS_HAVE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        size_ = (size_t)st.st_size;
+        if (size_ > 0)
+        {
+            void *p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path);
+            }
+            madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<char *>(p);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("cannot open " + path);
+        in.seekg(0, std::ios::end);
+        size_ = (size_t)in.tellg();
+        in.seekg(0);
+        copy_.reset(static_cast<char *>(::operator new(std::max<size_t>(size_, 1), std::align_val_t(RECORD_ALIGN))));
+        in.read(copy_.get(), (std::streamsize)size_);
+        data_ = copy_.get();
+#endif
+    }
+
+    void close()
+    {
+#ifdef NCS_HAVE_MMAP
+        if (data_)
+            munmap(data_, size_);
+#else
+        copy_.reset();
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Give the pages wholly inside [offset, offset + length) back to the OS;
+    // the data reads back from the file if touched again (private mapping)
+    void release(size_t offset, size_t length)
+    {
+#ifdef NCS_HAVE_MMAP
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t lo = (offset + page - 1) / page * page;
+        size_t hi = std::min(offset + length, size_) / page * page;
+        if (data_ && hi > lo)
+            madvise(data_ + lo, hi - lo, MADV_DONTNEED);
+#else
+        (void)offset;
+        (void)length;
+#endif
+    }
+
+private:
+    char *data_ = nullptr;
+    size_t size_ = 0;
+#ifndef NCS_HAVE_MMAP
+    struct AlignedDelete
+    {
+        void operator()(char *p) const { ::operator delete(p, std::align_val_t(RECORD_ALIGN)); }
+    };
+    std::unique_ptr<char, AlignedDelete> copy_;
+#endif
+};
+
+/*
+   Whitespace-separated numbers from a text file, read in fixed-size chunks
+   and converted with std::from_chars (a leading '+' is accepted, as with
+   operator>>). Memory use is one chunk whatever the file size. A token
+   that is not a number makes next() return false with bad() set, so it is
+   not mistaken for the end of the file.
+*/
+class TextScanner
+{
+public:
+    static const size_t CHUNK = 1 << 20;
+
+    void open(const std::string &path)
+    {
+        file_.reset(std::fopen(path.c_str(), "rb"));
+        buf_.resize(CHUNK);
+        pos_ = end_ = 0;
+        eof_ = bad_ = false;
+    }
+
+    explicit operator bool() const { return file_ != nullptr; }
+
+    // The last next() failed on a malformed token rather than at the end
+    bool bad() const { return bad_; }
+
+    // Next number, or false at the end of the file or on a malformed token
+    template <typename T>
+    bool next(T &value)
+    {
+        if (!token())
+            return false;
+        const char *p = buf_.data() + pos_, *e = buf_.data() + tokenEnd_;
+        if (*p == '+')
+            p++;
+        auto r = std::from_chars(p, e, value);
+        pos_ = tokenEnd_;
+        bad_ = r.ec != std::errc() || r.ptr != e;
+        return !bad_;
+    }
+
+private:
+    struct Close
+    {
+        void operator()(std::FILE *f) const { std::fclose(f); }
+    };
+
+    // Move the unread bytes to the front and fill up the rest of the buffer
+    bool refill()
+    {
+        if (eof_)
+            return false;
+        std::memmove(buf_.data(), buf_.data() + pos_, end_ - pos_);
+        end_ -= pos_;
+        pos_ = 0;
+        if (end_ == buf_.size())
+            buf_.resize(2 * buf_.size()); // a token longer than a chunk
+        size_t got = std::fread(buf_.data() + end_, 1, buf_.size() - end_, file_.get());
+        end_ += got;
+        if (got == 0)
+            eof_ = true;
+        return got > 0;
+    }
+
+    // Position pos_ .. tokenEnd_ on the next complete token
+    bool token()
+    {
+        while (true)
+        {
+            while (pos_ < end_ && std::isspace((unsigned char)buf_[pos_]))
+                pos_++;
+            if (pos_ < end_)
+                break;
+            if (!refill())
+                return false;
+        }
+        while (true)
+        {
+            tokenEnd_ = pos_;
+            while (tokenEnd_ < end_ && !std::isspace((unsigned char)buf_[tokenEnd_]))
+                tokenEnd_++;
+            if (tokenEnd_ < end_)
+                return true;
+            if (!refill())
+            {
+                tokenEnd_ = end_; // the token ends at the end of the file
+                return true;
+            }
+        }
+    }
+
+    std::unique_ptr<std::FILE, Close> file_;
+    std::vector<char> buf_;
+    size_t pos_ = 0, end_ = 0, tokenEnd_ = 0;
+    bool eof_ = false, bad_ = false;
+};
+
+// True if the file starts with the binary magic
+inline bool isBinary(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    char magic[8] = {};
+    return in.read(magic, 8) && std::equal(magic, magic + 8, MAGIC);
+}
+
+/*
+   Reads the systems of a text or binary input file one after the other.
+   textRhs is the number of right-hand-side columns per row in the text
+   format (1 for [A | b], 0 for a bare matrix); binary records carry their
+   own nrhs. With retain = false the reader streams (see the top of the
+   file): a system is only valid until the next call to next().
+*/
+class SystemReader
+{
+public:
+    SystemReader(const std::string &path, int textRhs = 1, bool retain = true)
+        : textRhs_(textRhs), retain_(retain)
+    {
+        binary_ = isBinary(path);
+        if (binary_)
+            file_.open(path);
+        else
+        {
+            text_.open(path);
+            if (!text_)
+                throw std::runtime_error("cannot open " + path);
+        }
+    }
+
+    bool binary() const { return binary_; }
+
+    // Next system, or false at the end of the input
+    bool next(System &sys)
+    {
+        return binary_ ? nextBinary(sys) : nextText(sys);
+    }
+
+private:
+    // Buffer for one system: a new one per system, or the reused one
+    mat::Matrix<double> &buffer(int rows, int cols)
+    {
+        if (retain_ || storage_.empty())
+            storage_.emplace_back();
+        storage_.back().assign(rows, cols);
+        return storage_.back();
+    }
+
+    bool nextText(System &sys)
+    {
+        int n;
+        if (!text_.next(n))
+        {
+            if (text_.bad())
+                throw std::runtime_error("malformed size of system " + std::to_string(count_ + 1));
+            return false;
+        }
+        if (n < 0)
+            throw std::runtime_error("negative system size");
+        int m = n + textRhs_;
+        mat::Matrix<double> &a = buffer(n, m);
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < m; j++)
+                if (!text_.next(a[i][j]))
+                    throw std::runtime_error("system " + std::to_string(count_ + 1) +
+                                             (text_.bad() ? " has a malformed value" : " is incomplete"));
+        count_++;
+        setAugmented(sys, a.data(), n, textRhs_);
+        return true;
+    }
+
+    bool nextBinary(System &sys)
+    {
+        size_t size = file_.size();
+        if (offset_ == size)
+            return false;
+        if (size - offset_ < sizeof(Header))
+            throw std::runtime_error("truncated record header");
+
+        Header h;
+        std::memcpy(&h, file_.data() + offset_, sizeof(h));
+        if (!std::equal(h.magic, h.magic + 8, MAGIC))
+            throw std::runtime_error("bad record magic at offset " + std::to_string(offset_));
+        if (h.version != VERSION)
+            throw std::runtime_error("unsupported format version " + std::to_string(h.version));
+        if (h.dtype > 1 || h.layout > 1)
+            throw std::runtime_error("unknown dtype or layout");
+        if (h.n > (uint64_t)INT_MAX || h.nrhs > (uint64_t)INT_MAX - h.n)
+            throw std::runtime_error("system too large");
+
+        // Streaming: the previous record is no longer needed
+        if (!retain_ && offset_ > 0)
+            file_.release(released_, offset_ - released_);
+        released_ = offset_;
+
+        int n = (int)h.n, nrhs = (int)h.nrhs;
+        size_t count = (size_t)n * (n + nrhs);
+        size_t elem = h.dtype == (uint32_t)DType::Float64 ? 8 : 4;
+        char *data = file_.data() + offset_ + sizeof(Header);
+        if ((size - offset_ - sizeof(Header)) / elem < count)
+            throw std::runtime_error("truncated record data");
+        offset_ = std::min(size, offset_ + sizeof(Header) + paddedSize(count * elem));
+        count_++;
+
+        double *values;
+        if (h.dtype == (uint32_t)DType::Float64)
+            values = reinterpret_cast<double *>(data); // used in place
+        else
+        {
+            values = buffer(1, (int)std::max<size_t>(count, 1)).data();
+            const float *f = reinterpret_cast<const float *>(data);
+            std::copy(f, f + count, values);
+        }
+
+        if (h.layout == (uint32_t)Layout::Augmented)
+            setAugmented(sys, values, n, nrhs);
+        else
+        {
+            sys.n = n;
+            sys.nrhs = nrhs;
+            sys.A = {values, n, n, n, 1};
+            sys.B = {values + (size_t)n * n, n, nrhs, 1, n}; // stored transposed
+            sys.augmented = nullptr;
+        }
+        return true;
+    }
+
+    static void setAugmented(System &sys, double *values, int n, int nrhs)
+    {
+        sys.n = n;
+        sys.nrhs = nrhs;
+        sys.A = {values, n, n, n + nrhs, 1};
+        sys.B = {values + n, n, nrhs, n + nrhs, 1};
+        sys.augmented = values;
+    }
+
+    bool binary_ = false;
+    int textRhs_;
+    bool retain_;
+    TextScanner text_;
+    MappedFile file_;
+    size_t offset_ = 0, released_ = 0;
+    long long count_ = 0;
+    std::deque<mat::Matrix<double>> storage_; // text systems and widened float32 data
+};
+
+/*
+   Append one binary record for A (n x n, leading dimension lda) and
+   B (n x nrhs, leading dimension ldb).
+*/
+inline void writeBinary(std::ostream &out, int n, int nrhs,
+                        const double *A, int lda, const double *B, int ldb,
+                        DType dtype = DType::Float64, Layout layout = Layout::Augmented)
+{
+    Header h = {};
+    std::copy(MAGIC, MAGIC + 8, h.magic);
+    h.version = VERSION;
+    h.dtype = (uint32_t)dtype;
+    h.layout = (uint32_t)layout;
+    h.n = (uint64_t)n;
+    h.nrhs = (uint64_t)nrhs;
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+    std::vector<double> row;
+    size_t written = 0;
+    auto emit = [&]()
+    {
+        if (dtype == DType::Float64)
+            out.write(reinterpret_cast<const char *>(row.data()), (std::streamsize)(row.size() * 8));
+        else
+        {
+            std::vector<float> f(row.begin(), row.end());
+            out.write(reinterpret_cast<const char *>(f.data()), (std::streamsize)(f.size() * 4));
+        }
+        written += row.size() * (dtype == DType::Float64 ? 8 : 4);
+    };
+
+    if (layout == Layout::Augmented)
+        for (int i = 0; i < n; i++)
+        {
+            row.assign(A + (size_t)i * lda, A + (size_t)i * lda + n);
+            for (int s = 0; s < nrhs; s++)
+                row.push_back(B[(size_t)i * ldb + s]);
+            emit();
+        }
+    else
+    {
+        for (int i = 0; i < n; i++)
+        {
+            row.assign(A + (size_t)i * lda, A + (size_t)i * lda + n);
+            emit();
+        }
+        for (int s = 0; s < nrhs; s++)
+        {
+            row.resize(n);
+            for (int i = 0; i < n; i++)
+                row[i] = B[(size_t)i * ldb + s];
+            emit();
+        }
+    }
+
+    static const char zeros[RECORD_ALIGN] = {};
+    out.write(zeros, (std::streamsize)(paddedSize(written) - written));
+    if (!out)
+        throw std::runtime_error("write failed");
+}
+
+} // namespace sysio
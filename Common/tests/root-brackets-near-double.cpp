@@ -0,0 +1,73 @@
+#include <bits/stdc++.h>
+#include "../root-brackets.h"
+using namespace std;
+
+/*
+   Regression check for bracket::scan and isolate() near double roots: a
+   run of grid points where |p| < tolerance is one root, not one per point.
+
+   (x - 1)(x - 1 - 1e-7)(x - 5) makes isolate() distrust its Sturm counts
+   near 1 and scan that piece on a 2^20-point grid, which used to report
+   88 roots around 1; the two close roots may come out as one or as two.
+   (x - 1)^2 (x - 5) is scanned with a block boundary inside the run, on 1
+   and 4 threads.
+*/
+
+int failures = 0;
+
+void check(bool ok, const string &what)
+{
+    if (!ok)
+    {
+        cout << "Error: " << what << endl;
+        failures++;
+    }
+}
+
+// Roots of s near one of `expected` and brackets holding one, each expected
+// value found at least once and at most most[i] times
+void expectRoots(const bracket::Scan &s, const vector<double> &expected, const vector<int> &most, double near,
+                 const string &name)
+{
+    vector<int> found(expected.size());
+    auto match = [&](double lo, double hi, const string &what)
+    {
+        for (size_t i = 0; i < expected.size(); i++)
+            if (lo - near <= expected[i] && expected[i] <= hi + near)
+            {
+                found[i]++;
+                return;
+            }
+        check(false, name + ": " + what + " at " + to_string((lo + hi) / 2) + " is not near a root");
+    };
+    for (double x : s.gridRoots)
+        match(x, x, "grid root");
+    for (const bracket::Interval &iv : s.intervals)
+        match(iv.lo, iv.hi, "bracket");
+    for (size_t i = 0; i < expected.size(); i++)
+        check(found[i] >= 1 && found[i] <= most[i],
+              name + ": root " + to_string(expected[i]) + " found " + to_string(found[i]) + " times");
+}
+
+int main()
+{
+    ThreadPool one(1), four(4);
+
+    // (x - 1)(x - 1 - 1e-7)(x - 5): the two close roots give one or two, not dozens
+    vector<double> nearDouble = {1.0, -7.0000001, 11.0000006, -5.0000005000000005};
+    for (ThreadPool *pool : {&one, &four})
+        expectRoots(bracket::isolate(nearDouble, HUGE_VAL, 1e-6, *pool), {1.0, 5.0}, {2, 1}, 1e-3,
+                    "isolate, " + to_string(pool->size()) + " threads");
+
+    // (x - 1)^2 (x - 5) on a grid whose block boundary falls inside the run of hits
+    vector<double> doubleRoot = {1.0, -7.0, 11.0, -5.0};
+    double step = 1e-6, lo = 1.0 - (bracket::SCAN_BLOCK + 0.5) * step;
+    bracket::Scan a = bracket::scan(doubleRoot, lo, 6.0, step, 1e-6, one);
+    bracket::Scan b = bracket::scan(doubleRoot, lo, 6.0, step, 1e-6, four);
+    expectRoots(a, {1.0, 5.0}, {1, 1}, 1e-3, "scan, 1 thread");
+    check(a.gridRoots == b.gridRoots && a.intervals.size() == b.intervals.size(),
+          "scan: 1 and 4 threads differ");
+
+    cout << (failures ? "FAILED" : "OK") << endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+#include <bits/stdc++.h>
+#include "../root-brackets.h"
+using namespace std;
+
+/*
+   Regression check for bracket::isolate with a bracket width limit, as
+   Newton's and the secant method ask for (0.5): brackets that already hold
+   one simple root are narrowed by the sign of p alone, so the Sturm chain
+   is not asked again where its counts go wrong.
+
+   Wilkinson's polynomial (x - 1)(x - 2) ... (x - 20) used to lose trust in
+   its counts and rescan the whole bound, reporting 130 brackets. It must
+   give 20 brackets, each at most 0.5 wide and reaching to within NEAR of
+   one of 1 .. 20 in turn: around 16 the rounding error of p(x) is about a
+   tenth of p' times the distance, so the sign of p is noise that close.
+*/
+
+const double NEAR = 0.1;
+
+int failures = 0;
+
+void check(bool ok, const string &what)
+{
+    if (!ok)
+    {
+        cout << "Error: " << what << endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    vector<double> wilkinson = {1.0};
+    for (int r = 1; r <= 20; r++)
+    {
+        wilkinson.push_back(0.0);
+        for (size_t k = wilkinson.size() - 1; k > 0; k--)
+            wilkinson[k] -= r * wilkinson[k - 1];
+    }
+
+    ThreadPool one(1), four(4);
+    for (ThreadPool *pool : {&one, &four})
+    {
+        string name = to_string(pool->size()) + " threads";
+        bracket::Scan s = bracket::isolate(wilkinson, HUGE_VAL, 1e-6, *pool, 0.5);
+        check(s.realRoots == 20, name + ": Sturm count " + to_string(s.realRoots) + ", expected 20");
+        check(s.gridRoots.empty(), name + ": " + to_string(s.gridRoots.size()) + " grid roots, expected none");
+        check(s.intervals.size() == 20, name + ": " + to_string(s.intervals.size()) + " brackets, expected 20");
+        for (size_t i = 0; i < s.intervals.size() && i < 20; i++)
+        {
+            const bracket::Interval &iv = s.intervals[i];
+            double root = i + 1.0;
+            check(iv.hi - iv.lo <= 0.5 && iv.lo - NEAR <= root && root <= iv.hi + NEAR,
+                  name + ": bracket " + to_string(i + 1) + " [" + to_string(iv.lo) + ", " + to_string(iv.hi) +
+                      "] is not near " + to_string(root) + " or is wider than 0.5");
+        }
+    }
+
+    cout << (failures ? "FAILED" : "OK") << endl;
+    return failures ? 1 : 0;
+}
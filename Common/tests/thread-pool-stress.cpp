@@ -0,0 +1,38 @@
+#include <bits/stdc++.h>
+#include "../thread-pool.h"
+using namespace std;
+
+/*
+   Stress check for ThreadPool::parallelFor: many short calls back to back,
+   so workers still stealing from one call overlap the start of the next.
+   Every index must run exactly once per call and every call must return.
+*/
+
+int main()
+{
+    const int CALLS = 20000;
+    int failures = 0;
+    for (int threads : {2, 4, 8})
+    {
+        ThreadPool pool(threads);
+        vector<int> hits(257);
+        for (int call = 0; call < CALLS; call++)
+        {
+            int n = 2 + call % 256, grain = 1 + call % 3;
+            fill(hits.begin(), hits.begin() + n, 0);
+            pool.parallelFor(0, n, grain, [&](int lo, int hi)
+            {
+                for (int i = lo; i < hi; i++)
+                    hits[i]++;
+            });
+            if (count(hits.begin(), hits.begin() + n, 1) != n)
+            {
+                cout << "Error: " << threads << " threads, call " << call << ": an index did not run exactly once" << endl;
+                failures++;
+                break;
+            }
+        }
+    }
+    cout << (failures ? "FAILED" : "OK") << endl;
+    return failures ? 1 : 0;
+}
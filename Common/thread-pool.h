@@ -0,0 +1,181 @@
+#pragma once
+#include <bits/stdc++.h>
+
+/*
+   Work-Stealing Thread Pool
+
+   parallelFor(begin, end, grain, body) cuts [begin, end) into blocks of
+   `grain` indices and deals them round-robin onto one deque per participant
+   (every worker plus the calling thread). Each participant pops blocks from
+   the front of its own deque; when it runs dry it steals from the back of
+   the others, so uneven blocks still balance out. The call returns once
+   every block has run.
+
+   body(lo, hi) must only touch data owned by indices in [lo, hi); the
+   blocks then commute and the result does not depend on the thread count.
+   parallelFor is not reentrant: call it from one thread at a time.
+
+   Inside body, ThreadPool::participant() is the index (0 .. size() - 1) of
+   the thread running the block, e.g. to pick a per-thread scratch buffer
+   that is allocated once outside the loop.
+*/
+
+class ThreadPool
+{
+public:
+    // threads = total participants including the caller (1 = run inline)
+    explicit ThreadPool(int threads = 1)
+    {
+        int participants = std::max(1, threads);
+        for (int i = 0; i < participants; i++)
+            queues_.push_back(std::make_unique<Queue>());
+        for (int id = 0; id + 1 < participants; id++)
+            workers_.emplace_back([this, id] { workerLoop(id); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &w : workers_)
+            w.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return (int)queues_.size(); }
+
+    // Index of the calling participant while it runs a parallelFor block
+    static int participant() { return currentId(); }
+
+    void parallelFor(int begin, int end, int grain,
+                     const std::function<void(int, int)> &body)
+    {
+        if (begin >= end)
+            return;
+        grain = std::max(1, grain);
+
+        // A single participant or a single block: no scheduling at all
+        if (workers_.empty() || end - begin <= grain)
+        {
+            currentId() = (int)workers_.size();
+            body(begin, end);
+            return;
+        }
+
+        // Publish the count before any block is visible: a worker still
+        // stealing at the end of the previous call may take one at once
+        int self = (int)workers_.size();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = (int)(((long long)end - begin + grain - 1) / grain);
+        }
+        for (int lo = begin, q = 0; lo < end; lo += grain, q = (q + 1) % size())
+        {
+            Queue &queue = *queues_[q];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back({lo, std::min(end, lo + grain), &body});
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation_++;
+        }
+        wake_.notify_all();
+
+        drain(self);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    struct Task
+    {
+        int lo, hi;
+        const std::function<void(int, int)> *body;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popLocal(int id, Task &task)
+    {
+        Queue &queue = *queues_[id];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(int id, Task &task)
+    {
+        int participants = size();
+        for (int offset = 1; offset < participants; offset++)
+        {
+            Queue &victim = *queues_[(id + offset) % participants];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty())
+                continue;
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    static int &currentId()
+    {
+        thread_local int id = 0;
+        return id;
+    }
+
+    // Run blocks until no deque has any left
+    void drain(int id)
+    {
+        currentId() = id;
+        Task task;
+        while (popLocal(id, task) || steal(id, task))
+        {
+            (*task.body)(task.lo, task.hi);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0)
+                done_.notify_all();
+        }
+    }
+
+    void workerLoop(int id)
+    {
+        unsigned long long seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_)
+                    return;
+                seen = generation_;
+            }
+            drain(id);
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_; // queues_[workers_.size()] is the caller's
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    unsigned long long generation_ = 0;
+    int pending_ = 0;
+    bool stop_ = false;
+};
@@ -2,6 +2,9 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <vector>
+#include "../../Common/cholesky.h"
+#include "../../Common/fixed-size-solvers.h"
 using namespace std;
 
 int main() {
@@ -46,35 +49,39 @@ int main() {
     // [ n    sumX   sumX2 ] [a]   [ sumY   ]
     // [sumX sumX2  sumX3 ] [b] = [ sumXY  ]
     // [sumX2 sumX3 sumX4] [c]   [ sumX2Y ]
-    double A[3][4] = {
-        {double(n), sumX, sumX2, sumY},
-        {sumX, sumX2, sumX3, sumXY},
-        {sumX2, sumX3, sumX4, sumX2Y}
-    };
-
-    // Gaussian elimination
-    for(int i=0;i<3;i++){
-        // Partial pivoting
-        int maxRow = i;
-        for(int k=i+1;k<3;k++){
-            if(abs(A[k][i]) > abs(A[maxRow][i])) maxRow = k;
-        }
-        for(int k=i;k<4;k++) swap(A[maxRow][k], A[i][k]);
-        // Eliminate
-        for(int k=i+1;k<3;k++){
-            double f = A[k][i]/A[i][i];
-            for(int j=i;j<4;j++)
-                A[k][j] -= f*A[i][j];
+    // The normal-equation matrix is symmetric positive definite whenever
+    // there are at least 3 distinct x values: Cholesky, half the work of
+    // Gaussian elimination. The size is fixed, so the unrolled 3 x 3
+    // Cholesky on the stack does it (Common/fixed-size-solvers.h); the
+    // general factorization falls back to pivoted LU otherwise
+    fx::Matrix<3> A = {{
+        {double(n), sumX, sumX2},
+        {sumX, sumX2, sumX3},
+        {sumX2, sumX3, sumX4}
+    }};
+    fx::Vector<3> rhs = {{sumY, sumXY, sumX2Y}};
+    vector<double> coeff(3);
+    chol::Method method = chol::Method::Cholesky;
+    fx::Cholesky<3> C(A);
+    if (C.ok) {
+        fx::Vector<3> c = C.solve(rhs);
+        coeff.assign(c.v, c.v + 3);
+    } else {
+        chol::SymmetricFactor F(&A[0][0], 3, 3);
+        if (F.singular()) {
+            fout << "\nThe normal equations are singular (at least 3 distinct x values are needed)." << endl;
+            return 1;
         }
+        coeff = F.solve(vector<double>(rhs.v, rhs.v + 3));
+        method = F.method();
     }
-    // Back substitution
-    double coeff[3];
-    for(int i=2;i>=0;i--){
-        coeff[i] = A[i][3];
-        for(int j=i+1;j<3;j++)
-            coeff[i] -= A[i][j]*coeff[j];
-        coeff[i] /= A[i][i];
-    }
+    fout << "\nNormal equations solved by " << chol::methodName(method) << endl;
+
+    // A coefficient that prints as zero is rounding noise: its sign depends
+    // on whether the compiler fused multiply-adds, so print it unsigned
+    for (double &c : coeff)
+        if (fabs(c) < 0.5e-6)
+            c = 0.0;
 
     fout << "\nEquation of best fit quadratic polynomial (Least Squares):" << endl;
     fout << "y = " << coeff[0] << " + " << coeff[1] << "x + " << coeff[2] << "x^2" << endl;
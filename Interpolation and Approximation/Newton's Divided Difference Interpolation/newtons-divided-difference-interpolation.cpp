@@ -1,4 +1,5 @@
 #include <bits/stdc++.h>
+#include "../../Common/matrix.h"
 using namespace std;
 
 /*
@@ -33,9 +34,9 @@ void printDataTable(const vector<double>& xs, const vector<double>& ys, ostream&
 /*
    Build Divided Difference Table
 */
-vector<vector<double>> buildDividedDiffTable(const vector<double>& xs, const vector<double>& ys) {
+mat::Matrix<double> buildDividedDiffTable(const vector<double>& xs, const vector<double>& ys) {
     int n = (int)xs.size();
-    vector<vector<double>> diff(n, vector<double>(n));
+    mat::Matrix<double> diff(n, n);
     
     // First column is y values
     for (int i=0; i<n; i++) diff[i][0] = ys[i];
@@ -56,7 +57,7 @@ vector<vector<double>> buildDividedDiffTable(const vector<double>& xs, const vec
 /*
    Print Divided Difference Table
 */
-void printDividedDiffTable(const vector<double>& xs, const vector<vector<double>>& diff, ostream& out) {
+void printDividedDiffTable(const vector<double>& xs, const mat::Matrix<double>& diff, ostream& out) {
     int n = (int)xs.size();
     
     out << "\n====================================\n";
@@ -81,7 +82,7 @@ void printDividedDiffTable(const vector<double>& xs, const vector<vector<double>
 /*
    Newton's Divided Difference Interpolation using pre-built table
 */
-double newtonDividedDifferenceWithTable(const vector<double>& xs, const vector<vector<double>>& diff, double x) {
+double newtonDividedDifferenceWithTable(const vector<double>& xs, const mat::Matrix<double>& diff, double x) {
     int n = (int)xs.size();
     if (n == 1) return diff[0][0];
     
@@ -98,7 +99,7 @@ double newtonDividedDifferenceWithTable(const vector<double>& xs, const vector<v
 /*
    Process and output interpolation results
 */
-void processInterpolation(const vector<double>& xs, const vector<vector<double>>& diff,
+void processInterpolation(const vector<double>& xs, const mat::Matrix<double>& diff,
                          const vector<double>& xInterpolate, vector<double>& results,
                          ostream& cout_stream, ostream& fout) {
     int m = xInterpolate.size();
@@ -200,7 +201,7 @@ int main() {
     
     // Build and print divided difference table
     try {
-        vector<vector<double>> diffTable = buildDividedDiffTable(xs, ys);
+        mat::Matrix<double> diffTable = buildDividedDiffTable(xs, ys);
         printDividedDiffTable(xs, diffTable, cout);
         printDividedDiffTable(xs, diffTable, fout);
         
@@ -248,7 +249,7 @@ int main() {
             printDataTable(xsNew, ysNew, fout);
             
             // Build new divided difference table
-            vector<vector<double>> diffTableNew = buildDividedDiffTable(xsNew, ysNew);
+            mat::Matrix<double> diffTableNew = buildDividedDiffTable(xsNew, ysNew);
             printDividedDiffTable(xsNew, diffTableNew, cout);
             printDividedDiffTable(xsNew, diffTableNew, fout);
             
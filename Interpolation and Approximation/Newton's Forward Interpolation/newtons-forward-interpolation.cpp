@@ -1,4 +1,5 @@
 #include <bits/stdc++.h>
+#include "../../Common/matrix.h"
 using namespace std;
 
 /*
@@ -42,9 +43,9 @@ void printDataTable(const vector<double>& xs, const vector<double>& ys, ostream&
 /*
    Build Forward Difference Table
 */
-vector<vector<double>> buildForwardDiffTable(const vector<double>& xs, const vector<double>& ys) {
+mat::Matrix<double> buildForwardDiffTable(const vector<double>& xs, const vector<double>& ys) {
     int n = (int)xs.size();
-    vector<vector<double>> diff(n, vector<double>(n));
+    mat::Matrix<double> diff(n, n);
     
     for (int i=0; i<n; i++) diff[i][0] = ys[i];
     for (int j=1; j<n; j++){
@@ -58,7 +59,7 @@ vector<vector<double>> buildForwardDiffTable(const vector<double>& xs, const vec
 /*
    Print Forward Difference Table
 */
-void printForwardDiffTable(const vector<double>& xs, const vector<vector<double>>& diff, ostream& out) {
+void printForwardDiffTable(const vector<double>& xs, const mat::Matrix<double>& diff, ostream& out) {
     int n = (int)xs.size();
     
     out << "\n====================================\n";
@@ -83,7 +84,7 @@ void printForwardDiffTable(const vector<double>& xs, const vector<vector<double>
 /*
    Newton's Forward Interpolation using pre-built table
 */
-double newtonForwardWithTable(const vector<double>& xs, const vector<vector<double>>& diff, double x) {
+double newtonForwardWithTable(const vector<double>& xs, const mat::Matrix<double>& diff, double x) {
     int n = (int)xs.size();
     if (n == 1) return diff[0][0];
     
@@ -102,7 +103,7 @@ double newtonForwardWithTable(const vector<double>& xs, const vector<vector<doub
 /*
    Process and output interpolation results
 */
-void processInterpolation(const vector<double>& xs, const vector<vector<double>>& diff,
+void processInterpolation(const vector<double>& xs, const mat::Matrix<double>& diff,
                          const vector<double>& xInterpolate, vector<double>& results,
                          ostream& cout_stream, ostream& fout) {
     int m = xInterpolate.size();
@@ -217,7 +218,7 @@ int main() {
     printDataTable(xs, ys, fout);
     
     // Build and print forward difference table
-    vector<vector<double>> diffTable = buildForwardDiffTable(xs, ys);
+    mat::Matrix<double> diffTable = buildForwardDiffTable(xs, ys);
     printForwardDiffTable(xs, diffTable, cout);
     printForwardDiffTable(xs, diffTable, fout);
     
@@ -277,7 +278,7 @@ int main() {
             printDataTable(xsNew, ysNew, fout);
             
             // Build new difference table
-            vector<vector<double>> diffTableNew = buildForwardDiffTable(xsNew, ysNew);
+            mat::Matrix<double> diffTableNew = buildForwardDiffTable(xsNew, ysNew);
             printForwardDiffTable(xsNew, diffTableNew, cout);
             printForwardDiffTable(xsNew, diffTableNew, fout);
             
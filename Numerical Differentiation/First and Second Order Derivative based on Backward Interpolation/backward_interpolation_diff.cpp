@@ -1,4 +1,5 @@
 #include <bits/stdc++.h>
+#include "../../Common/matrix.h"
 using namespace std;
 
 // Utility: factorial
@@ -11,11 +12,11 @@ static double factorial(int n)
 }
 
 // Utility: Backward Difference Table
-vector<vector<double>> backwardDiff(const vector<double> &y)
+mat::Matrix<double> backwardDiff(const vector<double> &y)
 {
     int n = y.size();
 
-    vector<vector<double>> b(n, vector<double>(n));
+    mat::Matrix<double> b(n, n);
 
     for (int i = 0; i < n; i++)
         b[i][0] = y[i];
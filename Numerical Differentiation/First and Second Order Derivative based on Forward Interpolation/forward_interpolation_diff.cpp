@@ -1,4 +1,5 @@
 #include <bits/stdc++.h>
+#include "../../Common/matrix.h"
 using namespace std;
 
 // Utility: factorial
@@ -11,10 +12,10 @@ static double factorial(int n)
 }
 
 // Utility: Forward Difference Table
-vector<vector<double>> forwardDiff(const vector<double> &y)
+mat::Matrix<double> forwardDiff(const vector<double> &y)
 {
     int n = y.size();
-    vector<vector<double>> d(n, vector<double>(n));
+    mat::Matrix<double> d(n, n);
 
     for (int i = 0; i < n; i++)
         d[i][0] = y[i];
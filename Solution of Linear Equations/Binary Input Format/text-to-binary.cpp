@@ -0,0 +1,112 @@
+#include <bits/stdc++.h>
+#include "../../Common/system-io.h"
+using namespace std;
+
+/*
+   Converts the text input of the linear solvers to the binary format of
+   Common/system-io.h, or generates a random test system in that format.
+
+     ./text-to-binary <input.txt> <output.bin> [options]
+     ./text-to-binary --random <n> <output.bin> [options]
+
+   options
+     --rhs <k>      right-hand-side columns per text row (default 1;
+                    0 for the bare matrices of Matrix Inversion)
+     --float32      store single precision values
+     --separate     store A, then B transposed, instead of [A | B]
+     --seed <s>     seed for --random (default 1)
+     --count <k>    number of random systems (default 1), e.g. a batch of
+                    small matrices for Gauss-Jordan --inverse
+*/
+
+void usage()
+{
+    cerr << "usage: text-to-binary <input.txt> <output.bin> [--rhs k] [--float32] [--separate]\n"
+         << "       text-to-binary --random <n> <output.bin> [--rhs k] [--float32] [--separate] [--seed s] [--count k]\n";
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> positional;
+    int rhs = 1, randomN = -1, count = 1;
+    unsigned seed = 1;
+    auto dtype = sysio::DType::Float64;
+    auto layout = sysio::Layout::Augmented;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--rhs" && i + 1 < argc)
+            rhs = max(0, atoi(argv[++i]));
+        else if (arg == "--float32")
+            dtype = sysio::DType::Float32;
+        else if (arg == "--separate")
+            layout = sysio::Layout::Separate;
+        else if (arg == "--random" && i + 1 < argc)
+            randomN = atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = (unsigned)atoi(argv[++i]);
+        else if (arg == "--count" && i + 1 < argc)
+            count = max(1, atoi(argv[++i]));
+        else
+            positional.push_back(arg);
+    }
+
+    if (positional.size() != (randomN >= 0 ? 1u : 2u))
+    {
+        usage();
+        return 1;
+    }
+
+    ofstream out(positional.back(), ios::binary);
+    if (!out)
+    {
+        cerr << "Error: cannot create " << positional.back() << "\n";
+        return 1;
+    }
+
+    int systems = 0;
+    try
+    {
+        if (randomN >= 0)
+        {
+            // Diagonally dominant, so the system is well conditioned for any n
+            int n = randomN;
+            mt19937_64 rng(seed);
+            uniform_real_distribution<double> U(-1.0, 1.0);
+            mat::Matrix<double> a(n, n + rhs);
+            for (; systems < count; systems++)
+            {
+                for (int i = 0; i < n; i++)
+                {
+                    for (int j = 0; j < n + rhs; j++)
+                        a[i][j] = U(rng);
+                    a[i][i] += n;
+                }
+                sysio::writeBinary(out, n, rhs, a.data(), a.ld(), a.data() + n, a.ld(), dtype, layout);
+            }
+        }
+        else
+        {
+            sysio::SystemReader reader(positional[0], rhs, false); // one system in memory at a time
+            if (reader.binary())
+                throw runtime_error(positional[0] + " is already binary");
+            sysio::System sys;
+            while (reader.next(sys))
+            {
+                sysio::writeBinary(out, sys.n, sys.nrhs, sys.A.ptr, (int)sys.A.rowStride,
+                                   sys.B.ptr, (int)sys.B.rowStride, dtype, layout);
+                systems++;
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    out.close();
+    cout << "Wrote " << systems << " system(s) to " << positional.back() << "\n";
+    return 0;
+}
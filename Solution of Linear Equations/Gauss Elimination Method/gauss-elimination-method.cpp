@@ -1,79 +1,197 @@
 #include <bits/stdc++.h>
+#include "../../Common/banded-solvers.h"
+#include "../../Common/batched-solve.h"
+#include "../../Common/fixed-size-solvers.h"
+#include "../../Common/matrix.h"
+#include "../../Common/output-writer.h"
+#include "../../Common/profiler.h"
+#include "../../Common/simd-kernels.h"
+#include "../../Common/stream-pipeline.h"
+#include "../../Common/system-io.h"
+#include "../../Common/thread-pool.h"
 using namespace std;
 
-int main()
+const int PRINT_LIMIT = 10; // echo systems and intermediate steps up to this size
+
+/*
+   Batch mode (./gauss-elimination-method --batch): for millions of tiny
+   independent systems. The whole input is parsed in one pass, systems of the
+   same size are solved LANES at a time by the SIMD kernels of
+   batched-solve.h, and each system gets one line of output, in input order.
+   Binary input is taken from the mapped records instead of being parsed.
+*/
+int runBatch(const string &inputPath, io::Writer &fout, io::Level level)
 {
-    ifstream fin("input.txt");
-    ofstream fout("output.txt");
+    batch::BatchSolver solver;
+    auto start = chrono::steady_clock::now();
 
-    if (!fin)
     {
-        cerr << "Error: input.txt not found!\n";
-        return 1;
-    }
+        PROF_SCOPE("parse"); // full SIMD blocks are solved as they fill
+        string text;
+        if (sysio::isBinary(inputPath))
+        {
+            sysio::SystemReader reader(inputPath);
+            sysio::System sys;
+            while (reader.next(sys))
+            {
+                if (sys.nrhs != 1)
+                    throw runtime_error("batch mode needs one right-hand side per system");
+                solver.add(sys.n);
+                for (int i = 0; i < sys.n; i++)
+                {
+                    for (int j = 0; j < sys.n; j++)
+                        solver.set(i, j, sys.A(i, j));
+                    solver.set(i, sys.n, sys.B(i, 0));
+                }
+                solver.commit();
+            }
+        }
+        else
+        {
+            ifstream fin(inputPath);
+            text.assign(istreambuf_iterator<char>(fin), istreambuf_iterator<char>());
+        }
 
-    fout << fixed << setprecision(2);
+        const char *p = text.data(), *end = p + text.size();
+        auto skipSpace = [&]() { while (p < end && isspace((unsigned char)*p)) p++; };
 
-    bool printIntermediate = true; // toggle intermediate steps
+        while (true)
+        {
+            int n;
+            skipSpace();
+            if (p == end)
+                break;
+            auto [next, ec] = from_chars(p, end, n);
+            if (ec != errc() || n < 1)
+            {
+                cerr << "Error: bad system size at offset " << p - text.data() << "\n";
+                return 1;
+            }
+            p = next;
+
+            solver.add(n);
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j <= n; j++)
+                {
+                    double v;
+                    skipSpace();
+                    auto [q, e] = from_chars(p, end, v);
+                    if (e != errc())
+                    {
+                        cerr << "Error: system " << solver.count() << " is incomplete\n";
+                        return 1;
+                    }
+                    p = q;
+                    solver.set(i, j, v);
+                }
+            solver.commit();
+        }
+    }
+    solver.finish();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    int n;
-    while (fin >> n)
     {
-        vector<vector<double>> a(n, vector<double>(n + 1));
-        vector<double> x(n);
+        PROF_SCOPE("output");
+        for (int s = 0; s < solver.count() && level > io::Level::Silent; s++)
+        {
+            fout << "System " << s + 1 << ": ";
+            if (solver.status(s) != batch::Status::Unique)
+            {
+                fout << batch::statusName(solver.status(s)) << "\n";
+                continue;
+            }
+            const double *x = solver.solution(s);
+            for (int i = 0; i < solver.size(s); i++)
+                fout << (i ? "  x" : "x") << i + 1 << " = " << x[i];
+            fout << "\n";
+        }
+    }
 
-        for (int i = 0; i < n; i++)
-            for (int j = 0; j <= n; j++)
-                fin >> a[i][j];
+    cout << "Solved " << solver.count() << " systems in " << fixed << setprecision(3) << seconds
+         << " s (" << batch::LANES << " per SIMD block, " << solver.scalarSolves()
+         << " on the scalar path)\n";
+    return 0;
+}
+
+/*
+   Eliminate [A | b] (n x n+1, partial pivoting) and back-substitute into x.
+   The input echo and the step-by-step trace go to log, as the level asks.
+*/
+batch::Status eliminate(mat::Matrix<double> &a, vector<double> &x, ThreadPool &pool,
+                        io::Writer &log, io::Level level)
+{
+    int n = a.rows();
+    bool printIntermediate = level == io::Level::Full; // intermediate steps
+    x.assign(n, 0.0);
 
+    if (level >= io::Level::Summary && n <= PRINT_LIMIT)
+    {
         // Print the original system
-        fout << "\nInput system:\n";
+        PROF_SCOPE("echo");
+        log << "\nInput system:\n";
         for (int i = 0; i < n; i++)
         {
             for (int j = 0; j < n; j++)
             {
-                if (j > 0 && a[i][j] >= 0) fout << "+";
-                fout << a[i][j] << "x" << j + 1 << " ";
+                if (j > 0 && a[i][j] >= 0) log << "+";
+                log << a[i][j] << "x" << j + 1 << " ";
             }
-            fout << "= " << a[i][n] << "\n";
+            log << "= " << a[i][n] << "\n";
         }
+    }
 
-        // Forward Elimination
+    // Forward Elimination
+    {
+        PROF_SCOPE("elimination");
         for (int i = 0; i < n - 1; i++)
         {
             int maxRow = i;
             for (int k = i + 1; k < n; k++)
                 if (fabs(a[k][i]) > fabs(a[maxRow][i]))
                     maxRow = k;
-            swap(a[i], a[maxRow]);
+            a.swapRows(i, maxRow); // swaps row pointers only
+            if (maxRow != i)
+                PROF_SWAPS(1);
 
             if (fabs(a[i][i]) < 1e-12)
                 continue;
 
-            for (int k = i + 1; k < n; k++)
+            // Rows below the pivot are independent: update them in parallel blocks
+            int rows = n - i - 1;
+            int grain = max(1, rows / (pool.size() * 4));
+            if ((long long)rows * (n - i + 1) < 32768)
+                grain = rows; // too little work to be worth scheduling
+            PROF_FLOPS(rows * (2.0 * (n - i + 1) + 1));
+            PROF_BYTES(16.0 * rows * (n - i + 1)); // each updated row read and written
+
+            pool.parallelFor(i + 1, n, grain, [&](int lo, int hi)
             {
-                double factor = a[k][i] / a[i][i];
-                for (int j = i; j <= n; j++)
-                    a[k][j] -= factor * a[i][j];
-            }
+                for (int k = lo; k < hi; k++)
+                {
+                    double factor = a[k][i] / a[i][i];
+                    simd::rowAxpy(&a[k][i], &a[i][i], -factor, n - i + 1);
+                }
+            });
 
             // Print intermediate matrix if enabled
-            if (printIntermediate)
+            if (printIntermediate && n <= PRINT_LIMIT)
             {
-                fout << "\nAfter step " << i + 1 << ":\n";
+                log << "\nAfter step " << i + 1 << ":\n";
                 for (int r = 0; r < n; r++)
                 {
                     for (int c = 0; c <= n; c++)
-                        fout << a[r][c] << "\t";
-                    fout << "\n";
+                        log << a[r][c] << "\t";
+                    log << "\n";
                 }
             }
         }
+    }
 
-        // Detect solution type
-        bool noSolution = false, infiniteSolution = false;
+    // Detect solution type
+    {
+        PROF_SCOPE("rank");
+        PROF_BYTES(8.0 * n * (n + 1));
         int rank = 0;
-
         for (int i = 0; i < n; i++)
         {
             bool allZero = true;
@@ -81,43 +199,370 @@ int main()
                 if (fabs(a[i][j]) > 1e-12) allZero = false;
 
             if (allZero && fabs(a[i][n]) > 1e-12)
-            {
-                noSolution = true;
-                break;
-            }
+                return batch::Status::NoSolution;
             if (!allZero)
                 rank++;
         }
+        if (rank < n)
+            return batch::Status::Infinite;
+    }
 
-        if (!noSolution && rank < n)
-            infiniteSolution = true;
+    // Back substitution
+    PROF_SCOPE("substitution");
+    PROF_FLOPS((double)n * n);
+    PROF_BYTES(4.0 * n * (n + 1)); // the upper triangle, once
+    for (int i = n - 1; i >= 0; i--)
+    {
+        x[i] = a[i][n];
+        for (int j = i + 1; j < n; j++)
+            x[i] -= a[i][j] * x[j];
+        x[i] /= a[i][i];
+    }
+    return batch::Status::Unique;
+}
 
-        // Write output
-        if (noSolution)
-            fout << "\nNo Solution\n";
-        else if (infiniteSolution)
-            fout << "\nInfinite Solutions\n";
-        else
+/*
+   Banded fast path: A is scanned for its bandwidth and a narrow band is
+   solved in O(n k^2) instead of O(n^3) (Common/banded-solvers.h): a
+   diagonally dominant tridiagonal A by the Thomas algorithm (by cyclic
+   reduction on the pool when it is long and there are threads), any other
+   band by LU with partial pivoting inside the band. A system that is not
+   banded, or whose pivot vanishes, is left to eliminate() (returns Dense),
+   which then also classifies it.
+*/
+enum SolvePath { Dense, FixedSize, Thomas, CyclicReduction, BandLU, PATH_COUNT };
+
+SolvePath solveBanded(const mat::Matrix<double> &a, vector<double> &x, ThreadPool &pool)
+{
+    int n = a.rows();
+    if (n < 4)
+        return Dense;
+    band::Bandwidth bw;
+    {
+        PROF_SCOPE("band scan"); // stops early on a dense matrix: bytes not counted
+        bw = band::bandwidth(a.data(), n, a.ld(), n / 4);
+    }
+    if (!band::worthBanded(bw, n))
+        return Dense;
+
+    PROF_SCOPE("banded");
+    x.resize(n);
+    for (int i = 0; i < n; i++)
+        x[i] = a(i, n);
+
+    if (bw.lower <= 1 && bw.upper <= 1)
+    {
+        band::Tridiagonal t(a.data(), n, a.ld());
+        if (t.diagonallyDominant())
         {
-            fout << "\nUnique Solution\n";
-            for (int i = n - 1; i >= 0; i--)
+            if (pool.size() > 1 && n >= band::CR_MIN_SIZE)
             {
-                x[i] = a[i][n];
-                for (int j = i + 1; j < n; j++)
-                    x[i] -= a[i][j] * x[j];
-                x[i] /= a[i][i];
+                PROF_FLOPS(17.0 * n);
+                if (band::cyclicReduction(t, x.data(), pool))
+                    return CyclicReduction;
+            }
+            else
+            {
+                PROF_FLOPS(8.0 * n);
+                if (band::thomas(t, x.data()))
+                    return Thomas;
             }
-
-            fout << "Solution:\n";
             for (int i = 0; i < n; i++)
-                fout << "x" << i + 1 << " = " << x[i] << "\n";
+                x[i] = a(i, n);
+        }
+    }
+
+    band::BandLU F;
+    PROF_FLOPS(2.0 * n * bw.lower * (bw.lower + bw.upper + 1));
+    PROF_BYTES(8.0 * n * (2 * bw.lower + bw.upper + 1));
+    if (!F.factor(a.data(), n, a.ld(), bw))
+        return Dense;
+    F.solve(x.data());
+    return BandLU;
+}
+
+/*
+   Small-system fast path: n <= fx::MAX_N is solved by the unrolled
+   fixed-size LU of Common/fixed-size-solvers.h, on the stack. It pivots
+   like eliminate() and fails on the same pivots below 1e-12, so a singular
+   A is left to eliminate(), which classifies it.
+*/
+bool solveSmall(const mat::Matrix<double> &a, vector<double> &x)
+{
+    int n = a.rows();
+    if (n > fx::MAX_N)
+        return false;
+    PROF_SCOPE("fixed-size");
+    PROF_FLOPS(2.0 * n * n * n / 3);
+    double b[fx::MAX_N];
+    for (int i = 0; i < n; i++)
+        b[i] = a(i, n);
+    x.resize(n);
+    return fx::solve(n, a.data(), a.ld(), b, x.data());
+}
+
+// Systems solved by each path, for the console summary
+struct PathCounts
+{
+    atomic<int> count[PATH_COUNT] = {};
+
+    void report() const
+    {
+        if (count[FixedSize] > 0)
+            cout << "Fixed-size path (n <= " << fx::MAX_N << "): " << count[FixedSize] << " systems\n";
+        int banded = count[Thomas] + count[CyclicReduction] + count[BandLU];
+        if (banded == 0)
+            return;
+        cout << "Banded fast path: " << banded << " of " << banded + count[Dense]
+             << " systems (Thomas " << count[Thomas] << ", cyclic reduction " << count[CyclicReduction]
+             << ", band LU " << count[BandLU] << ")\n";
+    }
+};
+
+/*
+   One system: the fixed-size or banded path unless they are disabled
+   (dense) or the level asks for the echo and trace of a small system, else
+   eliminate()
+*/
+batch::Status solveSystem(mat::Matrix<double> &a, vector<double> &x, ThreadPool &pool,
+                          io::Writer &log, io::Level level, bool dense, PathCounts &paths)
+{
+    SolvePath path = Dense;
+    if (!dense && (level < io::Level::Summary || a.rows() > PRINT_LIMIT))
+        path = solveSmall(a, x) ? FixedSize : solveBanded(a, x, pool);
+    paths.count[path]++;
+    return path == Dense ? eliminate(a, x, pool, log, level) : batch::Status::Unique;
+}
+
+void writeResult(io::Writer &fout, batch::Status status, const vector<double> &x)
+{
+    fout << "\n" << batch::statusName(status) << "\n";
+    if (status == batch::Status::Unique)
+    {
+        fout << "Solution:\n";
+        for (size_t i = 0; i < x.size(); i++)
+            fout << "x" << i + 1 << " = " << x[i] << "\n";
+    }
+    fout << "\n-------------------------------------------\n\n";
+}
+
+// Copy [A | b] of a system into a (n x n+1)
+void loadAugmented(const sysio::System &sys, mat::Matrix<double> &a)
+{
+    int n = sys.n;
+    if (sys.nrhs != 1)
+        throw runtime_error("Gauss elimination needs one right-hand side per system");
+    a.assign(n, n + 1);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+            a[i][j] = sys.A(i, j);
+        a[i][n] = sys.B(i, 0);
+    }
+}
+
+/*
+   Stream mode (./gauss-elimination-method --stream [--solvers k]): for input
+   files with many large systems. Parsing, elimination and output overlap on
+   separate threads (Common/stream-pipeline.h); a fixed pool of jobs bounds
+   the memory to a few systems however long the file is, and the output is
+   the same text as the default mode, in input order.
+*/
+struct StreamJob
+{
+    mat::Matrix<double> a;
+    vector<double> x;
+    io::Writer log; // echo and trace of this system
+    batch::Status status = batch::Status::Unique;
+};
+
+void runStream(const string &inputPath, io::Writer &fout, io::Level level, int solvers,
+               bool dense, PathCounts &paths)
+{
+    sysio::SystemReader reader(inputPath, 1, false); // streaming: keep no old systems
+    sysio::System sys;
+    ThreadPool pool(1); // each solver eliminates its own system serially
+    stream::Pipeline<StreamJob> pipeline(solvers);
+
+    stream::Stats stats = pipeline.run(
+        [&](StreamJob &job)
+        {
+            PROF_SCOPE("parse");
+            if (!reader.next(sys))
+                return false;
+            PROF_BYTES(8.0 * sys.n * (sys.n + 1));
+            loadAugmented(sys, job.a);
+            return true;
+        },
+        [&](StreamJob &job)
+        {
+            job.log.clear();
+            job.log.precision(fout.precision());
+            job.status = solveSystem(job.a, job.x, pool, job.log, level, dense, paths);
+        },
+        [&](StreamJob &job)
+        {
+            if (level == io::Level::Silent)
+                return;
+            PROF_SCOPE("output");
+            fout << job.log.str();
+            writeResult(fout, job.status, job.x);
+        });
+
+    cout << "Streamed " << stats.jobs << " systems in " << fixed << setprecision(3) << stats.seconds
+         << " s (" << pipeline.solvers() << " solver thread(s), at most " << pipeline.depth()
+         << " systems in memory)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    // Optional: ./gauss-elimination-method [threads] [--batch] [--stream [--solvers k]] [--dense]
+    //                                      [--input file] [--output silent|solution|summary|full]
+    //                                      [--profile file]
+    // The trailing rows of every step are split into blocks and run on a
+    // work-stealing pool; each row is updated exactly as in the serial loop,
+    // so the result is bit-identical for any thread count. The input file
+    // may be text or binary (see Common/system-io.h). Banded systems take
+    // the fast path of solveBanded() unless --dense is given. A build with
+    // -DNCS_PROFILE writes per-phase times and counts to profile.json (or
+    // the --profile file), see Common/profiler.h.
+    int threads = 1;
+    int solvers = 1;
+    bool batchMode = false, streamMode = false, dense = false;
+    PathCounts paths;
+    string inputPath = "input.txt";
+    string profilePath = "profile.json";
+    io::Level level = io::Level::Full; // how much to write, see Common/output-writer.h
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg == "--batch")
+                batchMode = true;
+            else if (arg == "--stream")
+                streamMode = true;
+            else if (arg == "--dense")
+                dense = true;
+            else if (arg == "--solvers" && i + 1 < argc)
+                solvers = max(1, atoi(argv[++i]));
+            else if (arg == "--input" && i + 1 < argc)
+                inputPath = argv[++i];
+            else if (arg == "--output" && i + 1 < argc)
+                level = io::parseLevel(argv[++i]);
+            else if (arg == "--profile" && i + 1 < argc)
+            {
+                profilePath = argv[++i];
+                if (!prof::ENABLED)
+                    cerr << "Note: --profile needs a build with -DNCS_PROFILE\n";
+            }
+            else if (isdigit((unsigned char)arg[0]))
+                threads = max(1, atoi(argv[i]));
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    ifstream probe(inputPath);
+    if (!probe)
+    {
+        cerr << "Error: " << inputPath << " not found!\n";
+        return 1;
+    }
+    probe.close();
+
+    io::Writer fout("output.txt");
+    if (!fout)
+    {
+        cerr << "Error: cannot open output.txt\n";
+        return 1;
+    }
+    fout.precision(2);
+
+    auto writeProfile = [&]()
+    {
+        PROF_REPORT("gauss-elimination-method", profilePath);
+        if (prof::ENABLED)
+            cout << "Profile written to " << profilePath << "\n";
+    };
+
+    try
+    {
+        if (batchMode)
+        {
+            int status = runBatch(inputPath, fout, level);
+            fout.close();
+            if (!fout)
+                throw runtime_error("could not write output.txt");
+            if (status == 0)
+            {
+                writeProfile();
+                cout << "All results written to output.txt\n";
+            }
+            return status;
         }
 
-        fout << "\n-------------------------------------------\n\n";
+        if (streamMode)
+        {
+            runStream(inputPath, fout, level, solvers, dense, paths);
+            fout.close();
+            if (!fout)
+                throw runtime_error("could not write output.txt");
+            writeProfile();
+            paths.report();
+            cout << "All results written to output.txt\n";
+            return 0;
+        }
+
+        ThreadPool pool(threads);
+        sysio::SystemReader reader(inputPath);
+        sysio::System sys;
+
+        // [A | b] is eliminated where the reader keeps it (for binary input,
+        // in the copy-on-write pages of the mapped file): no copy is made
+        mat::Matrix<double> a;
+        vector<double> x;
+
+        auto next = [&]()
+        {
+            PROF_SCOPE("parse");
+            if (!reader.next(sys))
+                return false;
+            PROF_BYTES(8.0 * sys.n * (sys.n + 1));
+            if (sys.augmented && sys.nrhs == 1)
+                a = mat::Matrix<double>::borrow(sys.augmented, sys.n, sys.n + 1);
+            else
+                loadAugmented(sys, a);
+            return true;
+        };
+
+        while (next())
+        {
+            batch::Status status = solveSystem(a, x, pool, fout, level, dense, paths);
+            if (level > io::Level::Silent)
+            {
+                PROF_SCOPE("output");
+                writeResult(fout, status, x);
+            }
+        }
+        writeProfile();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
     }
 
-    fin.close();
     fout.close();
+    if (!fout)
+    {
+        cerr << "Error: could not write output.txt\n";
+        return 1;
+    }
+    paths.report();
     cout << "All results written to output.txt\n";
     return 0;
 }
\ No newline at end of file
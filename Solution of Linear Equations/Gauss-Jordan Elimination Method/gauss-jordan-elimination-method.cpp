@@ -1,44 +1,184 @@
 #include <bits/stdc++.h>
+#include "../../Common/fixed-size-solvers.h"
+#include "../../Common/gauss-jordan-inverse.h"
+#include "../../Common/matrix.h"
+#include "../../Common/output-writer.h"
+#include "../../Common/profiler.h"
+#include "../../Common/simd-kernels.h"
+#include "../../Common/stream-pipeline.h"
+#include "../../Common/system-io.h"
 using namespace std;
 
-int main()
+const int PRINT_LIMIT = 10; // echo systems and intermediate steps up to this size
+
+/*
+   Inverse mode (./gauss-jordan-elimination-method --inverse [threads]): the
+   input holds bare matrices (n, then n rows of n values; binary records use
+   A only). Each one is reduced as [A | I] -> [I | A^-1] in place, and all of
+   them are inverted concurrently on a work-stealing pool with per-thread
+   scratch (Common/gauss-jordan-inverse.h). One matrix is just a batch of one.
+*/
+int runInverse(const string &inputPath, io::Writer &fout, io::Level level, int threads)
 {
-    ifstream fin("input.txt");
-    ofstream fout("output.txt");
+    gj::BatchInverter inverter;
+    sysio::SystemReader reader(inputPath, 0);
+    sysio::System sys;
+    bool summary = level >= io::Level::Summary;
 
-    if (!fin)
+    // The inverses overwrite the matrices, so keep the input for the echo and check
+    vector<double> original;
+    vector<size_t> originalAt;
     {
-        cerr << "Error: input.txt not found!\n";
-        return 1;
+        PROF_SCOPE("parse");
+        while (reader.next(sys))
+        {
+            if (sys.n < 1)
+                throw runtime_error("matrix " + to_string(inverter.count() + 1) + " is empty");
+            inverter.add(&sys.A(0, 0), sys.n, (int)sys.A.rowStride);
+            if (summary)
+            {
+                originalAt.push_back(original.size());
+                for (int i = 0; i < sys.n; i++)
+                    for (int j = 0; j < sys.n; j++)
+                        original.push_back(sys.A(i, j));
+            }
+        }
+    }
+
+    ThreadPool pool(threads);
+    auto start = chrono::steady_clock::now();
+    {
+        PROF_SCOPE("inversion");
+        for (int s = 0; s < inverter.count(); s++)
+            PROF_FLOPS(2.0 * inverter.size(s) * inverter.size(s) * inverter.size(s));
+        inverter.run(pool);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    PROF_SCOPE("output");
+    fout.precision(6);
+    for (int s = 0; s < inverter.count() && level > io::Level::Silent; s++)
+    {
+        int n = inverter.size(s);
+        const double *inv = inverter.matrix(s);
+        fout << "Matrix " << s + 1 << " (" << n << " x " << n << "):";
+
+        if (summary && n <= PRINT_LIMIT)
+        {
+            fout << "\nInput:\n";
+            for (int i = 0; i < n; i++)
+            {
+                for (int j = 0; j < n; j++)
+                    fout << io::width(12) << original[originalAt[s] + (size_t)i * n + j];
+                fout << "\n";
+            }
+        }
+
+        if (!inverter.invertible(s))
+        {
+            fout << (summary && n <= PRINT_LIMIT ? "" : " ") << "Singular, no inverse\n\n";
+            continue;
+        }
+
+        fout << "\nInverse using Gauss-Jordan ([A | I] -> [I | A^-1]):\n";
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+                fout << io::width(12) << inv[(size_t)i * n + j];
+            fout << "\n";
+        }
+
+        if (summary)
+        {
+            // max |A * A^-1 - I|
+            const double *a = &original[originalAt[s]];
+            double worst = 0.0;
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < n; j++)
+                {
+                    double sum = 0.0;
+                    for (int k = 0; k < n; k++)
+                        sum += a[(size_t)i * n + k] * inv[(size_t)k * n + j];
+                    worst = max(worst, fabs(sum - (i == j ? 1.0 : 0.0)));
+                }
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.3e", worst);
+            fout << "Check: max |A*A^-1 - I| = " << buf << "\n";
+        }
+        fout << "\n";
     }
 
-    fout << fixed << setprecision(2);
+    cout << "Inverted " << inverter.count() << " matrices in " << fixed << setprecision(3) << seconds
+         << " s (" << setprecision(0) << inverter.count() / max(seconds, 1e-9) << " inversions/s, "
+         << pool.size() << " thread" << (pool.size() > 1 ? "s" : "") << ")\n";
+    return 0;
+}
 
-    bool printIntermediate = true; // toggle intermediate steps
+enum class Outcome
+{
+    Unique,
+    NoSolution,
+    Infinite
+};
 
-    int n;
-    while (fin >> n)
+// Print the augmented matrix, for the step-by-step trace
+void printMatrix(io::Writer &log, const mat::Matrix<double> &a)
+{
+    for (int r = 0; r < a.rows(); r++)
     {
-        vector<vector<double>> a(n, vector<double>(n + 1));
-        vector<double> x(n);
+        for (int c = 0; c < a.cols(); c++)
+            log << a[r][c] << "\t";
+        log << "\n";
+    }
+}
+
+/*
+   Reduce [A | b] (n x n+1) to reduced row echelon form in place. The input
+   echo and the step-by-step trace go to log, as the level asks. When none
+   of the reduction is printed, n <= fx::MAX_N goes to the unrolled
+   fixed-size Gauss-Jordan (Common/fixed-size-solvers.h), which only writes
+   the solution column; a pivot below 1e-12 there sends the system through
+   the loop below, which classifies it.
+*/
+Outcome reduce(mat::Matrix<double> &a, io::Writer &log, io::Level level)
+{
+    int n = a.rows();
+    bool printIntermediate = level == io::Level::Full && n <= PRINT_LIMIT; // intermediate steps
 
+    if (!(level >= io::Level::Summary && n <= PRINT_LIMIT) && n <= fx::MAX_N)
+    {
+        PROF_SCOPE("fixed-size");
+        PROF_FLOPS((double)n * n * n);
+        double b[fx::MAX_N], x[fx::MAX_N];
         for (int i = 0; i < n; i++)
-            for (int j = 0; j <= n; j++)
-                fin >> a[i][j];
+            b[i] = a[i][n];
+        if (fx::solveGaussJordan(n, a.data(), a.ld(), b, x))
+        {
+            for (int i = 0; i < n; i++)
+                a[i][n] = x[i];
+            return Outcome::Unique;
+        }
+    }
 
+    if (level >= io::Level::Summary && n <= PRINT_LIMIT)
+    {
         // Print the original system
-        fout << "\nInput system:\n";
+        PROF_SCOPE("echo");
+        log << "\nInput system:\n";
         for (int i = 0; i < n; i++)
         {
             for (int j = 0; j < n; j++)
             {
-                if (j > 0 && a[i][j] >= 0) fout << "+";
-                fout << a[i][j] << "x" << j + 1 << " ";
+                if (j > 0 && a[i][j] >= 0) log << "+";
+                log << a[i][j] << "x" << j + 1 << " ";
             }
-            fout << "= " << a[i][n] << "\n";
+            log << "= " << a[i][n] << "\n";
         }
+    }
 
-        // Gauss-Jordan Elimination
+    // Gauss-Jordan Elimination
+    {
+        PROF_SCOPE("elimination");
         int step = 1;
         for (int i = 0; i < n; i++)
         {
@@ -47,19 +187,15 @@ int main()
             for (int k = i + 1; k < n; k++)
                 if (fabs(a[k][i]) > fabs(a[maxRow][i]))
                     maxRow = k;
-            
+
             if (i != maxRow)
             {
-                swap(a[i], a[maxRow]);
+                a.swapRows(i, maxRow); // swaps row pointers only
+                PROF_SWAPS(1);
                 if (printIntermediate)
                 {
-                    fout << "\nAfter swapping row " << i + 1 << " with row " << maxRow + 1 << ":\n";
-                    for (int r = 0; r < n; r++)
-                    {
-                        for (int c = 0; c <= n; c++)
-                            fout << a[r][c] << "\t";
-                        fout << "\n";
-                    }
+                    log << "\nAfter swapping row " << i + 1 << " with row " << maxRow + 1 << ":\n";
+                    printMatrix(log, a);
                 }
             }
 
@@ -67,106 +203,292 @@ int main()
                 continue;
 
             // Make diagonal element 1 (normalize pivot row)
+            // (an exact divide, not a scale by 1/pivot, so the printed steps keep
+            // their rounding; this is O(n) per step against O(n^2) below)
+            PROF_FLOPS((n - i + 1) * (1.0 + 2.0 * (n - 1)));
+            PROF_BYTES(16.0 * n * (n - i + 1)); // every row read and written
             double pivot = a[i][i];
             for (int j = i; j <= n; j++)
                 a[i][j] /= pivot;
 
             if (printIntermediate)
             {
-                fout << "\nStep " << step++ << " - Making diagonal element a[" << i + 1 << "][" << i + 1 << "] = 1:\n";
-                for (int r = 0; r < n; r++)
-                {
-                    for (int c = 0; c <= n; c++)
-                        fout << a[r][c] << "\t";
-                    fout << "\n";
-                }
+                log << "\nStep " << step++ << " - Making diagonal element a[" << i + 1 << "][" << i + 1 << "] = 1:\n";
+                printMatrix(log, a);
             }
 
             // Eliminate column i in ALL other rows (both above and below)
             for (int k = 0; k < n; k++)
             {
                 if (k != i)
-                {
-                    double factor = a[k][i];
-                    for (int j = i; j <= n; j++)
-                        a[k][j] -= factor * a[i][j];
-                }
+                    simd::rowAxpy(&a[k][i], &a[i][i], -a[k][i], n - i + 1);
             }
 
             // Print intermediate matrix if enabled
             if (printIntermediate)
             {
-                fout << "\nStep " << step++ << " - Eliminating column " << i + 1 << " in all other rows:\n";
-                for (int r = 0; r < n; r++)
-                {
-                    for (int c = 0; c <= n; c++)
-                        fout << a[r][c] << "\t";
-                    fout << "\n";
-                }
+                log << "\nStep " << step++ << " - Eliminating column " << i + 1 << " in all other rows:\n";
+                printMatrix(log, a);
             }
         }
+    }
+
+    // Detect solution type
+    PROF_SCOPE("rank");
+    PROF_BYTES(8.0 * n * (n + 1));
+    int rank = 0;
+    for (int i = 0; i < n; i++)
+    {
+        bool allZero = true;
+        for (int j = 0; j < n; j++)
+            if (fabs(a[i][j]) > 1e-12) allZero = false;
 
-        // Detect solution type
-        bool noSolution = false, infiniteSolution = false;
-        int rank = 0;
+        if (allZero && fabs(a[i][n]) > 1e-12)
+            return Outcome::NoSolution;
+        if (!allZero)
+            rank++;
+    }
+    return rank < n ? Outcome::Infinite : Outcome::Unique;
+}
 
+// The result block of one system; the solution is the last column of the RREF
+void writeResult(io::Writer &fout, Outcome outcome, const mat::Matrix<double> &a, io::Level level)
+{
+    int n = a.rows();
+    if (level >= io::Level::Summary)
+    {
+        fout << "\n========================================\n";
+        fout << "FINAL RESULT:\n";
+        fout << "========================================\n";
+    }
+
+    if (outcome == Outcome::NoSolution)
+    {
+        fout << "\nNo Solution\n";
+        fout << "The system is inconsistent.\n";
+    }
+    else if (outcome == Outcome::Infinite)
+    {
+        fout << "\nInfinite Solutions\n";
+        fout << "The system has dependent equations.\n";
+    }
+    else
+    {
+        fout << "\nUnique Solution\n";
+        if (level >= io::Level::Summary && n <= PRINT_LIMIT)
+        {
+            fout << "\nFinal Reduced Row Echelon Form (RREF):\n";
+            printMatrix(fout, a);
+        }
+
+        fout << "\nSolution:\n";
         for (int i = 0; i < n; i++)
+            fout << "x" << i + 1 << " = " << a[i][n] << "\n";
+    }
+
+    fout << "\n" << string(60, '=') << "\n\n";
+}
+
+// Copy [A | b] of a system into a (n x n+1)
+void loadAugmented(const sysio::System &sys, mat::Matrix<double> &a)
+{
+    int n = sys.n;
+    if (sys.nrhs != 1)
+        throw runtime_error("Gauss-Jordan elimination needs one right-hand side per system");
+    a.assign(n, n + 1);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+            a[i][j] = sys.A(i, j);
+        a[i][n] = sys.B(i, 0);
+    }
+}
+
+/*
+   Stream mode (--stream [--solvers k]): parsing, reduction and output
+   overlap on separate threads (Common/stream-pipeline.h), with memory
+   bounded to a few systems however long the input is. The output is the
+   same text as the default mode, in input order.
+*/
+struct StreamJob
+{
+    mat::Matrix<double> a;
+    io::Writer log; // echo and trace of this system
+    Outcome outcome = Outcome::Unique;
+};
+
+void runStream(const string &inputPath, io::Writer &fout, io::Level level, int solvers)
+{
+    sysio::SystemReader reader(inputPath, 1, false); // streaming: keep no old systems
+    sysio::System sys;
+    stream::Pipeline<StreamJob> pipeline(solvers);
+
+    stream::Stats stats = pipeline.run(
+        [&](StreamJob &job)
         {
-            bool allZero = true;
-            for (int j = 0; j < n; j++)
-                if (fabs(a[i][j]) > 1e-12) allZero = false;
+            PROF_SCOPE("parse");
+            if (!reader.next(sys))
+                return false;
+            PROF_BYTES(8.0 * sys.n * (sys.n + 1));
+            loadAugmented(sys, job.a);
+            return true;
+        },
+        [&](StreamJob &job)
+        {
+            job.log.clear();
+            job.log.precision(fout.precision());
+            job.outcome = reduce(job.a, job.log, level);
+        },
+        [&](StreamJob &job)
+        {
+            if (level == io::Level::Silent)
+                return;
+            PROF_SCOPE("output");
+            fout << job.log.str();
+            writeResult(fout, job.outcome, job.a, level);
+        });
 
-            if (allZero && fabs(a[i][n]) > 1e-12)
+    cout << "Streamed " << stats.jobs << " systems in " << fixed << setprecision(3) << stats.seconds
+         << " s (" << pipeline.solvers() << " solver thread(s), at most " << pipeline.depth()
+         << " systems in memory)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    // Optional: ./gauss-jordan-elimination-method [--inverse [threads]] [--stream [--solvers k]]
+    //                                             [--input file] [--output silent|solution|summary|full]
+    //                                             [--profile file]
+    // (input text or binary, see Common/system-io.h; --profile: per-phase
+    // times and counts of a -DNCS_PROFILE build, see Common/profiler.h)
+    string inputPath = "input.txt";
+    string profilePath = "profile.json";
+    io::Level level = io::Level::Full; // how much to write, see Common/output-writer.h
+    bool inverseMode = false, streamMode = false;
+    int threads = 1, solvers = 1;
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg == "--inverse")
+                inverseMode = true;
+            else if (arg == "--stream")
+                streamMode = true;
+            else if (arg == "--solvers" && i + 1 < argc)
+                solvers = max(1, atoi(argv[++i]));
+            else if (arg == "--input" && i + 1 < argc)
+                inputPath = argv[++i];
+            else if (arg == "--output" && i + 1 < argc)
+                level = io::parseLevel(argv[++i]);
+            else if (arg == "--profile" && i + 1 < argc)
             {
-                noSolution = true;
-                break;
+                profilePath = argv[++i];
+                if (!prof::ENABLED)
+                    cerr << "Note: --profile needs a build with -DNCS_PROFILE\n";
             }
-            if (! allZero)
-                rank++;
+            else if (isdigit((unsigned char)arg[0]))
+                threads = max(1, atoi(argv[i]));
         }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
 
-        if (! noSolution && rank < n)
-            infiniteSolution = true;
+    ifstream probe(inputPath);
+    if (!probe)
+    {
+        cerr << "Error: " << inputPath << " not found!\n";
+        return 1;
+    }
+    probe.close();
 
-        // Write output
-        fout << "\n========================================\n";
-        fout << "FINAL RESULT:\n";
-        fout << "========================================\n";
+    io::Writer fout("output.txt");
+    if (!fout)
+    {
+        cerr << "Error: cannot open output.txt\n";
+        return 1;
+    }
+    fout.precision(2);
+
+    auto writeProfile = [&]()
+    {
+        PROF_REPORT("gauss-jordan-elimination-method", profilePath);
+        if (prof::ENABLED)
+            cout << "Profile written to " << profilePath << "\n";
+    };
 
-        if (noSolution)
+    try
+    {
+        if (inverseMode)
         {
-            fout << "\nNo Solution\n";
-            fout << "The system is inconsistent.\n";
+            int status = runInverse(inputPath, fout, level, threads);
+            fout.close();
+            if (!fout)
+                throw runtime_error("could not write output.txt");
+            if (status == 0)
+            {
+                writeProfile();
+                cout << "All results written to output.txt\n";
+            }
+            return status;
         }
-        else if (infiniteSolution)
+
+        if (streamMode)
         {
-            fout << "\nInfinite Solutions\n";
-            fout << "The system has dependent equations.\n";
+            runStream(inputPath, fout, level, solvers);
+            fout.close();
+            if (!fout)
+                throw runtime_error("could not write output.txt");
+            writeProfile();
+            cout << "All results written to output.txt\n";
+            return 0;
         }
-        else
+
+        sysio::SystemReader reader(inputPath);
+        sysio::System sys;
+
+        // [A | b] is reduced where the reader keeps it (for binary input, in the
+        // copy-on-write pages of the mapped file): no copy is made
+        mat::Matrix<double> a;
+
+        auto next = [&]()
         {
-            fout << "\nUnique Solution\n";
-            fout << "\nFinal Reduced Row Echelon Form (RREF):\n";
-            for (int r = 0; r < n; r++)
-            {
-                for (int c = 0; c <= n; c++)
-                    fout << a[r][c] << "\t";
-                fout << "\n";
-            }
+            PROF_SCOPE("parse");
+            if (!reader.next(sys))
+                return false;
+            PROF_BYTES(8.0 * sys.n * (sys.n + 1));
+            if (sys.augmented && sys.nrhs == 1)
+                a = mat::Matrix<double>::borrow(sys.augmented, sys.n, sys.n + 1);
+            else
+                loadAugmented(sys, a);
+            return true;
+        };
 
-            fout << "\nSolution:\n";
-            for (int i = 0; i < n; i++)
+        while (next())
+        {
+            Outcome outcome = reduce(a, fout, level);
+            if (level > io::Level::Silent)
             {
-                x[i] = a[i][n];
-                fout << "x" << i + 1 << " = " << x[i] << "\n";
+                PROF_SCOPE("output");
+                writeResult(fout, outcome, a, level);
             }
         }
-
-        fout << "\n" << string(60, '=') << "\n\n";
+        writeProfile();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
     }
 
-    fin.close();
-    fout. close();
+    fout.close();
+    if (!fout)
+    {
+        cerr << "Error: could not write output.txt\n";
+        return 1;
+    }
     cout << "All results written to output.txt\n";
     return 0;
 }
\ No newline at end of file
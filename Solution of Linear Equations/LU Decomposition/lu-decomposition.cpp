@@ -1,253 +1,1121 @@
 #include <bits/stdc++.h>
+#include "../../Common/cholesky.h"
+#include "../../Common/determinant.h"
+#include "../../Common/fixed-size-solvers.h"
+#include "../../Common/lu-factor.h"
+#include "../../Common/matrix.h"
+#include "../../Common/mixed-precision-lu.h"
+#include "../../Common/out-of-core-lu.h"
+#include "../../Common/output-writer.h"
+#include "../../Common/profiler.h"
+#include "../../Common/qr-factor.h"
+#include "../../Common/stream-pipeline.h"
+#include "../../Common/system-io.h"
 using namespace std;
 
-int main()
+const int PRINT_LIMIT = 10; // echo systems, factors and steps up to this size
+
+/*
+   Print L and U from the factorization. Only the first `done` columns of L
+   and rows of U are final; the rest are shown as zeros.
+*/
+void printFactors(io::Writer &fout, const lu::LUFactor &F, int done,
+                  const string &lTitle = "L matrix:\n",
+                  const string &uTitle = "U matrix:\n")
+{
+    int n = F.size();
+    fout << lTitle;
+    for (int r = 0; r < n; r++)
+    {
+        for (int c = 0; c < n; c++)
+            fout << io::width(10) << (c < done ? F.L(r, c) : 0.0) << " ";
+        fout << "\n";
+    }
+    fout << uTitle;
+    for (int r = 0; r < n; r++)
+    {
+        for (int c = 0; c < n; c++)
+            fout << io::width(10) << (r < done ? F.U(r, c) : 0.0) << " ";
+        fout << "\n";
+    }
+}
+
+/*
+   Singular case: Gaussian elimination with partial pivoting on [U | y].
+   The system is inconsistent iff some row reduces to 0 = c with c != 0.
+*/
+bool isInconsistent(const lu::LUFactor &F, const vector<double> &y)
 {
-    ifstream fin("input.txt");
-    ofstream fout("output.txt");
+    int n = F.size();
+    vector<double> m((size_t)n * (n + 1), 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = i; j < n; j++)
+            m[i * (n + 1) + j] = F.U(i, j);
+        m[i * (n + 1) + n] = y[i];
+    }
 
-    if (!fin)
+    int row = 0;
+    for (int col = 0; col < n && row < n; col++)
     {
-        cerr << "Error:  input.txt not found!\n";
-        return 1;
+        int best = row;
+        for (int i = row + 1; i < n; i++)
+            if (fabs(m[i * (n + 1) + col]) > fabs(m[best * (n + 1) + col]))
+                best = i;
+        if (fabs(m[best * (n + 1) + col]) < 1e-12)
+            continue;
+        swap_ranges(m.begin() + row * (n + 1), m.begin() + (row + 1) * (n + 1),
+                    m.begin() + best * (n + 1));
+        for (int i = row + 1; i < n; i++)
+        {
+            double factor = m[i * (n + 1) + col] / m[row * (n + 1) + col];
+            for (int j = col; j <= n; j++)
+                m[i * (n + 1) + j] -= factor * m[row * (n + 1) + j];
+        }
+        row++;
     }
 
-    fout << fixed << setprecision(4);
+    // Rows from `row` down have no pivot: all coefficients are ~0
+    for (int i = row; i < n; i++)
+        if (fabs(m[i * (n + 1) + n]) > 1e-12)
+            return true;
+    return false;
+}
+
+// Backward errors and condition numbers in scientific notation (fixed notation would print 0.0000)
+string sci(double v)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3e", v);
+    return buf;
+}
+
+/*
+   det(A) in the fixed format of the other values while it is of moderate
+   size, else in scientific notation from log|det| (a large system's
+   determinant overflows a double long before the solve gets hard)
+*/
+string detText(const det::LogDet &d, int precision)
+{
+    if (d.sign != 0 && fabs(d.log10Abs()) >= 15)
+        return det::scientific(d);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", precision, d.value());
+    return buf;
+}
 
-    bool printIntermediate = true; // toggle intermediate steps
+/*
+   Solve every system of a group that shares the coefficient matrix A.
+   A is factored once; the right-hand sides are solved together as an
+   n x k block with blocked triangular solves.
+*/
+void solveGroup(io::Writer &fout, mat::MatrixView<const double> A,
+                const mat::Matrix<double> &rhs,
+                io::Level level, int blockSize)
+{
+    int n = A.rows;
+    int k = rhs.rows();
+    bool printIntermediate = level == io::Level::Full && n <= PRINT_LIMIT;
+    bool summary = level >= io::Level::Summary;
 
-    int n;
-    while (fin >> n)
+    // Factor once, capturing the step-by-step trace for the first system
+    lu::LUFactor F;
+    io::Writer trace;
+    trace.precision(4);
     {
-        vector<vector<double>> aug(n, vector<double>(n + 1));
-        
-        // Read augmented matrix
+        PROF_SCOPE("factorization");
+        PROF_FLOPS(2.0 * n * n * n / 3);
+        int panelWidth = printIntermediate ? 1 : blockSize;
+        F.factorize(A.ptr, n, (int)A.rowStride, panelWidth,
+            [&](int step, int kb)
+            {
+                if (!printIntermediate)
+                    return;
+                trace << "\nAfter step " << step + 1 << ":\n";
+                if (F.pivots()[step] != step)
+                    trace << "Swapped row " << step + 1 << " with row " << F.pivots()[step] + 1 << "\n";
+                printFactors(trace, F, step + kb);
+                trace << "---------------------------------------------\n";
+            });
         for (int i = 0; i < n; i++)
-            for (int j = 0; j <= n; j++)
-                fin >> aug[i][j];
+            if (F.pivots()[i] != i)
+                PROF_SWAPS(1);
+    }
+
+    double detU = F.detU();
+    bool singular = F.singular() || fabs(detU) < 1e-12;
+    double conditionNumber = 0.0;
+    if (!singular && summary)
+    {
+        PROF_SCOPE("condition");
+        conditionNumber = F.conditionEstimate(cond::norm1(A.ptr, n, (int)A.rowStride));
+    }
 
-        // Print the original system
-        fout << "\n========================================\n";
-        fout << "Input system:\n";
+    // Right-hand sides as the columns of an n x k block: B := P * B, Y = L^-1 * B
+    mat::Matrix<double> Y(n, k), X;
+    {
+        PROF_SCOPE("substitution");
+        PROF_FLOPS(2.0 * n * n * k);
+        auto B = rhs.transposed(); // n x k view of the k stored rows
         for (int i = 0; i < n; i++)
+            for (int s = 0; s < k; s++)
+                Y[i][s] = B(i, s);
+        F.permute(Y.data(), k, Y.ld());
+        F.solveLower(Y.data(), k, Y.ld());
+
+        // X = U^-1 * Y (only defined when U is non-singular)
+        if (!singular)
+        {
+            X = Y;
+            F.solveUpper(X.data(), k, X.ld());
+        }
+    }
+
+    PROF_SCOPE("output");
+    for (int s = 0; s < k && level > io::Level::Silent; s++)
+    {
+        const double *b = rhs[s];
+
+        if (summary)
         {
-            for (int j = 0; j < n; j++)
+            // Print the original system
+            PROF_SCOPE("echo");
+            fout << "\n========================================\n";
+            if (n <= PRINT_LIMIT)
             {
-                if (j > 0 && aug[i][j] >= 0) fout << "+";
-                fout << aug[i][j] << "x" << j + 1 << " ";
+                fout << "Input system:\n";
+                for (int i = 0; i < n; i++)
+                {
+                    for (int j = 0; j < n; j++)
+                    {
+                        double a = A(i, j);
+                        if (j > 0 && a >= 0) fout << "+";
+                        fout << a << "x" << j + 1 << " ";
+                    }
+                    fout << "= " << b[i] << "\n";
+                }
+            }
+            else
+                fout << "Input system: n = " << n << "\n";
+            fout << "========================================\n";
+
+            if (s == 0)
+            {
+                fout << "\nPerforming LU Decomposition...\n";
+                fout << trace.str();
             }
-            fout << "= " << aug[i][n] << "\n";
+            else
+                fout << "\nReusing LU Decomposition of the previous system (same coefficient matrix)\n";
         }
-        fout << "========================================\n";
 
-        // Separate A and b from augmented matrix
-        vector<vector<double>> A(n, vector<double>(n));
-        vector<double> b(n);
+        vector<double> y(n);
         for (int i = 0; i < n; i++)
-        {
-            for (int j = 0; j < n; j++)
-                A[i][j] = aug[i][j];
-            b[i] = aug[i][n];
-        }
+            y[i] = Y[i][s];
 
-        // Initialize L and U matrices
-        vector<vector<double>> L(n, vector<double>(n, 0));
-        vector<vector<double>> U(n, vector<double>(n, 0));
+        // Detect solution type
+        bool noSolution = false;
+        bool infiniteSolution = false;
 
-        fout << "\nPerforming LU Decomposition...\n";
+        if (singular)
+        {
+            // Matrix is singular - reduce [U | L^-1 P b] to echelon form
+            // and look for a 0 = c row to tell no solution from infinite
+            PROF_SCOPE("rank");
+            if (isInconsistent(F, y))
+                noSolution = true;
+            else
+                infiniteSolution = true;
+        }
 
-        bool decompositionFailed = false;
-        int failedAtStep = -1;
+        // Output results
+        if (summary)
+        {
+            fout << "\n========================================\n";
+            fout << "FINAL RESULT:\n";
+            fout << "========================================\n";
+        }
 
-        // LU Decomposition using Doolittle's method
-        for (int i = 0; i < n; i++)
+        if (noSolution)
+        {
+            fout << "\nNo Solution\n";
+            fout << "The system is inconsistent.\n";
+            if (summary)
+                fout << "Determinant of U = " << detU << " (approximately 0)\n";
+        }
+        else if (infiniteSolution)
+        {
+            fout << "\nInfinite Solutions\n";
+            fout << "The system has dependent equations.\n";
+            if (summary)
+                fout << "Determinant of U = " << detU << " (approximately 0)\n";
+        }
+        else
         {
-            // Upper Triangular Matrix U
-            for (int k = i; k < n; k++)
+            fout << "\nUnique Solution\n";
+            if (summary)
             {
-                double sum = 0;
-                for (int j = 0; j < i; j++)
-                    sum += L[i][j] * U[j][k];
-                U[i][k] = A[i][k] - sum;
-            }
+                det::LogDet detA = det::fromFactors(F), logU = detA;
+                logU.sign *= lu::pivotSign(F.pivots()); // det(U) = sign(P) * det(A)
+                fout << "Determinant of U = " << detText(logU, fout.precision()) << "\n";
+                fout << "Determinant of A = " << detText(detA, fout.precision()) << "\n";
+                fout << "Condition number (1-norm, estimated) = " << sci(conditionNumber) << "\n\n";
 
-            // Check for zero pivot
-            if (fabs(U[i][i]) < 1e-12)
-            {
-                decompositionFailed = true;
-                failedAtStep = i;
-                break;
+                // Print final L and U matrices
+                if (n <= PRINT_LIMIT)
+                    printFactors(fout, F, n, "Final L matrix (Lower Triangular):\n",
+                                 "\nFinal U matrix (Upper Triangular):\n");
+
+                fout << "\nRow order (P*A = L*U): ";
+                vector<int> order(n);
+                iota(order.begin(), order.end(), 0);
+                for (int i = 0; i < n; i++)
+                    swap(order[i], order[F.pivots()[i]]);
+                for (int i = 0; i < n; i++)
+                    fout << order[i] + 1 << (i + 1 < n ? " " : "\n");
+
+                // Forward substitution to solve L*y = P*b
+                fout << "\n--- Forward Substitution (L*y = P*b) ---\n";
+                for (int i = 0; i < n; i++)
+                    fout << "y" << i + 1 << " = " << y[i] << "\n";
             }
 
-            // Lower Triangular Matrix L
-            for (int k = i; k < n; k++)
+            // Back substitution to solve U*x = y
+            vector<double> x(n);
+            for (int i = 0; i < n; i++)
+                x[i] = X[i][s];
+            if (summary)
+                fout << "\n--- Back Substitution (U*x = y) ---\n";
+
+            fout << "\nSolution Vector (x):\n";
+            for (int i = 0; i < n; i++)
+                fout << "x" << i + 1 << " = " << x[i] << "\n";
+
+            // Verification: compute A*x and compare with b
+            if (summary)
             {
-                if (i == k)
-                    L[i][i] = 1; // diagonal element is 1
-                else
+                fout << "\n--- Verification (A*x = b) ---\n";
+                vector<double> result(n);
+                for (int i = 0; i < n; i++)
                 {
-                    double sum = 0;
-                    for (int j = 0; j < i; j++)
-                        sum += L[k][j] * U[j][i];
-                    L[k][i] = (A[k][i] - sum) / U[i][i];
+                    result[i] = 0;
+                    for (int j = 0; j < n; j++)
+                        result[i] += A(i, j) * x[j];
+                    fout << "Row " << i + 1 << ": " << result[i]
+                         << " (expected: " << b[i] << ")\n";
                 }
             }
+        }
 
-            // Print intermediate matrices if enabled
-            if (printIntermediate)
+        fout << "\n" << string(60, '=') << "\n\n";
+    }
+}
+
+/*
+   Symmetric A (detected automatically): Cholesky A = L*L^T on the packed
+   lower triangle (see Common/cholesky.h); half the flops and memory of LU.
+   Returns false, without writing anything, if A is not positive definite,
+   so that solveGroup() solves and classifies the system with the pivoted
+   LU.
+*/
+bool solveGroupSymmetric(io::Writer &fout, mat::MatrixView<const double> A,
+                         const mat::Matrix<double> &rhs,
+                         io::Level level, int blockSize)
+{
+    int n = A.rows;
+    int k = rhs.rows();
+    bool summary = level >= io::Level::Summary;
+
+    chol::SymmetricFactor F;
+    {
+        PROF_SCOPE("factorization");
+        PROF_FLOPS((double)n * n * n / 3);
+        F.factorize(A.ptr, n, (int)A.rowStride, blockSize);
+    }
+    if (F.method() == chol::Method::LU)
+        return false;
+
+    // Right-hand sides as the columns of an n x k block: Y = L^-1 * B
+    mat::Matrix<double> Y(n, k), X;
+    {
+        PROF_SCOPE("substitution");
+        PROF_FLOPS(2.0 * n * n * k);
+        auto B = rhs.transposed();
+        for (int i = 0; i < n; i++)
+            for (int s = 0; s < k; s++)
+                Y[i][s] = B(i, s);
+        F.solveLower(Y.data(), k, Y.ld());
+
+        // X = L^-T * Y
+        X = Y;
+        F.solveUpper(X.data(), k, X.ld());
+    }
+
+    // A is symmetric, so the same solve serves for A^-1 and A^-T
+    double conditionNumber = 0.0;
+    if (summary)
+    {
+        PROF_SCOPE("condition");
+        auto solve = [&](double *x) { F.solve(x, 1, 1); };
+        conditionNumber = cond::norm1(A.ptr, n, (int)A.rowStride) * cond::inverseNorm1(n, solve, solve);
+    }
+
+    PROF_SCOPE("output");
+    for (int s = 0; s < k && level > io::Level::Silent; s++)
+    {
+        const double *b = rhs[s];
+
+        if (summary)
+        {
+            fout << "\n========================================\n";
+            if (n <= PRINT_LIMIT)
             {
-                fout << "\nAfter step " << i + 1 << ":\n";
-                fout << "L matrix:\n";
-                for (int r = 0; r < n; r++)
+                fout << "Input system:\n";
+                for (int i = 0; i < n; i++)
                 {
-                    for (int c = 0; c < n; c++)
-                        fout << setw(10) << L[r][c] << " ";
-                    fout << "\n";
+                    for (int j = 0; j < n; j++)
+                    {
+                        double a = A(i, j);
+                        if (j > 0 && a >= 0) fout << "+";
+                        fout << a << "x" << j + 1 << " ";
+                    }
+                    fout << "= " << b[i] << "\n";
                 }
-                fout << "U matrix:\n";
+            }
+            else
+                fout << "Input system: n = " << n << "\n";
+            fout << "========================================\n";
+
+            if (s == 0)
+            {
+                fout << "\nSymmetric coefficient matrix: " << chol::methodName(F.method()) << "\n";
+                fout << "Performing Cholesky Decomposition...\n";
+            }
+            else
+                fout << "\nReusing Cholesky Decomposition of the previous system (same coefficient matrix)\n";
+
+            fout << "\n========================================\n";
+            fout << "FINAL RESULT:\n";
+            fout << "========================================\n";
+        }
+
+        fout << "\nUnique Solution\n";
+        if (summary)
+        {
+            fout << "Determinant of A = " << detText(F.logDeterminant(), fout.precision()) << "\n";
+            fout << "Condition number (1-norm, estimated) = " << sci(conditionNumber) << "\n\n";
+
+            if (n <= PRINT_LIMIT)
+            {
+                fout << "Final L matrix (Lower Triangular):\n";
                 for (int r = 0; r < n; r++)
                 {
                     for (int c = 0; c < n; c++)
-                        fout << setw(10) << U[r][c] << " ";
+                        fout << io::width(10) << F.L(r, c) << " ";
                     fout << "\n";
                 }
-                fout << "---------------------------------------------\n";
             }
+
+            fout << "\n--- Forward Substitution (L*y = b) ---\n";
+            for (int i = 0; i < n; i++)
+                fout << "y" << i + 1 << " = " << Y[i][s] << "\n";
+            fout << "\n--- Back Substitution (L^T*x = y) ---\n";
         }
 
-        // Calculate determinant (product of diagonal of U)
-        double detU = 1;
+        fout << "\nSolution Vector (x):\n";
         for (int i = 0; i < n; i++)
-            detU *= U[i][i];
-
-        // Detect solution type
-        bool noSolution = false;
-        bool infiniteSolution = false;
+            fout << "x" << i + 1 << " = " << X[i][s] << "\n";
 
-        if (decompositionFailed || fabs(detU) < 1e-12)
+        // Verification: compute A*x and compare with b
+        if (summary)
         {
-            // Matrix is singular - check for no solution vs infinite solutions
-            // Continue decomposition as much as possible to check consistency
-            
-            // Perform forward substitution to check consistency
-            vector<double> y(n, 0);
+            fout << "\n--- Verification (A*x = b) ---\n";
             for (int i = 0; i < n; i++)
             {
-                double sum = 0;
-                for (int j = 0; j < i; j++)
-                    sum += L[i][j] * y[j];
-                
-                double expectedY = b[i] - sum;
-                
-                // Check if this row is all zeros in U
-                bool rowIsZero = true;
-                for (int j = i; j < n; j++)
+                double result = 0;
+                for (int j = 0; j < n; j++)
+                    result += A(i, j) * X[j][s];
+                fout << "Row " << i + 1 << ": " << result
+                     << " (expected: " << b[i] << ")\n";
+            }
+        }
+
+        fout << "\n" << string(60, '=') << "\n\n";
+    }
+    return true;
+}
+
+/*
+   --mixed: factor A once in float and refine every solution in double (see
+   Common/mixed-precision-lu.h). Returns false, without writing anything, if
+   the group has to go through solveGroup() instead: the float factorization
+   is unusable, or refinement fell back to a double factorization that is
+   (nearly) singular, so the solution type must be classified.
+*/
+bool solveGroupMixed(io::Writer &fout, mat::MatrixView<const double> A,
+                     const mat::Matrix<double> &rhs,
+                     io::Level level, int blockSize)
+{
+    int n = A.rows;
+    int k = rhs.rows();
+    bool summary = level >= io::Level::Summary;
+
+    PROF_FLOPS(2.0 * n * n * n / 3); // the float factorization, in the enclosing "solve"
+    lu::MixedLU M(A.ptr, n, (int)A.rowStride, blockSize);
+    if (!M.floatUsable())
+        return false;
+
+    mat::Matrix<double> X(k, n);
+    vector<lu::RefinementResult> results(k);
+    {
+        PROF_SCOPE("refinement");
+        for (int s = 0; s < k; s++)
+        {
+            results[s] = M.solve(rhs[s], X[s]);
+            if (results[s].fellBack &&
+                (M.doubleFactor().singular() || fabs(M.doubleFactor().detU()) < 1e-12))
+                return false;
+        }
+    }
+
+    PROF_SCOPE("output");
+    for (int s = 0; s < k && level > io::Level::Silent; s++)
+    {
+        const double *b = rhs[s];
+        const double *x = X[s];
+        const lu::RefinementResult &res = results[s];
+
+        if (summary)
+        {
+            fout << "\n========================================\n";
+            if (n <= PRINT_LIMIT)
+            {
+                fout << "Input system:\n";
+                for (int i = 0; i < n; i++)
                 {
-                    if (fabs(U[i][j]) > 1e-12)
+                    for (int j = 0; j < n; j++)
                     {
-                        rowIsZero = false;
-                        break;
+                        double a = A(i, j);
+                        if (j > 0 && a >= 0) fout << "+";
+                        fout << a << "x" << j + 1 << " ";
                     }
+                    fout << "= " << b[i] << "\n";
                 }
-                
-                if (rowIsZero && fabs(expectedY) > 1e-12)
+            }
+            else
+                fout << "Input system: n = " << n << "\n";
+            fout << "========================================\n";
+
+            if (s == 0)
+                fout << "\nPerforming LU Decomposition in float (mixed precision)...\n";
+            else
+                fout << "\nReusing LU Decomposition of the previous system (same coefficient matrix)\n";
+
+            fout << "\n--- Iterative Refinement (residual in double) ---\n";
+            for (size_t it = 0; it < res.backwardError.size(); it++)
+                fout << (it == 0 ? "Float solve" : "Refinement " + to_string(it))
+                     << ": backward error = " << sci(res.backwardError[it]) << "\n";
+
+            fout << "\n========================================\n";
+            fout << "FINAL RESULT:\n";
+            fout << "========================================\n";
+        }
+
+        fout << "\nUnique Solution\n";
+        if (res.fellBack)
+            fout << "Refinement stalled: solved with a double LU Decomposition\n";
+        else
+            fout << "Refinement converged after " << res.iterations << " iteration(s)\n";
+
+        fout << "\nSolution Vector (x):\n";
+        for (int i = 0; i < n; i++)
+            fout << "x" << i + 1 << " = " << x[i] << "\n";
+
+        // Verification: compute A*x and compare with b
+        if (summary)
+        {
+            fout << "\n--- Verification (A*x = b) ---\n";
+            for (int i = 0; i < n; i++)
+            {
+                double result = 0;
+                for (int j = 0; j < n; j++)
+                    result += A(i, j) * x[j];
+                fout << "Row " << i + 1 << ": " << result
+                     << " (expected: " << b[i] << ")\n";
+            }
+        }
+
+        fout << "\n" << string(60, '=') << "\n\n";
+    }
+    return true;
+}
+
+/*
+   --qr: rank-revealing QR with column pivoting (see Common/qr-factor.h)
+   instead of LU. The numerical rank comes from a tolerance relative to the
+   largest diagonal entry of R, so badly scaled systems are classified the
+   same as well scaled ones; every system gets its rank, a condition
+   estimate and a least-squares solution in one pass.
+*/
+void solveGroupQR(io::Writer &fout, mat::MatrixView<const double> A,
+                  const mat::Matrix<double> &rhs, io::Level level)
+{
+    int n = A.rows;
+    int k = rhs.rows();
+    bool summary = level >= io::Level::Summary;
+
+    qr::QRFactor F;
+    {
+        PROF_SCOPE("factorization");
+        PROF_FLOPS(4.0 * n * n * n / 3);
+        F.factorize(A.ptr, n, n, (int)A.rowStride);
+    }
+    double tolerance = F.defaultTolerance();
+    int rank = F.rank(tolerance);
+    double conditionNumber = summary ? F.conditionEstimate(rank) : 0.0;
+
+    PROF_SCOPE("output"); // includes the least-squares solves
+    vector<double> x(n);
+    for (int s = 0; s < k && level > io::Level::Silent; s++)
+    {
+        const double *b = rhs[s];
+        double residual = F.solve(b, x.data(), rank);
+
+        // Consistent if the residual is at the rounding level of A*x and b
+        double xNorm = 0.0, bNorm = 0.0;
+        for (int i = 0; i < n; i++)
+        {
+            xNorm += x[i] * x[i];
+            bNorm += b[i] * b[i];
+        }
+        double scale = rank ? fabs(F.R(0, 0)) * sqrt(xNorm) : 0.0;
+        bool consistent = residual <= tolerance * (scale + sqrt(bNorm));
+
+        if (summary)
+        {
+            fout << "\n========================================\n";
+            if (n <= PRINT_LIMIT)
+            {
+                fout << "Input system:\n";
+                for (int i = 0; i < n; i++)
                 {
-                    noSolution = true;
-                    break;
+                    for (int j = 0; j < n; j++)
+                    {
+                        double a = A(i, j);
+                        if (j > 0 && a >= 0) fout << "+";
+                        fout << a << "x" << j + 1 << " ";
+                    }
+                    fout << "= " << b[i] << "\n";
                 }
-                
-                if (!rowIsZero && fabs(U[i][i]) > 1e-12)
-                    y[i] = expectedY;
             }
+            else
+                fout << "Input system: n = " << n << "\n";
+            fout << "========================================\n";
 
-            if (! noSolution)
-                infiniteSolution = true;
-        }
+            if (s == 0)
+                fout << "\nPerforming QR Decomposition with column pivoting (A*P = Q*R)...\n";
+            else
+                fout << "\nReusing QR Decomposition of the previous system (same coefficient matrix)\n";
 
-        // Output results
-        fout << "\n========================================\n";
-        fout << "FINAL RESULT:\n";
-        fout << "========================================\n";
+            fout << "Numerical rank = " << rank << " of " << n
+                 << " (|R(k,k)| > " << sci(tolerance) << " * |R(1,1)|)\n";
+            if (n <= PRINT_LIMIT)
+            {
+                fout << "|R(k,k)|:";
+                for (int i = 0; i < n; i++)
+                    fout << " " << sci(fabs(F.R(i, i)));
+                fout << "\nColumn order (A*P): ";
+                for (int j = 0; j < n; j++)
+                    fout << F.perm()[j] + 1 << (j + 1 < n ? " " : "\n");
+            }
+            fout << "Condition number of R11 (1-norm, estimated) = " << sci(conditionNumber) << "\n";
 
-        if (noSolution)
+            fout << "\n========================================\n";
+            fout << "FINAL RESULT:\n";
+            fout << "========================================\n";
+        }
+
+        if (rank == n)
         {
-            fout << "\nNo Solution\n";
-            fout << "The system is inconsistent.\n";
-            fout << "Determinant of U = " << detU << " (approximately 0)\n";
+            fout << "\nUnique Solution\n";
+            fout << "\nSolution Vector (x):\n";
         }
-        else if (infiniteSolution)
+        else if (consistent)
         {
             fout << "\nInfinite Solutions\n";
             fout << "The system has dependent equations.\n";
-            fout << "Determinant of U = " << detU << " (approximately 0)\n";
+            fout << "\nBasic solution (" << n - rank << " free variable(s) set to 0):\n";
         }
         else
         {
-            fout << "\nUnique Solution\n";
-            fout << "Determinant of U = " << detU << "\n\n";
+            fout << "\nNo Solution\n";
+            fout << "The system is inconsistent.\n";
+            fout << "\nLeast-squares solution (basic):\n";
+        }
+        for (int i = 0; i < n; i++)
+            fout << "x" << i + 1 << " = " << x[i] << "\n";
+        if (summary || !consistent)
+            fout << "Residual ||b - A*x|| = " << sci(residual) << "\n";
+
+        fout << "\n" << string(60, '=') << "\n\n";
+    }
+}
+
+/*
+   Small A (n <= fx::MAX_N) when only the solutions are written: the
+   unrolled fixed-size LU of Common/fixed-size-solvers.h, on the stack, once
+   per right-hand side (at these sizes refactoring costs less than the heap
+   factor object). Returns false, without writing anything, when A is
+   singular by the test of solveGroup(), which then classifies the system.
+*/
+bool solveGroupSmall(io::Writer &fout, mat::MatrixView<const double> A,
+                     const mat::Matrix<double> &rhs, io::Level level)
+{
+    int n = A.rows;
+    int k = rhs.rows();
+    if (n > fx::MAX_N || level >= io::Level::Summary)
+        return false;
+
+    mat::Matrix<double> X(k, n);
+    {
+        PROF_SCOPE("fixed-size");
+        PROF_FLOPS((2.0 * n * n * n / 3 + 2.0 * n * n) * k);
+        for (int s = 0; s < k; s++)
+        {
+            double det = 0.0;
+            if (!fx::solve(n, A.ptr, (int)A.rowStride, rhs[s], X[s], &det) || fabs(det) < 1e-12)
+                return false;
+        }
+    }
+
+    PROF_SCOPE("output");
+    for (int s = 0; s < k && level > io::Level::Silent; s++)
+    {
+        fout << "\nUnique Solution\n";
+        fout << "\nSolution Vector (x):\n";
+        for (int i = 0; i < n; i++)
+            fout << "x" << i + 1 << " = " << X[s][i] << "\n";
+        fout << "\n" << string(60, '=') << "\n\n";
+    }
+    return true;
+}
+
+// Same n x n contents
+bool sameMatrix(mat::MatrixView<const double> A, mat::MatrixView<const double> B)
+{
+    if (A.rows != B.rows || A.cols != B.cols)
+        return false;
+    for (int i = 0; i < A.rows; i++)
+        for (int j = 0; j < A.cols; j++)
+            if (A(i, j) != B(i, j))
+                return false;
+    return true;
+}
+
+// Which solver handles a group: QR or mixed precision if asked, the
+// fixed-size LU for a small A when only solutions are written, Cholesky
+// when A is symmetric positive definite, else pivoted LU
+struct SolverOptions
+{
+    int blockSize = lu::DEFAULT_BLOCK_SIZE; // panel width of the blocked factorization
+    bool mixed = false;                     // float factorization + iterative refinement
+    bool general = false;                   // skip the symmetric (Cholesky) path
+    bool qr = false;                        // rank-revealing QR instead of all of the above
+};
+
+void solveAny(io::Writer &fout, mat::MatrixView<const double> A, const mat::Matrix<double> &rhs,
+              io::Level level, const SolverOptions &opt)
+{
+    PROF_SCOPE("solve");
+    if (opt.qr)
+        return solveGroupQR(fout, A, rhs, level);
+    if (opt.mixed && solveGroupMixed(fout, A, rhs, level, opt.blockSize))
+        return;
+    if (solveGroupSmall(fout, A, rhs, level))
+        return;
+    if (!opt.general && chol::isSymmetric(A.ptr, A.rows, (int)A.rowStride) &&
+        solveGroupSymmetric(fout, A, rhs, level, opt.blockSize))
+        return;
+    solveGroup(fout, A, rhs, level, opt.blockSize);
+}
+
+/*
+   Stream mode (--stream [--solvers k]): parsing, factorization and output
+   overlap on separate threads (Common/stream-pipeline.h), with memory
+   bounded to a few groups however long the input is. The parser keeps one
+   system of lookahead to end a group of consecutive systems with the same A,
+   so the groups, and the output text, are exactly those of the default mode.
+*/
+struct StreamJob
+{
+    mat::Matrix<double> A;
+    mat::Matrix<double> rhs; // one right-hand side per row
+    io::Writer text;         // everything this group prints
+};
+
+void runStream(const string &inputPath, io::Writer &fout, io::Level level,
+               const SolverOptions &opt, int solvers)
+{
+    sysio::SystemReader reader(inputPath, 1, false); // streaming: keep no old systems
+    sysio::System sys;
+    bool pending = false; // sys was read but belongs to the next group
+    vector<double> b;
+
+    auto appendRhs = [&](StreamJob &job)
+    {
+        b.resize(sys.n);
+        for (int s = 0; s < sys.nrhs; s++)
+        {
+            for (int i = 0; i < sys.n; i++)
+                b[i] = sys.B(i, s);
+            job.rhs.appendRow(b);
+        }
+    };
+
+    stream::Pipeline<StreamJob> pipeline(solvers);
+    stream::Stats stats = pipeline.run(
+        [&](StreamJob &job)
+        {
+            PROF_SCOPE("parse");
+            if (!pending && !reader.next(sys))
+                return false;
+            pending = false;
+            job.A.assign(sys.n, sys.n);
+            for (int i = 0; i < sys.n; i++)
+                for (int j = 0; j < sys.n; j++)
+                    job.A[i][j] = sys.A(i, j);
+            job.rhs.assign(0, 0);
+            appendRhs(job);
+            while (reader.next(sys))
+            {
+                if (!sameMatrix(sys.A, job.A.view()))
+                {
+                    pending = true;
+                    break;
+                }
+                appendRhs(job);
+            }
+            return true;
+        },
+        [&](StreamJob &job)
+        {
+            job.text.clear();
+            job.text.precision(fout.precision());
+            solveAny(job.text, job.A.view(), job.rhs, level, opt);
+        },
+        [&](StreamJob &job)
+        {
+            PROF_SCOPE("output");
+            fout << job.text.str();
+        });
+
+    cout << "Streamed " << stats.jobs << " groups in " << fixed << setprecision(3) << stats.seconds
+         << " s (" << pipeline.solvers() << " solver thread(s), at most " << pipeline.depth()
+         << " groups in memory)\n";
+}
+
+/*
+   Out-of-core mode (--out-of-core [--memory MB] [--scratch dir]): each
+   system's A is copied into a tile file and factored panel by panel with
+   at most `MB` megabytes of panel buffers (Common/out-of-core-lu.h), so n
+   is limited by the disk, not by RAM. Binary input is streamed from the
+   mapping and never held in memory (text input is parsed into memory
+   first). The classification and the solution are printed as by
+   solveGroup(); the summary level leaves out the factors and the condition
+   estimate, which would need A in memory or extra passes over the file.
+*/
+void runOutOfCore(const string &inputPath, io::Writer &fout, io::Level level,
+                  const string &scratchDir, size_t memoryBytes)
+{
+    sysio::SystemReader reader(inputPath, 1, false);
+    sysio::System sys;
+    bool summary = level >= io::Level::Summary;
+    int count = 0;
+    double factorSeconds = 0.0, waitSeconds = 0.0;
+    uint64_t bytes = 0;
+
+    while (reader.next(sys))
+    {
+        int n = sys.n, k = sys.nrhs;
+        ooc::OutOfCoreLU F(scratchDir, memoryBytes);
+        {
+            PROF_SCOPE("tile load");
+            PROF_BYTES(8.0 * n * n);
+            F.load(n, [&](int i) { return &sys.A(i, 0); });
+        }
+        {
+            PROF_SCOPE("factorization");
+            PROF_FLOPS(2.0 * n * n * n / 3);
+            F.factorize();
+            PROF_BYTES((double)F.bytesRead() + F.bytesWritten());
+        }
+        count++;
+        factorSeconds += F.seconds();
+        waitSeconds += F.ioWaitSeconds();
+        bytes += F.bytesRead() + F.bytesWritten();
+
+        double detU = F.detU();
+        bool singular = F.singular() || fabs(detU) < 1e-12;
 
-            // Print final L and U matrices
-            fout << "Final L matrix (Lower Triangular):\n";
-            for (int r = 0; r < n; r++)
+        // Y = L^-1 P B, X = U^-1 Y
+        mat::Matrix<double> Y(n, k), X;
+        {
+            PROF_SCOPE("substitution");
+            PROF_FLOPS(2.0 * n * n * k);
+            for (int i = 0; i < n; i++)
+                for (int s = 0; s < k; s++)
+                    Y[i][s] = sys.B(i, s);
+            F.solveLower(Y.data(), k, Y.ld());
+            if (!singular)
             {
-                for (int c = 0; c < n; c++)
-                    fout << setw(10) << L[r][c] << " ";
-                fout << "\n";
+                X = Y;
+                F.solveUpper(X.data(), k, X.ld());
             }
+        }
 
-            fout << "\nFinal U matrix (Upper Triangular):\n";
-            for (int r = 0; r < n; r++)
+        PROF_SCOPE("output");
+
+        for (int s = 0; s < k && level > io::Level::Silent; s++)
+        {
+            if (summary)
             {
-                for (int c = 0; c < n; c++)
-                    fout << setw(10) << U[r][c] << " ";
-                fout << "\n";
+                fout << "\n========================================\n";
+                if (n <= PRINT_LIMIT)
+                {
+                    fout << "Input system:\n";
+                    for (int i = 0; i < n; i++)
+                    {
+                        for (int j = 0; j < n; j++)
+                        {
+                            double a = sys.A(i, j);
+                            if (j > 0 && a >= 0) fout << "+";
+                            fout << a << "x" << j + 1 << " ";
+                        }
+                        fout << "= " << sys.B(i, s) << "\n";
+                    }
+                }
+                else
+                    fout << "Input system: n = " << n << "\n";
+                fout << "========================================\n";
+                if (s == 0)
+                    fout << "\nPerforming out-of-core LU Decomposition (" << F.panels() << " panels of "
+                         << F.tileSize() << " columns)...\n";
+                else
+                    fout << "\nReusing LU Decomposition of the previous system (same coefficient matrix)\n";
+                fout << "\n========================================\n";
+                fout << "FINAL RESULT:\n";
+                fout << "========================================\n";
             }
 
-            // Forward substitution to solve L*y = b
             vector<double> y(n);
-            fout << "\n--- Forward Substitution (L*y = b) ---\n";
             for (int i = 0; i < n; i++)
+                y[i] = Y[i][s];
+
+            if (singular)
             {
-                double sum = 0;
-                for (int j = 0; j < i; j++)
-                    sum += L[i][j] * y[j];
-                y[i] = b[i] - sum;
-                fout << "y" << i + 1 << " = " << y[i] << "\n";
+                PROF_SCOPE("rank");
+                if (F.inconsistent(y.data()))
+                    fout << "\nNo Solution\nThe system is inconsistent.\n";
+                else
+                    fout << "\nInfinite Solutions\nThe system has dependent equations.\n";
+                if (summary)
+                    fout << "Determinant of U = " << detU << " (approximately 0)\n";
             }
-
-            // Back substitution to solve U*x = y
-            vector<double> x(n);
-            fout << "\n--- Back Substitution (U*x = y) ---\n";
-            for (int i = n - 1; i >= 0; i--)
+            else
             {
-                double sum = 0;
-                for (int j = i + 1; j < n; j++)
-                    sum += U[i][j] * x[j];
-                x[i] = (y[i] - sum) / U[i][i];
+                fout << "\nUnique Solution\n";
+                if (summary)
+                {
+                    det::LogDet detA = F.logDeterminant(), logU = detA;
+                    logU.sign *= lu::pivotSign(F.pivots());
+                    fout << "Determinant of U = " << detText(logU, fout.precision()) << "\n";
+                    fout << "Determinant of A = " << detText(detA, fout.precision()) << "\n";
+                    fout << "\n--- Back Substitution (U*x = y) ---\n";
+                }
+                fout << "\nSolution Vector (x):\n";
+                for (int i = 0; i < n; i++)
+                    fout << "x" << i + 1 << " = " << X[i][s] << "\n";
+
+                // Residual from A read once more, a row at a time
+                if (summary)
+                {
+                    double worst = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        double r = -sys.B(i, s);
+                        for (int j = 0; j < n; j++)
+                            r += sys.A(i, j) * X[j][s];
+                        worst = max(worst, fabs(r));
+                    }
+                    fout << "\n--- Verification (A*x = b) ---\n";
+                    fout << "Largest residual |A*x - b| = " << sci(worst) << "\n";
+                }
             }
+            fout << "\n" << string(60, '=') << "\n\n";
+        }
+    }
 
-            fout << "\nSolution Vector (x):\n";
-            for (int i = 0; i < n; i++)
-                fout << "x" << i + 1 << " = " << x[i] << "\n";
+    cout << "Factored " << count << " system(s) out of core in " << fixed << setprecision(3)
+         << factorSeconds << " s (" << memoryBytes / (1 << 20) << " MB of panel buffers, "
+         << setprecision(2) << bytes / 1e9 << " GB of tile I/O, " << setprecision(3)
+         << waitSeconds << " s waiting for the disk)\n";
+}
 
-            // Verification: compute A*x and compare with b
-            fout << "\n--- Verification (A*x = b) ---\n";
-            vector<double> result(n);
-            for (int i = 0; i < n; i++)
+int main(int argc, char *argv[])
+{
+    // Optional: ./lu-decomposition [blockSize] [--input file] [--mixed] [--general] [--qr]
+    //                              [--stream [--solvers k]] [--output silent|solution|summary|full]
+    //                              [--out-of-core [--memory MB] [--scratch dir]] [--profile file]
+    // (input text or binary, see Common/system-io.h; --profile: per-phase
+    // times and counts of a -DNCS_PROFILE build, see Common/profiler.h)
+    SolverOptions opt;
+    string inputPath = "input.txt";
+    io::Level level = io::Level::Full; // how much to write, see Common/output-writer.h
+    bool streamMode = false;
+    int solvers = 1;
+    bool outOfCore = false;
+    size_t memoryBytes = ooc::DEFAULT_MEMORY;
+    string scratchDir = ".";
+    string profilePath = "profile.json";
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg == "--input" && i + 1 < argc)
+                inputPath = argv[++i];
+            else if (arg == "--mixed")
+                opt.mixed = true;
+            else if (arg == "--general")
+                opt.general = true;
+            else if (arg == "--qr")
+                opt.qr = true;
+            else if (arg == "--stream")
+                streamMode = true;
+            else if (arg == "--out-of-core")
+                outOfCore = true;
+            else if (arg == "--memory" && i + 1 < argc)
+                memoryBytes = (size_t)max(1, atoi(argv[++i])) << 20;
+            else if (arg == "--scratch" && i + 1 < argc)
+                scratchDir = argv[++i];
+            else if (arg == "--solvers" && i + 1 < argc)
+                solvers = max(1, atoi(argv[++i]));
+            else if (arg == "--output" && i + 1 < argc)
+                level = io::parseLevel(argv[++i]);
+            else if (arg == "--profile" && i + 1 < argc)
             {
-                result[i] = 0;
-                for (int j = 0; j < n; j++)
-                    result[i] += A[i][j] * x[j];
-                fout << "Row " << i + 1 << ": " << result[i] 
-                     << " (expected: " << b[i] << ")\n";
+                profilePath = argv[++i];
+                if (!prof::ENABLED)
+                    cerr << "Note: --profile needs a build with -DNCS_PROFILE\n";
             }
+            else if (isdigit((unsigned char)arg[0]))
+                opt.blockSize = max(1, atoi(argv[i]));
         }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
 
-        fout << "\n" << string(60, '=') << "\n\n";
+    ifstream probe(inputPath);
+    if (!probe)
+    {
+        cerr << "Error:  " << inputPath << " not found!\n";
+        return 1;
+    }
+    probe.close();
+
+    io::Writer fout("output.txt");
+    if (!fout)
+    {
+        cerr << "Error: cannot open output.txt\n";
+        return 1;
+    }
+    fout.precision(4);
+
+    auto writeProfile = [&]()
+    {
+        PROF_REPORT("lu-decomposition", profilePath);
+        if (prof::ENABLED)
+            cout << "Profile written to " << profilePath << "\n";
+    };
+
+    try
+    {
+        if (streamMode)
+        {
+            runStream(inputPath, fout, level, opt, solvers);
+            fout.close();
+            if (!fout)
+                throw runtime_error("could not write output.txt");
+            writeProfile();
+            cout << "All results written to output.txt\n";
+            return 0;
+        }
+        if (outOfCore)
+        {
+            runOutOfCore(inputPath, fout, level, scratchDir, memoryBytes);
+            fout.close();
+            if (!fout)
+                throw runtime_error("could not write output.txt");
+            writeProfile();
+            cout << "All results written to output.txt\n";
+            return 0;
+        }
+
+        sysio::SystemReader reader(inputPath);
+        sysio::System sys;
+
+        // Consecutive systems with the same A are collected and solved together;
+        // the right-hand sides are the rows of groupRhs. A is used where the
+        // reader keeps it (for binary input, straight from the mapped file).
+        mat::MatrixView<const double> groupA;
+        mat::Matrix<double> groupRhs;
+        vector<double> b;
+
+        auto solve = [&]() { solveAny(fout, groupA, groupRhs, level, opt); };
+        auto next = [&]()
+        {
+            PROF_SCOPE("parse");
+            if (!reader.next(sys))
+                return false;
+            PROF_BYTES(8.0 * sys.n * (sys.n + sys.nrhs));
+            return true;
+        };
+
+        while (next())
+        {
+            if (groupRhs.rows() > 0 && !sameMatrix(sys.A, groupA))
+            {
+                solve();
+                groupRhs.assign(0, 0);
+            }
+            if (groupRhs.rows() == 0)
+                groupA = sys.A;
+            for (int s = 0; s < sys.nrhs; s++)
+            {
+                b.resize(sys.n);
+                for (int i = 0; i < sys.n; i++)
+                    b[i] = sys.B(i, s);
+                groupRhs.appendRow(b);
+            }
+        }
+        if (groupRhs.rows() > 0)
+            solve();
+        writeProfile();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
     }
 
-    fin.close();
     fout.close();
+    if (!fout)
+    {
+        cerr << "Error: could not write output.txt\n";
+        return 1;
+    }
     cout << "All results written to output.txt\n";
     return 0;
 }
\ No newline at end of file
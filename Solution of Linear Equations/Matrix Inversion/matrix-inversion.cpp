@@ -1,125 +1,192 @@
 #include <bits/stdc++.h>
+#include "../../Common/determinant.h"
+#include "../../Common/fixed-size-solvers.h"
+#include "../../Common/lu-factor.h"
+#include "../../Common/matrix.h"
+#include "../../Common/profiler.h"
+#include "../../Common/system-io.h"
 using namespace std;
 
-double determinant(const vector<vector<double>>& A);
-vector<vector<double>> adjoint(const vector<vector<double>>& A);
+const size_t LOGDET_BATCH = 1 << 22; // values per batch in --logdet mode (32 MB)
 
 /* ---------------------------
-   Compute inverse by 1/det(A) * adj(A)
+   Compute inverse from PA = LU by solving A * X = I
+   (n <= 16: the unrolled fixed-size LU of Common/fixed-size-solvers.h)
 ----------------------------*/
-bool inverseByAdjoint(const vector<vector<double>>& A,
-                      vector<vector<double>>& inv) {
-    int n = A.size();
-    for (auto &r : A)
-        if (r.size() != n) return false; // must be square
-
-    double detA = determinant(A);
-    if (fabs(detA) < 1e-12) return false; // non-invertible
-
-    vector<vector<double>> adjA = adjoint(A);
+bool inverseByLU(mat::MatrixView<const double> A,
+                 mat::Matrix<double>& inv) {
+    int n = A.rows;
+    if (A.cols != n) return false; // must be square
+
+    if (n >= 1 && n <= fx::MAX_N) {
+        inv = mat::Matrix<double>(n, n);
+        return fx::inverse(n, A.ptr, (int)A.rowStride, inv.data(), inv.ld());
+    }
 
-    inv.assign(n, vector<double>(n));
-    for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-            inv[i][j] = adjA[i][j] / detA;
+    lu::LUFactor F(A.ptr, n, (int)A.rowStride); // reads A in place
+    if (F.singular()) return false; // zero pivot: non-invertible
 
+    vector<double> X = F.inverse();
+    inv = mat::Matrix<double>(n, n, X.data(), n);
     return true;
 }
 
 /* ---------------------------
-   Determinant (cofactor expansion)
+   Log-determinant mode (--logdet [threads]): every matrix of the input
+   gets one line with sign(det), log|det| and det. The matrices are read
+   in batches of about LOGDET_BATCH values and factored in parallel
+   (Common/determinant.h), so the input can hold millions of them.
 ----------------------------*/
-double determinant(const vector<vector<double>>& A) {
-    int n = A.size();
-    if (n == 1) return A[0][0];
-    if (n == 2)
-        return A[0][0]*A[1][1] - A[0][1]*A[1][0];
-
-    double det = 0;
-    for (int col = 0; col < n; col++) {
-        vector<vector<double>> sub(n-1, vector<double>(n-1));
-        for (int i = 1; i < n; i++) {
-            int c2 = 0;
-            for (int j = 0; j < n; j++) {
-                if (j == col) continue;
-                sub[i-1][c2++] = A[i][j];
+int runLogDet(const string& inputPath, ofstream& fout, int threads) {
+    sysio::SystemReader reader(inputPath, 0, false);
+    sysio::System sys;
+    det::BatchLogDet batch;
+    ThreadPool pool(threads);
+    long long done = 0;
+    double seconds = 0;
+    fout << fixed << setprecision(6);
+
+    auto flush = [&]() {
+        auto start = chrono::steady_clock::now();
+        {
+            PROF_SCOPE("log-determinant");
+            for (int s = 0; s < batch.count(); s++)
+                PROF_FLOPS(2.0 * batch.size(s) * batch.size(s) * batch.size(s) / 3);
+            batch.run(pool);
+        }
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        PROF_SCOPE("output");
+        for (int s = 0; s < batch.count(); s++) {
+            const det::LogDet& d = batch.result(s);
+            int n = batch.size(s);
+            fout << "Matrix " << ++done << " (" << n << " x " << n << "): ";
+            if (d.sign == 0) {
+                fout << "singular, det = 0\n";
+                continue;
             }
+            fout << "sign = " << (d.sign > 0 ? "+1" : "-1")
+                 << ", log|det| = " << d.logAbs
+                 << ", det = " << det::scientific(d) << "\n";
+        }
+        batch.clear();
+    };
+
+    auto next = [&]() {
+        PROF_SCOPE("parse");
+        return reader.next(sys);
+    };
+
+    size_t pending = 0;
+    while (next()) {
+        batch.add(&sys.A(0, 0), sys.n, (int)sys.A.rowStride);
+        pending += (size_t)sys.n * sys.n;
+        if (pending >= LOGDET_BATCH) {
+            flush();
+            pending = 0;
         }
-        det += ((col % 2 == 0) ? 1 : -1) * A[0][col] * determinant(sub);
     }
-    return det;
+    flush();
+
+    cout << "Log-determinants of " << done << " matrices in " << fixed << setprecision(3)
+         << seconds << " s (" << threads << " thread" << (threads > 1 ? "s" : "") << ")\n";
+    return 0;
 }
 
 /* ---------------------------
-   Adjoint matrix
+   Main: File I/O
+   Optional: ./matrix-inversion [--logdet [threads]] [--input file] [--profile file]
+   (text or binary, see Common/system-io.h; the first matrix is inverted;
+   --profile: per-phase times and counts of a -DNCS_PROFILE build, see
+   Common/profiler.h)
 ----------------------------*/
-vector<vector<double>> adjoint(const vector<vector<double>>& A) {
-    int n = A.size();
-    vector<vector<double>> adj(n, vector<double>(n));
-
-    if (n == 1) {
-        adj[0][0] = 1;
-        return adj;
+int main(int argc, char* argv[]) {
+    string inputPath = "input.txt";
+    string profilePath = "profile.json";
+    bool logDetMode = false;
+    int threads = 1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--input" && i + 1 < argc) inputPath = argv[++i];
+        else if (arg == "--logdet") logDetMode = true;
+        else if (arg == "--profile" && i + 1 < argc) {
+            profilePath = argv[++i];
+            if (!prof::ENABLED) cerr << "Note: --profile needs a build with -DNCS_PROFILE\n";
+        }
+        else if (isdigit((unsigned char)arg[0])) threads = max(1, atoi(argv[i]));
     }
 
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            vector<vector<double>> sub(n-1, vector<double>(n-1));
-            int r2 = 0;
-            for (int r = 0; r < n; r++) {
-                if (r == i) continue;
-                int c2 = 0;
-                for (int c = 0; c < n; c++) {
-                    if (c == j) continue;
-                    sub[r2][c2++] = A[r][c];
-                }
-                r2++;
-            }
-
-            double cofactor = ((i + j) % 2 == 0 ? 1 : -1)
-                              * determinant(sub);
-            adj[j][i] = cofactor; // transpose
+    ifstream probe(inputPath);
+    if (!probe.is_open()) {
+        cerr << "Failed to open " << inputPath << "\n";
+        return 1;
+    }
+    probe.close();
+
+    auto writeProfile = [&]() {
+        try {
+            PROF_REPORT("matrix-inversion", profilePath);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        if (prof::ENABLED) cout << "Profile written to " << profilePath << "\n";
+        return 0;
+    };
+
+    if (logDetMode) {
+        ofstream fout("output.txt");
+        try {
+            int status = runLogDet(inputPath, fout, threads);
+            fout.close();
+            return status == 0 ? writeProfile() : status;
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << "\n";
+            return 1;
         }
     }
-    return adj;
-}
-
-/* ---------------------------
-   Main: File I/O
-----------------------------*/
-int main() {
-    ifstream fin("input.txt");
-    ofstream fout("output.txt");
 
-    if (!fin.is_open()) {
-        cerr << "Failed to open input.txt\n";
+    unique_ptr<sysio::SystemReader> reader; // owns the data A points into
+    sysio::System sys;
+    try {
+        PROF_SCOPE("parse");
+        reader = make_unique<sysio::SystemReader>(inputPath, 0); // bare n x n matrix
+        if (!reader->next(sys)) {
+            cerr << "No matrix in " << inputPath << "\n";
+            return 1;
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << "\n";
         return 1;
     }
 
-    int n;
-    fin >> n;
-
-    vector<vector<double>> A(n, vector<double>(n));
-    for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-            fin >> A[i][j];
+    ofstream fout("output.txt");
+    int n = sys.n;
+    mat::MatrixView<const double> A = sys.A;
 
-    vector<vector<double>> inv;
+    mat::Matrix<double> inv;
     fout << fixed << setprecision(6);
 
-    if (!inverseByAdjoint(A, inv)) {
+    bool invertible;
+    {
+        PROF_SCOPE("inversion");
+        PROF_FLOPS(2.0 * n * n * n);
+        invertible = inverseByLU(A, inv);
+    }
+    if (!invertible) {
         fout << "Matrix is singular.\n";
-        return 0;
+        fout.close();
+        return writeProfile();
     }
 
-    fout << "Inverse using adj(A)/det(A):\n";
-    for (auto &row : inv) {
-        for (double x : row)
-            fout << setw(12) << x;
-        fout << "\n";
+    {
+        PROF_SCOPE("output");
+        fout << "Inverse using LU decomposition (PA = LU):\n";
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++)
+                fout << setw(12) << inv[i][j];
+            fout << "\n";
+        }
+        fout.close();
     }
-
-    fin.close();
-    fout.close();
-    return 0;
+    return writeProfile();
 }
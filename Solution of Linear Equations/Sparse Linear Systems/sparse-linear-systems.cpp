@@ -0,0 +1,232 @@
+#include <bits/stdc++.h>
+#include "../../Common/sparse-matrix.h"
+#include "../../Common/sparse-solvers.h"
+using namespace std;
+
+/*
+   Each test case starts with one line:
+
+     <solver> <option> <source>
+
+   solver  lu | cg | gmres
+   option  lu: natural | mindeg           (column ordering)
+           cg, gmres: none | jacobi | ilu0 (preconditioner)
+   source  inline          Matrix Market data follows, then the n values of b
+           file <path>     Matrix Market file, b = A * (1, ..., 1)
+           poisson2d <m>   5-point Laplacian on an m x m grid, b = A * (1, ..., 1)
+*/
+
+const int PRINT_LIMIT = 10; // print full systems and solutions up to this size
+
+void printSystem(ofstream &fout, const sparse::CSR &A, const vector<double> &b)
+{
+    fout << "Input system (nonzero terms only):\n";
+    for (int i = 0; i < A.rows; i++)
+    {
+        for (int p = A.rowPtr[i]; p < A.rowPtr[i + 1]; p++)
+        {
+            if (p > A.rowPtr[i] && A.val[p] >= 0) fout << "+";
+            fout << A.val[p] << "x" << A.colIdx[p] + 1 << " ";
+        }
+        fout << "= " << b[i] << "\n";
+    }
+}
+
+int main()
+{
+    ifstream fin("input.txt");
+    ofstream fout("output.txt");
+
+    if (!fin)
+    {
+        cerr << "Error: input.txt not found!\n";
+        return 1;
+    }
+
+    fout << fixed << setprecision(4);
+
+    string solver, option, source;
+    while (fin >> solver >> option >> source)
+    {
+        sparse::CSR A;
+        vector<double> b;
+        bool onesSolution = false; // b = A * 1, so the exact solution is all ones
+        string description;
+
+        try
+        {
+            if (source == "inline")
+            {
+                A = sparse::readMatrixMarket(fin);
+                b.resize(A.rows);
+                for (double &v : b)
+                    if (!(fin >> v))
+                        throw runtime_error("right-hand side has fewer than n values");
+                description = "inline Matrix Market";
+            }
+            else if (source == "file")
+            {
+                string path;
+                fin >> path;
+                A = sparse::readMatrixMarket(path);
+                description = "Matrix Market file " + path;
+                onesSolution = true;
+            }
+            else if (source == "poisson2d")
+            {
+                int m;
+                fin >> m;
+                A = sparse::poisson2D(m);
+                description = "2D Poisson, " + to_string(m) + " x " + to_string(m) + " grid";
+                onesSolution = true;
+            }
+            else
+                throw runtime_error("unknown matrix source '" + source + "'");
+
+            if (A.rows != A.cols)
+                throw runtime_error("matrix must be square");
+        }
+        catch (const exception &e)
+        {
+            // The rest of the input cannot be located reliably after a read error
+            fout << "\nError: " << e.what() << "\n";
+            cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+
+        int n = A.rows;
+        if (onesSolution)
+            b = A.multiply(vector<double>(n, 1.0));
+
+        fout << "\n========================================\n";
+        fout << "Matrix: " << description << "\n";
+        fout << "n = " << n << ", nnz = " << A.nnz() << " (" << setprecision(2)
+             << 100.0 * A.nnz() / ((double)n * n) << "% of the dense matrix)\n" << setprecision(4);
+        fout << "CSR storage: " << A.nnz() << " values + " << A.nnz() << " column indices + "
+             << n + 1 << " row pointers\n";
+        if (n <= PRINT_LIMIT)
+            printSystem(fout, A, b);
+        fout << "========================================\n";
+
+        vector<double> x;
+        bool solved = true;
+
+        if (solver == "lu")
+        {
+            auto ordering = option == "natural" ? sparse::SparseLU::Ordering::Natural
+                                                : sparse::SparseLU::Ordering::MinimumDegree;
+            fout << "\nSparse LU (P*A(q,q) = L*U), ordering: "
+                 << (option == "natural" ? "natural" : "minimum degree") << "\n";
+
+            sparse::SparseLU F(A, ordering);
+            if (F.singular())
+            {
+                fout << "\nMatrix is singular (no nonzero pivot left in some column).\n";
+                solved = false;
+            }
+            else
+            {
+                long long fill = (long long)F.nnzL() + F.nnzU() - n - A.nnz();
+                fout << "nnz(L) = " << F.nnzL() << ", nnz(U) = " << F.nnzU()
+                     << ", fill-in = " << fill << "\n";
+                if (n <= PRINT_LIMIT)
+                {
+                    fout << "Column order q: ";
+                    for (int k = 0; k < n; k++)
+                        fout << F.ordering()[k] + 1 << (k + 1 < n ? " " : "\n");
+                }
+                x = F.solve(b);
+            }
+        }
+        else if (solver == "cg" || solver == "gmres")
+        {
+            sparse::Preconditioner M;
+            string name;
+            try
+            {
+                if (option == "jacobi")
+                {
+                    auto jacobi = make_shared<sparse::Jacobi>(A);
+                    M = [jacobi](const double *r, double *z) { jacobi->apply(r, z); };
+                    name = "Jacobi";
+                }
+                else if (option == "ilu0")
+                {
+                    auto ilu = make_shared<sparse::ILU0>(A);
+                    M = [ilu](const double *r, double *z) { ilu->apply(r, z); };
+                    name = "ILU(0)";
+                }
+                else
+                {
+                    M = [n](const double *r, double *z) { copy(r, r + n, z); };
+                    name = "none";
+                }
+            }
+            catch (const exception &e)
+            {
+                fout << "\nPreconditioner failed: " << e.what() << "\n";
+                fout << "\n" << string(60, '=') << "\n\n";
+                continue;
+            }
+
+            sparse::IterativeResult r;
+            if (solver == "cg")
+            {
+                fout << "\nConjugate Gradient, preconditioner: " << name << "\n";
+                r = sparse::conjugateGradient(A, b, x, M);
+            }
+            else
+            {
+                fout << "\nGMRES(30), preconditioner: " << name << "\n";
+                r = sparse::gmres(A, b, x, M, 30);
+            }
+
+            fout << (r.converged ? "Converged" : "Did NOT converge") << " after "
+                 << r.iterations << " iterations\n";
+            fout << scientific << setprecision(2)
+                 << "Relative residual ||b - Ax|| / ||b|| = " << r.residual << "\n"
+                 << fixed << setprecision(4);
+        }
+        else
+        {
+            fout << "\nUnknown solver '" << solver << "'\n";
+            solved = false;
+        }
+
+        if (solved)
+        {
+            fout << "\nSolution:\n";
+            for (int i = 0; i < min(n, PRINT_LIMIT); i++)
+                fout << "x" << i + 1 << " = " << x[i] << "\n";
+            if (n > PRINT_LIMIT)
+                fout << "... (" << n - PRINT_LIMIT << " more)\n";
+
+            // Verification against b (and against the known solution of 1s)
+            vector<double> Ax = A.multiply(x);
+            double rnorm = 0.0, bnorm = 0.0;
+            for (int i = 0; i < n; i++)
+            {
+                rnorm += (b[i] - Ax[i]) * (b[i] - Ax[i]);
+                bnorm += b[i] * b[i];
+            }
+            fout << scientific << setprecision(2);
+            fout << "\nVerification: ||b - Ax|| / ||b|| = "
+                 << (bnorm > 0 ? sqrt(rnorm / bnorm) : sqrt(rnorm)) << "\n";
+            if (onesSolution)
+            {
+                double err = 0.0;
+                for (int i = 0; i < n; i++)
+                    err = max(err, fabs(x[i] - 1.0));
+                fout << "Max error against the exact solution (all ones) = " << err << "\n";
+            }
+            fout << fixed << setprecision(4);
+        }
+
+        fout << "\n" << string(60, '=') << "\n\n";
+    }
+
+    fin.close();
+    fout.close();
+    cout << "All results written to output.txt\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <bits/stdc++.h>
+#include "../../Common/polynomial-roots.h"
+using namespace std;
+
+#define f double
+
+// Print polynomial in readable form
+void printPolynomial(ofstream &out, const vector<f> &coef) {
+    int n = coef.size() - 1;
+    out << "f(x) = ";
+
+    bool first = true;
+    for (int i = 0; i <= n; i++) {
+        f c = coef[i];
+        int power = n - i;
+        if (c == 0) continue;
+
+        if (!first) {
+            if (c > 0) out << " + ";
+            else out << " - ";
+        } else {
+            if (c < 0) out << "-";
+        }
+
+        if (abs(c) != 1 || power == 0)
+            out << abs(c);
+
+        if (power > 0) {
+            out << "x";
+            if (power > 1)
+                out << "^" << power;
+        }
+
+        first = false;
+    }
+    out << "\n\n";
+}
+
+// Print header
+void printHeader(ofstream &out) {
+    out << "============================================\n";
+    out << "          Aberth-Ehrlich Method\n";
+    out << "============================================\n\n";
+}
+void printHeader() {
+    cout << "============================================\n";
+    cout << "          Aberth-Ehrlich Method\n";
+    cout << "============================================\n\n";
+}
+
+// Value as printed with 6 decimals, without "-0.000000"
+f shown(f v) {
+    return abs(v) < 5e-7 ? 0.0 : v;
+}
+
+// Print roots table: every root once, with its multiplicity and error bound
+void printRootsTable(ofstream &out, const vector<roots::Root> &found) {
+    out << setw(6) << "Index"
+        << setw(20) << "Real Part"
+        << setw(20) << "Imaginary Part"
+        << setw(14) << "Multiplicity"
+        << setw(14) << "Error Bound" << "\n";
+    out << string(74, '-') << "\n";
+
+    for (size_t i = 0; i < found.size(); i++) {
+        out << fixed << setprecision(6)
+            << setw(6) << (i + 1)
+            << setw(20) << shown(found[i].value.real())
+            << setw(20) << shown(found[i].value.imag())
+            << setw(14) << found[i].multiplicity
+            << scientific << setprecision(1)
+            << setw(14) << found[i].radius << "\n";
+    }
+    out << fixed << setprecision(6) << "\n";
+}
+
+// Optional: [--threads k] (approximations updated in parallel blocks on k threads)
+int main(int argc, char *argv[]) {
+    string inputFile, outputFile;
+    int threads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--threads") threads = max(1, atoi(argv[i + 1]));
+    }
+
+    printHeader();
+    // File names
+    cout << "Enter input file name: ";
+    cin >> inputFile;
+    cout << "Enter output file name: ";
+    cin >> outputFile;
+
+    ifstream in(inputFile);
+    ofstream out(outputFile);
+
+    if (!in.is_open() || !out.is_open()) {
+        cout << "Error: Cannot open input/output file!\n";
+        return 1;
+    }
+
+    int degree;
+    if (!(in >> degree) || degree < 0) {
+        cout << "Error: Invalid polynomial degree!\n";
+        return 1;
+    }
+    vector<f> coef(degree + 1);
+    for (int i = 0; i <= degree; i++)
+        in >> coef[i];
+
+    printHeader(out);
+
+    out << "Polynomial Degree : " << degree << "\n";
+    out << "Coefficients      : ";
+    for (auto c : coef) out << c << " ";
+    out << "\n\n";
+
+    printPolynomial(out, coef);
+
+    // All roots at once (Common/polynomial-roots.h)
+    ThreadPool pool(threads);
+    auto start = chrono::steady_clock::now();
+    roots::Result result = roots::aberth(coef, pool);
+    f seconds = chrono::duration<f>(chrono::steady_clock::now() - start).count();
+    cout << "Found " << result.roots.size() << " distinct roots in " << result.iterations
+         << " Aberth-Ehrlich iterations, " << fixed << setprecision(3) << seconds << " s ("
+         << threads << " thread" << (threads > 1 ? "s" : "") << ")\n";
+
+    // Count real and complex roots, with and without multiplicity
+    int real = 0, realTotal = 0, complexCount = 0, complexTotal = 0;
+    for (auto &r : result.roots) {
+        if (r.real()) { real++; realTotal += r.multiplicity; }
+        else { complexCount++; complexTotal += r.multiplicity; }
+    }
+
+    // Output roots table
+    out << "Roots\n";
+    out << "============================================\n";
+    if (result.roots.empty()) {
+        out << "A constant polynomial has no roots.\n\n";
+    } else {
+        printRootsTable(out, result.roots);
+        out << "Real roots        : " << real << " (" << realTotal << " with multiplicity)\n";
+        out << "Complex roots     : " << complexCount << " (" << complexTotal << " with multiplicity)\n";
+        out << "Iterations        : " << result.iterations << "\n\n";
+        if (!result.converged)
+            out << "Warning: Some approximations did not converge; see their error bounds.\n\n";
+    }
+
+    out << "============================================\n";
+    out << "Computation Completed Successfully.\n";
+
+    in.close();
+    out.close();
+
+    cout << "Computation completed. Results written to '" << outputFile << "'\n";
+
+    return 0;
+}
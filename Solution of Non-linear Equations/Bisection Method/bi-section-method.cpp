@@ -1,15 +1,14 @@
 #include <bits/stdc++.h>
+#include "../../Common/polynomial.h"
+#include "../../Common/root-brackets.h"
+#include "../../Common/root-solvers.h"
 using namespace std;
 
 #define f double
 
-// Polynomial function f(x)
+// Polynomial function f(x), by Horner's rule (Common/polynomial.h)
 f fun(const vector<f> &coef, f x) {
-    f result = 0.0;
-    int n = coef.size() - 1;
-    for (int i = 0; i <= n; i++)
-        result += coef[i] * pow(x, n - i);
-    return result;
+    return poly::horner(coef, x);
 }
 
 // Print polynomial nicely
@@ -42,13 +41,18 @@ void printHeader() {
     cout << "============================================\n\n";
 }
 
+// Decimals to print for a tolerance (6 for the default 1e-6)
+int digitsFor(f tolerance) {
+    return max(6, (int)ceil(-log10(tolerance)));
+}
+
 // Print final roots table with trivial root highlight
 void printRootsTable(ofstream &out, const vector<f> &roots, const vector<f> &coef, f tolerance = 1e-6) {
     out << setw(6) << "Index" 
         << setw(20) << "Root Value" << "\n";
     out << string(26, '-') << "\n";
 
-    out << fixed << setprecision(6);
+    out << fixed << setprecision(digitsFor(tolerance));
     for (size_t i = 0; i < roots.size(); i++) {
         f fx = fun(coef, roots[i]);
         out << setw(6) << (i + 1)
@@ -58,29 +62,62 @@ void printRootsTable(ofstream &out, const vector<f> &roots, const vector<f> &coe
     out << "\n";
 }
 
-// Print iteration table per root
-void printBisectionIteration(ofstream &out, const vector<tuple<int,f,f,f,f>> &iterData) {
+// Print iteration table per root (x: the midpoint, or the point the --method solver took)
+void printBisectionIteration(ofstream &out, const vector<tuple<int,f,f,f,f>> &iterData, bool midpoint = true, int digits = 6) {
+    int w = digits + 9;
     out << setw(10) << "Iteration"
-        << setw(15) << "x_low"
-        << setw(15) << "x_high"
-        << setw(15) << "x_mid"
-        << setw(20) << "f(x_mid)" << "\n";
-    out << string(75, '-') << "\n";
-    out << fixed << setprecision(6);
+        << setw(w) << "x_low"
+        << setw(w) << "x_high"
+        << setw(w) << (midpoint ? "x_mid" : "x")
+        << setw(20) << (midpoint ? "f(x_mid)" : "f(x)") << "\n";
+    out << string(30 + 3 * w, '-') << "\n";
+    out << fixed << setprecision(digits);
     for (auto &t : iterData) {
         int iter; f xL, xH, xM, fxM;
         tie(iter, xL, xH, xM, fxM) = t;
         out << setw(10) << iter
-            << setw(15) << xL
-            << setw(15) << xH
-            << setw(15) << xM
+            << setw(w) << xL
+            << setw(w) << xH
+            << setw(w) << xM
             << setw(20) << fxM << "\n";
     }
     out << "\n";
 }
 
-int main() {
+// Optional: [--range R] [--step h] [--threads k] [--tolerance t]
+//           [--method brent|illinois|anderson-bjorck]
+// (roots isolated inside their root bound, cut to [-R, R]; with --step, the
+//  grid [-R, R] (R = 5000 if not given) scanned in steps of h on k threads;
+//  each bracket solved to t by bisection, or by the solver --method names)
+int main(int argc, char *argv[]) {
     string inputFile, outputFile;
+    f searchRange = HUGE_VAL, step = 0.0; // step 0: adaptive isolation
+    f tolerance = 1e-6;
+    int threads = max(1u, thread::hardware_concurrency());
+    bool hybrid = false; // --method given
+    solver::Method method = solver::Method::Brent;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--range") searchRange = atof(argv[i + 1]);
+        else if (arg == "--step") step = atof(argv[i + 1]);
+        else if (arg == "--threads") threads = max(1, atoi(argv[i + 1]));
+        else if (arg == "--tolerance") tolerance = atof(argv[i + 1]);
+        else if (arg == "--method") {
+            hybrid = true;
+            if (!solver::parseMethod(argv[i + 1], method)) {
+                cout << "Error: --method must be brent, illinois or anderson-bjorck\n";
+                return 1;
+            }
+        }
+    }
+    if (!(searchRange >= 0) || !(step >= 0)) {
+        cout << "Error: --range and --step must be >= 0\n";
+        return 1;
+    }
+    if (!(tolerance > 0)) {
+        cout << "Error: --tolerance must be > 0\n";
+        return 1;
+    }
 
     // File names
     printHeader();
@@ -107,47 +144,82 @@ int main() {
     for (auto c : coef) out << c << " ";
     out << "\n\n";
     printPolynomial(out, coef);
+    if (hybrid) out << "Solver            : " << solver::methodName(method) << "\n\n";
 
     // Bisection parameters
-    f searchRange = 5000.0, step = 0.5, tolerance = 1e-6;
-    vector<f> roots, intervals;
-
-    // Scan for roots / intervals
-    for (f i = -searchRange; i <= searchRange; i += step) {
-        f fx1 = fun(coef, i);
-        f fx2 = fun(coef, i + step);
-        if (abs(fx1) < tolerance) {
-            bool duplicate = false;
-            for (auto r : roots) if (abs(r - i) < tolerance) { duplicate = true; break; }
-            if (!duplicate) roots.push_back(i);
-        } else if (fx1 * fx2 < 0.0) intervals.push_back(i);
+    vector<f> roots;
+    vector<bracket::Interval> intervals;
+
+    // Find intervals with sign changes (Common/root-brackets.h): isolate the
+    // roots with root bounds and Sturm counts, or scan a grid if --step is given
+    ThreadPool pool(threads);
+    auto start = chrono::steady_clock::now();
+    bracket::Scan grid;
+    if (step > 0) {
+        if (isinf(searchRange)) searchRange = 5000.0;
+        grid = bracket::scan(coef, -searchRange, searchRange, step, tolerance, pool);
+    } else {
+        grid = bracket::isolate(coef, searchRange, tolerance, pool);
+    }
+    f seconds = chrono::duration<f>(chrono::steady_clock::now() - start).count();
+    cout << "Searched [" << grid.lo << ", " << grid.hi << "]";
+    if (step > 0) cout << " in steps of " << step << " (" << threads << " thread" << (threads > 1 ? "s" : "") << ")";
+    else if (grid.realRoots >= 0) cout << ", " << grid.realRoots << " distinct real root(s) by Sturm's theorem";
+    else cout << ", Sturm counts unreliable in places: grid scan there";
+    cout << ": " << grid.evaluations << " evaluations in " << fixed << setprecision(3) << seconds << " s\n";
+
+    // Exact roots at grid points
+    for (f x : grid.gridRoots) {
+        bool duplicate = false;
+        for (auto r : roots) if (abs(r - x) < tolerance) { duplicate = true; break; }
+        if (!duplicate) roots.push_back(x);
     }
+    intervals = grid.intervals;
 
     vector<vector<tuple<int,f,f,f,f>>> allIterations; // iterations per root
 
-    for (f start : intervals) {
-        f xL = start, xH = start + step, xM;
-        vector<tuple<int,f,f,f,f>> iterData;
-        int iter = 1;
-        while (true) {
-            xM = (xL + xH) / 2.0;
-            f fxM = fun(coef, xM);
-            iterData.push_back({iter, xL, xH, xM, fxM});
-
-            if (abs(fxM) < tolerance || abs(xH - xL) < tolerance) {
-                bool duplicate = false;
-                for (auto r : roots) if (abs(r - xM) < tolerance) { duplicate = true; break; }
-                if (!duplicate) roots.push_back(xM);
-                break;
-            }
-
-            f fxL = fun(coef, xL);
-            if (fxL * fxM < 0) xH = xM;
-            else xL = xM;
+    if (hybrid) {
+        // Brent or modified false position on each bracket (Common/root-solvers.h)
+        int evaluations = 0;
+        for (auto iv : intervals) {
+            vector<solver::Step> trace;
+            solver::Result r = solver::solve(method, [&](f x) { return fun(coef, x); }, iv.lo, iv.hi, tolerance, &trace);
+            evaluations += r.evaluations;
+            vector<tuple<int,f,f,f,f>> iterData;
+            for (auto &s : trace) iterData.push_back({s.iteration, s.lo, s.hi, s.x, s.fx});
+            allIterations.push_back(iterData);
 
-            iter++;
+            bool duplicate = false;
+            for (auto x : roots) if (abs(x - r.root) < tolerance) { duplicate = true; break; }
+            if (!duplicate) roots.push_back(r.root);
+        }
+        cout << solver::methodName(method) << ": " << intervals.size() << " bracket(s), "
+             << evaluations << " evaluations to tolerance " << scientific << setprecision(0) << tolerance << "\n";
+    } else {
+        for (auto iv : intervals) {
+            f xL = iv.lo, xH = iv.hi, xM;
+            vector<tuple<int,f,f,f,f>> iterData;
+            int iter = 1;
+            while (true) {
+                xM = (xL + xH) / 2.0;
+                f fxM = fun(coef, xM);
+                iterData.push_back({iter, xL, xH, xM, fxM});
+
+                if (abs(fxM) < tolerance || abs(xH - xL) < tolerance || xM == xL || xM == xH) {
+                    bool duplicate = false;
+                    for (auto r : roots) if (abs(r - xM) < tolerance) { duplicate = true; break; }
+                    if (!duplicate) roots.push_back(xM);
+                    break;
+                }
+
+                f fxL = fun(coef, xL);
+                if (fxL * fxM < 0) xH = xM;
+                else xL = xM;
+
+                iter++;
+            }
+            allIterations.push_back(iterData);
         }
-        allIterations.push_back(iterData);
     }
 
     sort(roots.begin(), roots.end());
@@ -165,7 +237,7 @@ int main() {
     for (size_t i = 0; i < allIterations.size(); i++) {
         out << "Iteration Table for Root " << (i + 1) << "\n";
         out << "----------------------------------------\n";
-        printBisectionIteration(out, allIterations[i]);
+        printBisectionIteration(out, allIterations[i], !hybrid, digitsFor(tolerance));
     }
 
     out << "============================================\n";
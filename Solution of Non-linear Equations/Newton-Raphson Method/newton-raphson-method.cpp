@@ -1,24 +1,13 @@
 #include <bits/stdc++.h>
+#include "../../Common/polynomial.h"
+#include "../../Common/root-brackets.h"
 using namespace std;
 
 #define f double
 
-// Polynomial function f(x)
+// Polynomial function f(x), by Horner's rule (Common/polynomial.h)
 f fun(const vector<f> &coef, f x) {
-    f result = 0.0;
-    int n = coef.size() - 1;
-    for (int i = 0; i <= n; i++)
-        result += coef[i] * pow(x, n - i);
-    return result;
-}
-
-// Derivative function f'(x)
-f derivative(const vector<f> &coef, f x) {
-    f result = 0.0;
-    int n = coef.size() - 1;
-    for (int i = 0; i < n; i++)
-        result += coef[i] * (n - i) * pow(x, n - i - 1);
-    return result;
+    return poly::horner(coef, x);
 }
 
 // Print polynomial in readable form
@@ -81,8 +70,23 @@ void printRootsTable(ofstream &out, const vector<f> &roots, const vector<f> &coe
     out << "\n";
 }
 
-int main() {
+// Optional: [--range R] [--step h] [--threads k]
+// (roots isolated inside their root bound, cut to [-R, R]; with --step, the
+//  grid [-R, R] (R = 5000 if not given) scanned in steps of h on k threads)
+int main(int argc, char *argv[]) {
     string inputFile, outputFile;
+    f searchRange = HUGE_VAL, step = 0.0; // step 0: adaptive isolation
+    int threads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--range") searchRange = atof(argv[i + 1]);
+        else if (arg == "--step") step = atof(argv[i + 1]);
+        else if (arg == "--threads") threads = max(1, atoi(argv[i + 1]));
+    }
+    if (!(searchRange >= 0) || !(step >= 0)) {
+        cout << "Error: --range and --step must be >= 0\n";
+        return 1;
+    }
 
     printHeader();
     // File names
@@ -115,34 +119,46 @@ int main() {
     printPolynomial(out, coef);
 
     // Parameters
-    f searchRange = 5000.0, step = 0.5, tolerance = 1e-6;
-    vector<f> roots, intervals;
-
-    // Find intervals with sign changes
-    for (f i = -searchRange; i <= searchRange; i += step) {
-        f fx1 = fun(coef, i);
-        f fx2 = fun(coef, i + step);
-
-        // Exact root at grid
-        if (abs(fx1) < tolerance) {
-            bool duplicate = false;
-            for (auto r : roots) if (abs(r - i) < tolerance) { duplicate = true; break; }
-            if (!duplicate) roots.push_back(i);
-        }
-        // Sign change
-        else if (fx1 * fx2 < 0.0) {
-            intervals.push_back(i);
-        }
+    f tolerance = 1e-6, startWidth = 0.5; // start from brackets at most 0.5 wide
+    vector<f> roots;
+    vector<bracket::Interval> intervals;
+
+    // Find intervals with sign changes (Common/root-brackets.h): isolate the
+    // roots with root bounds and Sturm counts, or scan a grid if --step is given
+    ThreadPool pool(threads);
+    auto start = chrono::steady_clock::now();
+    bracket::Scan grid;
+    if (step > 0) {
+        if (isinf(searchRange)) searchRange = 5000.0;
+        grid = bracket::scan(coef, -searchRange, searchRange, step, tolerance, pool);
+    } else {
+        grid = bracket::isolate(coef, searchRange, tolerance, pool, startWidth);
+    }
+    f seconds = chrono::duration<f>(chrono::steady_clock::now() - start).count();
+    cout << "Searched [" << grid.lo << ", " << grid.hi << "]";
+    if (step > 0) cout << " in steps of " << step << " (" << threads << " thread" << (threads > 1 ? "s" : "") << ")";
+    else if (grid.realRoots >= 0) cout << ", " << grid.realRoots << " distinct real root(s) by Sturm's theorem";
+    else cout << ", Sturm counts unreliable in places: grid scan there";
+    cout << ": " << grid.evaluations << " evaluations in " << fixed << setprecision(3) << seconds << " s\n";
+
+    // Exact roots at grid points
+    for (f x : grid.gridRoots) {
+        bool duplicate = false;
+        for (auto r : roots) if (abs(r - x) < tolerance) { duplicate = true; break; }
+        if (!duplicate) roots.push_back(x);
     }
+    intervals = grid.intervals;
 
     // Apply Newton-Raphson Method
-    for (f start : intervals) {
-        f x = start;
+    for (auto iv : intervals) {
+        f x = iv.lo + (iv.hi - iv.lo) / 2; // start mid-bracket: an end can be where f is flat
         map<f, bool> visited;
 
         while (true) {
-            f fx = fun(coef, x);
-            f dfx = derivative(coef, x);
+            // f(x) and f'(x) in one Horner pass
+            poly::ValueSlope v = poly::hornerWithDerivative(coef, x);
+            f fx = v.value;
+            f dfx = v.slope;
 
             // Check for zero derivative (avoid division by zero)
             if (abs(dfx) < 1e-10) break;
@@ -1,15 +1,14 @@
 #include <bits/stdc++.h>
+#include "../../Common/polynomial.h"
+#include "../../Common/root-brackets.h"
+#include "../../Common/root-solvers.h"
 using namespace std;
 
 #define f double
 
-// Polynomial function f(x)
+// Polynomial function f(x), by Horner's rule (Common/polynomial.h)
 f fun(const vector<f> &coef, f x) {
-    f result = 0.0;
-    int n = coef.size() - 1;
-    for (int i = 0; i <= n; i++)
-        result += coef[i] * pow(x, n - i);
-    return result;
+    return poly::horner(coef, x);
 }
 
 // Print polynomial in readable form
@@ -56,13 +55,18 @@ void printHeader() {
     cout << "============================================\n\n";
 }
 
+// Decimals to print for a tolerance (6 for the default 1e-6)
+int digitsFor(f tolerance) {
+    return max(6, (int)ceil(-log10(tolerance)));
+}
+
 // Print roots table
 void printRootsTable(ofstream &out, const vector<f> &roots, const vector<f> &coef, f tolerance = 1e-6) {
     out << setw(6) << "Index" 
         << setw(20) << "Root Value" << "\n";
     out << string(26, '-') << "\n";
 
-    out << fixed << setprecision(6);
+    out << fixed << setprecision(digitsFor(tolerance));
     for (size_t i = 0; i < roots.size(); i++) {
         f fx = fun(coef, roots[i]);
         out << setw(6) << (i + 1)
@@ -72,8 +76,40 @@ void printRootsTable(ofstream &out, const vector<f> &roots, const vector<f> &coe
     out << "\n";
 }
 
-int main() {
+// Optional: [--range R] [--step h] [--threads k] [--tolerance t]
+//           [--method brent|illinois|anderson-bjorck]
+// (roots isolated inside their root bound, cut to [-R, R]; with --step, the
+//  grid [-R, R] (R = 5000 if not given) scanned in steps of h on k threads;
+//  each bracket solved to t by the secant method, or by the solver --method names)
+int main(int argc, char *argv[]) {
     string inputFile, outputFile;
+    f searchRange = HUGE_VAL, step = 0.0; // step 0: adaptive isolation
+    f tolerance = 1e-6;
+    int threads = max(1u, thread::hardware_concurrency());
+    bool hybrid = false; // --method given
+    solver::Method method = solver::Method::Brent;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--range") searchRange = atof(argv[i + 1]);
+        else if (arg == "--step") step = atof(argv[i + 1]);
+        else if (arg == "--threads") threads = max(1, atoi(argv[i + 1]));
+        else if (arg == "--tolerance") tolerance = atof(argv[i + 1]);
+        else if (arg == "--method") {
+            hybrid = true;
+            if (!solver::parseMethod(argv[i + 1], method)) {
+                cout << "Error: --method must be brent, illinois or anderson-bjorck\n";
+                return 1;
+            }
+        }
+    }
+    if (!(searchRange >= 0) || !(step >= 0)) {
+        cout << "Error: --range and --step must be >= 0\n";
+        return 1;
+    }
+    if (!(tolerance > 0)) {
+        cout << "Error: --tolerance must be > 0\n";
+        return 1;
+    }
 
     printHeader();
     // File names
@@ -104,59 +140,84 @@ int main() {
     out << "\n\n";
 
     printPolynomial(out, coef);
+    if (hybrid) out << "Solver            : " << solver::methodName(method) << "\n\n";
 
     // Parameters
-    f searchRange = 5000.0, step = 0.5, tolerance = 1e-6;
-    vector<f> roots, intervals;
-
-    // Find intervals with sign changes
-    for (f i = -searchRange; i <= searchRange; i += step) {
-        f fx1 = fun(coef, i);
-        f fx2 = fun(coef, i + step);
-
-        // Exact root at grid
-        if (abs(fx1) < tolerance) {
+    f startWidth = hybrid ? HUGE_VAL : 0.5; // the secant method starts from brackets at most 0.5 wide
+    vector<f> roots;
+    vector<bracket::Interval> intervals;
+
+    // Find intervals with sign changes (Common/root-brackets.h): isolate the
+    // roots with root bounds and Sturm counts, or scan a grid if --step is given
+    ThreadPool pool(threads);
+    auto start = chrono::steady_clock::now();
+    bracket::Scan grid;
+    if (step > 0) {
+        if (isinf(searchRange)) searchRange = 5000.0;
+        grid = bracket::scan(coef, -searchRange, searchRange, step, tolerance, pool);
+    } else {
+        grid = bracket::isolate(coef, searchRange, tolerance, pool, startWidth);
+    }
+    f seconds = chrono::duration<f>(chrono::steady_clock::now() - start).count();
+    cout << "Searched [" << grid.lo << ", " << grid.hi << "]";
+    if (step > 0) cout << " in steps of " << step << " (" << threads << " thread" << (threads > 1 ? "s" : "") << ")";
+    else if (grid.realRoots >= 0) cout << ", " << grid.realRoots << " distinct real root(s) by Sturm's theorem";
+    else cout << ", Sturm counts unreliable in places: grid scan there";
+    cout << ": " << grid.evaluations << " evaluations in " << fixed << setprecision(3) << seconds << " s\n";
+
+    // Exact roots at grid points
+    for (f x : grid.gridRoots) {
+        bool duplicate = false;
+        for (auto r : roots) if (abs(r - x) < tolerance) { duplicate = true; break; }
+        if (!duplicate) roots.push_back(x);
+    }
+    intervals = grid.intervals;
+
+    if (hybrid) {
+        // Brent or modified false position on each bracket (Common/root-solvers.h)
+        int evaluations = 0;
+        for (auto iv : intervals) {
+            solver::Result r = solver::solve(method, [&](f x) { return fun(coef, x); }, iv.lo, iv.hi, tolerance);
+            evaluations += r.evaluations;
             bool duplicate = false;
-            for (auto r : roots) if (abs(r - i) < tolerance) { duplicate = true; break; }
-            if (!duplicate) roots.push_back(i);
-        }
-        // Sign change
-        else if (fx1 * fx2 < 0.0) {
-            intervals.push_back(i);
+            for (auto x : roots) if (abs(x - r.root) < tolerance) { duplicate = true; break; }
+            if (!duplicate) roots.push_back(r.root);
         }
-    }
+        cout << solver::methodName(method) << ": " << intervals.size() << " bracket(s), "
+             << evaluations << " evaluations to tolerance " << scientific << setprecision(0) << tolerance << "\n";
+    } else {
+        // Apply Secant Method
+        for (auto iv : intervals) {
+            f x1 = iv.lo, x2 = iv.hi;
+            map<f, bool> visited;
 
-    // Apply Secant Method
-    for (f start : intervals) {
-        f x1 = start, x2 = start + step;
-        map<f, bool> visited;
+            while (true) {
+                f fx1 = fun(coef, x1);
+                f fx2 = fun(coef, x2);
 
-        while (true) {
-            f fx1 = fun(coef, x1);
-            f fx2 = fun(coef, x2);
+                // Secant formula
+                if (abs(fx2 - fx1) < 1e-10) break; // Avoid division by zero
 
-            // Secant formula
-            if (abs(fx2 - fx1) < 1e-10) break; // Avoid division by zero
+                f x0 = x1 - fx1 * ((x2 - x1) / (fx2 - fx1));
+                f fx0 = fun(coef, x0);
 
-            f x0 = x1 - fx1 * ((x2 - x1) / (fx2 - fx1));
-            f fx0 = fun(coef, x0);
+                // Round for map comparison to avoid floating point precision issues
+                f x0_rounded = round(x0 * 1e6) / 1e6;
 
-            // Round for map comparison to avoid floating point precision issues
-            f x0_rounded = round(x0 * 1e6) / 1e6;
+                // Check convergence or repeated value
+                if (abs(fx0) < tolerance || visited[x0_rounded]) {
+                    bool duplicate = false;
+                    for (auto r : roots) if (abs(r - x0) < tolerance) { duplicate = true; break; }
+                    if (!duplicate) roots.push_back(x0);
+                    break;
+                }
 
-            // Check convergence or repeated value
-            if (abs(fx0) < tolerance || visited[x0_rounded]) {
-                bool duplicate = false;
-                for (auto r : roots) if (abs(r - x0) < tolerance) { duplicate = true; break; }
-                if (!duplicate) roots.push_back(x0);
-                break;
-            }
+                visited[x0_rounded] = true;
 
-            visited[x0_rounded] = true;
-
-            // Update for next iteration (Secant method updates)
-            x1 = x2;
-            x2 = x0;
+                // Update for next iteration (Secant method updates)
+                x1 = x2;
+                x2 = x0;
+            }
         }
     }
 